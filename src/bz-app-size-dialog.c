@@ -21,7 +21,9 @@
 #include "bz-app-size-dialog.h"
 #include "bz-io.h"
 #include "bz-entry-group.h"
+#include "bz-install-plan.h"
 #include "bz-lozenge.h"
+#include "bz-result.h"
 #include "bz-template-callbacks.h"
 
 #include <glib/gi18n.h>
@@ -31,6 +33,7 @@ struct _BzAppSizeDialog
   AdwDialog parent_instance;
 
   BzEntryGroup *group;
+  BzResult     *install_plan;
 };
 
 G_DEFINE_FINAL_TYPE (BzAppSizeDialog, bz_app_size_dialog, ADW_TYPE_DIALOG)
@@ -40,6 +43,7 @@ enum
   PROP_0,
 
   PROP_GROUP,
+  PROP_INSTALL_PLAN,
 
   LAST_PROP
 };
@@ -51,6 +55,7 @@ bz_app_size_dialog_dispose (GObject *object)
   BzAppSizeDialog *self = BZ_APP_SIZE_DIALOG (object);
 
   g_clear_object (&self->group);
+  g_clear_object (&self->install_plan);
 
   G_OBJECT_CLASS (bz_app_size_dialog_parent_class)->dispose (object);
 }
@@ -68,6 +73,9 @@ bz_app_size_dialog_get_property (GObject    *object,
     case PROP_GROUP:
       g_value_set_object (value, self->group);
       break;
+    case PROP_INSTALL_PLAN:
+      g_value_set_object (value, self->install_plan);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -87,6 +95,10 @@ bz_app_size_dialog_set_property (GObject      *object,
       g_clear_object (&self->group);
       self->group = g_value_dup_object (value);
       break;
+    case PROP_INSTALL_PLAN:
+      g_clear_object (&self->install_plan);
+      self->install_plan = g_value_dup_object (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -115,6 +127,46 @@ format_size (gpointer object, guint64 value)
   return g_strdup (size_str);
 }
 
+static guint64
+get_download_size (gpointer       object,
+                   BzEntry       *entry,
+                   BzInstallPlan *plan)
+{
+  if (plan != NULL && bz_install_plan_get_download_size (plan) > 0)
+    return bz_install_plan_get_download_size (plan);
+
+  return entry != NULL ? bz_entry_get_size (entry) : 0;
+}
+
+static guint64
+get_installed_size (gpointer       object,
+                    BzEntry       *entry,
+                    BzInstallPlan *plan)
+{
+  if (plan != NULL && bz_install_plan_get_installed_size (plan) > 0)
+    return bz_install_plan_get_installed_size (plan);
+
+  return entry != NULL ? bz_entry_get_installed_size (entry) : 0;
+}
+
+static char *
+get_download_size_subtitle (gpointer       object,
+                            BzInstallPlan *plan)
+{
+  guint n_shared = 0;
+
+  if (plan != NULL)
+    n_shared = bz_install_plan_get_n_runtimes (plan) + bz_install_plan_get_n_addons (plan);
+
+  if (n_shared > 0)
+    return g_strdup_printf (ngettext ("Amount to download from the internet, including %u missing dependency",
+                                      "Amount to download from the internet, including %u missing dependencies",
+                                      n_shared),
+                            n_shared);
+
+  return g_strdup (_ ("Amount to download from the internet"));
+}
+
 static void
 open_user_data_folder_cb (GtkWidget *widget,
                           gpointer   user_data)
@@ -160,14 +212,25 @@ bz_app_size_dialog_class_init (BzAppSizeDialogClass *klass)
           BZ_TYPE_ENTRY_GROUP,
           G_PARAM_READWRITE);
 
+  props[PROP_INSTALL_PLAN] =
+      g_param_spec_object (
+          "install-plan",
+          NULL, NULL,
+          BZ_TYPE_RESULT,
+          G_PARAM_READWRITE);
+
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
+  g_type_ensure (BZ_TYPE_INSTALL_PLAN);
   g_type_ensure (BZ_TYPE_LOZENGE);
 
   gtk_widget_class_set_template_from_resource (widget_class, "/io/github/kolunmi/Bazaar/bz-app-size-dialog.ui");
   bz_widget_class_bind_all_util_callbacks (widget_class);
   gtk_widget_class_bind_template_callback (widget_class, format_size);
   gtk_widget_class_bind_template_callback (widget_class, get_runtime_size_title);
+  gtk_widget_class_bind_template_callback (widget_class, get_download_size);
+  gtk_widget_class_bind_template_callback (widget_class, get_installed_size);
+  gtk_widget_class_bind_template_callback (widget_class, get_download_size_subtitle);
   gtk_widget_class_bind_template_callback (widget_class, open_user_data_folder_cb);
 }
 
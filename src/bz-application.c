@@ -32,6 +32,9 @@
 #include "bz-application.h"
 #include "bz-auth-state.h"
 #include "bz-backend-notification.h"
+#include "bz-cache-registry.h"
+#include "bz-catalog-index.h"
+#include "bz-collated-store.h"
 #include "bz-content-provider.h"
 #include "bz-donations-dialog.h"
 #include "bz-entry-cache-manager.h"
@@ -42,9 +45,11 @@
 #include "bz-flathub-state.h"
 #include "bz-flatpak-entry.h"
 #include "bz-flatpak-instance.h"
+#include "bz-global-net.h"
 #include "bz-gnome-shell-search-provider.h"
 #include "bz-hash-table-object.h"
 #include "bz-inspector.h"
+#include "bz-install-preflight.h"
 #include "bz-internal-config.h"
 #include "bz-io.h"
 #include "bz-login-page.h"
@@ -68,6 +73,7 @@ struct _BzApplication
 
   BzApplicationMapFactory    *application_factory;
   BzApplicationMapFactory    *entry_factory;
+  BzCatalogIndex             *catalog_index;
   BzContentProvider          *blocklists_provider;
   BzContentProvider          *curated_provider;
   BzContentProvider          *txt_blocklists_provider;
@@ -86,16 +92,19 @@ struct _BzApplication
   BzYamlParser               *curated_parser;
   DexChannel                 *flatpak_notifs;
   DexFuture                  *notif_watch;
+  DexFuture                  *stage_updates;
   DexFuture                  *sync;
   DexPromise                 *ready_to_open_files;
+  GCancellable               *stage_cancellable;
   GHashTable                 *eol_runtimes;
   GHashTable                 *ids_to_groups;
   GHashTable                 *ignore_eol_set;
   GHashTable                 *installed_set;
   GHashTable                 *sys_name_to_addons;
   GHashTable                 *usr_name_to_addons;
+  GListStore                 *available_updates;
   GListStore                 *groups;
-  GListStore                 *installed_apps;
+  BzCollatedStore            *installed_apps;
   GListStore                 *search_biases_backing;
   GNetworkMonitor            *network;
   GPtrArray                  *blocklist_regexes;
@@ -114,7 +123,9 @@ struct _BzApplication
   GtkStringList              *curated_configs;
   GtkStringList              *txt_blocklists;
   gboolean                    running;
+  gboolean                    flathub_cached;
   guint                       periodic_timeout_source;
+  guint                       shed_id;
   int                         n_notifications_incoming;
 };
 
@@ -167,6 +178,9 @@ init_fiber (GWeakRef *wr);
 static DexFuture *
 cache_flathub_fiber (GWeakRef *wr);
 
+static DexFuture *
+rehydrate_fiber (GWeakRef *wr);
+
 static DexFuture *
 respond_to_flatpak_fiber (RespondToFlatpakData *data);
 
@@ -211,10 +225,29 @@ fiber_replace_entry (BzApplication *self,
 static void
 fiber_check_for_updates (BzApplication *self);
 
+static void
+maybe_stage_updates (BzApplication *self,
+                     GListModel    *updates);
+
+static void
+cancel_staged_updates (BzApplication *self);
+
+static DexFuture *
+stage_updates_finally (DexFuture *future,
+                       GWeakRef  *wr);
+
+static void
+transactions_active_changed (BzApplication        *self,
+                             GParamSpec           *pspec,
+                             BzTransactionManager *transactions);
+
 static GFile *
 fiber_dup_flathub_cache_file (char   **path_out,
                               GError **error);
 
+static BzFlathubState *
+fiber_load_cached_flathub (void);
+
 static gboolean
 periodic_timeout_cb (BzApplication *self);
 
@@ -240,6 +273,16 @@ static gboolean
 window_close_request (BzApplication *self,
                       GtkWidget     *window);
 
+static void
+window_added (BzApplication *self,
+              GtkWindow     *window);
+
+static void
+windows_changed (BzApplication *self);
+
+static void
+shed_flathub_cb (GWeakRef *wr);
+
 static void
 blocklists_changed (BzApplication *self,
                     guint          position,
@@ -300,11 +343,6 @@ static gboolean
 filter_entry_groups (BzEntryGroup  *group,
                      BzApplication *self);
 
-static gint
-cmp_group (BzEntryGroup *a,
-           BzEntryGroup *b,
-           gpointer      user_data);
-
 static gint
 cmp_entry (BzEntry *a,
            BzEntry *b,
@@ -329,7 +367,9 @@ bz_application_dispose (GObject *object)
   dex_clear (&self->notif_watch);
   dex_clear (&self->ready_to_open_files);
   dex_clear (&self->sync);
+  cancel_staged_updates (self);
   g_clear_handle_id (&self->periodic_timeout_source, g_source_remove);
+  g_clear_handle_id (&self->shed_id, bz_cache_registry_remove);
   g_clear_object (&self->appid_filter);
   g_clear_object (&self->application_factory);
   g_clear_object (&self->blocklist_parser);
@@ -347,8 +387,10 @@ bz_application_dispose (GObject *object)
   g_clear_object (&self->group_filter);
   g_clear_object (&self->group_filter_model);
   g_clear_object (&self->groups);
+  g_clear_object (&self->catalog_index);
   g_clear_object (&self->gs_search);
   g_clear_object (&self->installed_apps);
+  g_clear_object (&self->available_updates);
   g_clear_object (&self->internal_config);
   g_clear_object (&self->network);
   g_clear_object (&self->search_biases);
@@ -662,6 +704,8 @@ bz_application_sync_remotes_action (GSimpleAction *action,
     return;
 
   dex_clear (&self->sync);
+  if (self->flatpak != NULL)
+    bz_flatpak_instance_reset_backoff (self->flatpak);
   self->sync = make_sync_future (self);
 }
 
@@ -883,8 +927,7 @@ init_fiber (GWeakRef *wr)
   gboolean has_flathub                  = FALSE;
   gboolean result                       = FALSE;
   g_autoptr (GHashTable) cached_set     = NULL;
-  g_autofree char *flathub_cache        = NULL;
-  g_autoptr (GFile) flathub_cache_file  = NULL;
+  g_autoptr (BzFlathubState) flathub    = NULL;
 
   bz_weak_get_or_return_reject (self, wr);
 
@@ -959,7 +1002,10 @@ init_fiber (GWeakRef *wr)
   if (local_error != NULL)
     return dex_future_new_for_error (g_steal_pointer (&local_error));
 
-  if (!has_flathub)
+  /* Connect to Flathub while the rest of setup runs */
+  if (has_flathub)
+    dex_future_disown (bz_prewarm_global_http_session ());
+  else
     {
       GtkWindow       *window   = NULL;
       g_autofree char *response = NULL;
@@ -1036,6 +1082,7 @@ init_fiber (GWeakRef *wr)
       self->installed_set = g_hash_table_new_full (
           g_str_hash, g_str_equal, g_free, g_free);
     }
+  bz_install_preflight_set_installed (self->installed_set);
 
   repos = dex_await_object (
       bz_backend_list_repositories (BZ_BACKEND (self->flatpak), NULL),
@@ -1102,6 +1149,7 @@ init_fiber (GWeakRef *wr)
 
       g_ptr_array_sort_values_with_data (
           entries, (GCompareDataFunc) cmp_entry, NULL);
+      bz_collated_store_freeze (self->installed_apps);
       for (guint i = 0; i < entries->len; i++)
         {
           BzEntry *entry = NULL;
@@ -1109,6 +1157,7 @@ init_fiber (GWeakRef *wr)
           entry = g_ptr_array_index (entries, i);
           fiber_replace_entry (self, entry);
         }
+      bz_collated_store_thaw (self->installed_apps);
 
       gtk_filter_changed (GTK_FILTER (self->group_filter), GTK_FILTER_CHANGE_LESS_STRICT);
       gtk_filter_changed (GTK_FILTER (self->appid_filter), GTK_FILTER_CHANGE_LESS_STRICT);
@@ -1119,60 +1168,91 @@ init_fiber (GWeakRef *wr)
       g_clear_error (&local_error);
     }
 
+  flathub = fiber_load_cached_flathub ();
+  if (flathub != NULL)
+    {
+      self->flathub        = g_steal_pointer (&flathub);
+      self->flathub_cached = TRUE;
+      bz_flathub_state_set_map_factory (self->flathub, self->application_factory);
+      bz_state_info_set_flathub (self->state, self->flathub);
+
+      bz_state_info_set_busy (self->state, FALSE);
+      dex_promise_resolve_boolean (self->ready_to_open_files, TRUE);
+    }
+
+  return dex_future_new_true ();
+}
+
+static BzFlathubState *
+fiber_load_cached_flathub (void)
+{
+  g_autoptr (GError) local_error       = NULL;
+  g_autofree char *flathub_cache       = NULL;
+  g_autoptr (GFile) flathub_cache_file = NULL;
+  g_autoptr (GBytes) bytes             = NULL;
+  g_autoptr (GVariant) variant         = NULL;
+  g_autoptr (BzFlathubState) flathub   = NULL;
+  gboolean result                      = FALSE;
+
   flathub_cache_file = fiber_dup_flathub_cache_file (&flathub_cache, &local_error);
-  if (flathub_cache_file != NULL)
+  if (flathub_cache_file == NULL)
     {
-      if (dex_await (dex_file_query_exists (flathub_cache_file), NULL))
-        {
-          g_autoptr (GBytes) bytes = NULL;
+      g_warning ("Unable to ensure cache directory: %s", local_error->message);
+      return NULL;
+    }
 
-          bytes = dex_await_boxed (
-              dex_file_load_contents_bytes (flathub_cache_file),
-              &local_error);
-          if (bytes != NULL)
-            {
-              g_autoptr (GVariant) variant       = NULL;
-              g_autoptr (BzFlathubState) flathub = NULL;
+  if (!dex_await (dex_file_query_exists (flathub_cache_file), NULL))
+    return NULL;
 
-              variant = g_variant_new_from_bytes (G_VARIANT_TYPE_VARDICT, bytes, FALSE);
-              if (variant == NULL)
-                {
-                  g_warning ("Failed to interpret cached flathub state from %s: %s",
-                             flathub_cache, local_error->message);
-                  g_clear_error (&local_error);
-                }
+  bytes = dex_await_boxed (
+      dex_file_load_contents_bytes (flathub_cache_file),
+      &local_error);
+  if (bytes == NULL)
+    {
+      g_warning ("Failed to decache cache flathub state from %s: %s",
+                 flathub_cache, local_error->message);
+      return NULL;
+    }
 
-              flathub = bz_flathub_state_new ();
-              result  = bz_serializable_deserialize (
-                  BZ_SERIALIZABLE (flathub), variant, &local_error);
-              if (result)
-                {
-                  self->flathub = g_steal_pointer (&flathub);
-                  bz_flathub_state_set_map_factory (self->flathub, self->application_factory);
-                  bz_state_info_set_flathub (self->state, self->flathub);
+  variant = g_variant_new_from_bytes (G_VARIANT_TYPE_VARDICT, bytes, FALSE);
+  flathub = bz_flathub_state_new ();
+  result  = bz_serializable_deserialize (
+      BZ_SERIALIZABLE (flathub), variant, &local_error);
+  if (!result)
+    {
+      g_warning ("Failed to deserialize cached flathub state from %s: %s",
+                 flathub_cache, local_error->message);
+      return NULL;
+    }
 
-                  bz_state_info_set_busy (self->state, FALSE);
-                  dex_promise_resolve_boolean (self->ready_to_open_files, TRUE);
-                }
-              else
-                {
-                  g_warning ("Failed to deserialize cached flathub state from %s: %s",
-                             flathub_cache, local_error->message);
-                  g_clear_error (&local_error);
-                }
-            }
-          else
-            {
-              g_warning ("Failed to decache cache flathub state from %s: %s",
-                         flathub_cache, local_error->message);
-              g_clear_error (&local_error);
-            }
-        }
+  return g_steal_pointer (&flathub);
+}
+
+static DexFuture *
+rehydrate_fiber (GWeakRef *wr)
+{
+  g_autoptr (BzApplication) self     = NULL;
+  g_autoptr (BzFlathubState) flathub = NULL;
+
+  bz_weak_get_or_return_reject (self, wr);
+
+  flathub = fiber_load_cached_flathub ();
+
+  /* Something newer may have arrived in the meantime */
+  if (self->flathub != NULL)
+    return dex_future_new_true ();
+
+  if (flathub != NULL)
+    {
+      self->flathub = g_steal_pointer (&flathub);
+      bz_flathub_state_set_map_factory (self->flathub, self->application_factory);
+      bz_state_info_set_flathub (self->state, self->flathub);
     }
-  else
+  else if (self->sync == NULL || !dex_future_is_pending (self->sync))
     {
-      g_warning ("Unable to ensure cache directory: %s", local_error->message);
-      g_clear_error (&local_error);
+      g_warning ("Unable to restore the flathub state dropped in the background, fetching it again");
+      dex_clear (&self->sync);
+      self->sync = make_sync_future (self);
     }
 
   return dex_future_new_true ();
@@ -1189,6 +1269,10 @@ cache_flathub_fiber (GWeakRef *wr)
 
   bz_weak_get_or_return_reject (self, wr);
 
+  /* Dropped in the background, the cache is already up to date */
+  if (self->flathub == NULL)
+    return dex_future_new_true ();
+
   flathub_cache_file = fiber_dup_flathub_cache_file (&flathub_cache, &local_error);
   if (flathub_cache_file != NULL)
     {
@@ -1207,7 +1291,9 @@ cache_flathub_fiber (GWeakRef *wr)
               NULL, FALSE,
               G_FILE_CREATE_REPLACE_DESTINATION),
           &local_error);
-      if (!result)
+      if (result)
+        self->flathub_cached = TRUE;
+      else
         {
           g_warning ("Failed to cache flathub state to %s: %s",
                      flathub_cache, local_error->message);
@@ -1342,14 +1428,7 @@ respond_to_flatpak_fiber (RespondToFlatpakData *data)
 
                       group = g_hash_table_lookup (self->ids_to_groups, bz_entry_get_id (entry));
                       if (group != NULL)
-                        {
-                          gboolean found    = FALSE;
-                          guint    position = 0;
-
-                          found = g_list_store_find (self->installed_apps, group, &position);
-                          if (!found)
-                            g_list_store_insert_sorted (self->installed_apps, group, (GCompareDataFunc) cmp_group, NULL);
-                        }
+                        bz_collated_store_add (self->installed_apps, group);
                     }
                 }
                 break;
@@ -1373,14 +1452,7 @@ respond_to_flatpak_fiber (RespondToFlatpakData *data)
 
                       group = g_hash_table_lookup (self->ids_to_groups, bz_entry_get_id (entry));
                       if (group != NULL && !bz_entry_group_get_removable (group))
-                        {
-                          gboolean found    = FALSE;
-                          guint    position = 0;
-
-                          found = g_list_store_find (self->installed_apps, group, &position);
-                          if (found)
-                            g_list_store_remove (self->installed_apps, position);
-                        }
+                        bz_collated_store_remove (self->installed_apps, group);
                     }
                 }
                 break;
@@ -1456,6 +1528,7 @@ respond_to_flatpak_fiber (RespondToFlatpakData *data)
                            NULL);
 
                 diff_writes = g_ptr_array_new_with_free_func (dex_unref);
+                bz_collated_store_freeze (self->installed_apps);
                 for (guint i = 0; i < diff_reads->len; i++)
                   {
                     DexFuture *future = NULL;
@@ -1487,17 +1560,10 @@ respond_to_flatpak_fiber (RespondToFlatpakData *data)
 
                         if (group != NULL)
                           {
-                            gboolean found    = FALSE;
-                            guint    position = 0;
-
-                            found = g_list_store_find (self->installed_apps, group, &position);
-                            if (installed && !found)
-                              g_list_store_insert_sorted (
-                                  self->installed_apps, group,
-                                  (GCompareDataFunc) cmp_group, NULL);
-                            else if (!installed && found &&
-                                     bz_entry_group_get_removable (group) == 0)
-                              g_list_store_remove (self->installed_apps, position);
+                            if (installed)
+                              bz_collated_store_add (self->installed_apps, group);
+                            else if (bz_entry_group_get_removable (group) == 0)
+                              bz_collated_store_remove (self->installed_apps, group);
                           }
 
                         g_ptr_array_add (
@@ -1505,6 +1571,7 @@ respond_to_flatpak_fiber (RespondToFlatpakData *data)
                             bz_entry_cache_manager_add (self->cache, entry));
                       }
                   }
+                bz_collated_store_thaw (self->installed_apps);
 
                 dex_await (dex_future_allv (
                                (DexFuture *const *) diff_writes->pdata,
@@ -1513,6 +1580,7 @@ respond_to_flatpak_fiber (RespondToFlatpakData *data)
               }
             g_clear_pointer (&self->installed_set, g_hash_table_unref);
             self->installed_set = g_steal_pointer (&installed_set);
+            bz_install_preflight_set_installed (self->installed_set);
 
             fiber_check_for_updates (self);
             finish_with_background_task_label (self);
@@ -1860,10 +1928,9 @@ fiber_replace_entry (BzApplication *self,
       if (group != NULL)
         {
           bz_entry_group_add (group, entry, eol_runtime, ignore_eol);
-          if (installed && !g_list_store_find (self->installed_apps, group, NULL))
-            g_list_store_insert_sorted (
-                self->installed_apps, group,
-                (GCompareDataFunc) cmp_group, NULL);
+          bz_catalog_index_add_entry (self->catalog_index, group, entry);
+          if (installed)
+            bz_collated_store_add (self->installed_apps, group);
         }
       else
         {
@@ -1875,11 +1942,10 @@ fiber_replace_entry (BzApplication *self,
 
           g_list_store_append (self->groups, new_group);
           g_hash_table_replace (self->ids_to_groups, g_strdup (id), g_object_ref (new_group));
+          bz_catalog_index_add_entry (self->catalog_index, new_group, entry);
 
           if (installed)
-            g_list_store_insert_sorted (
-                self->installed_apps, new_group,
-                (GCompareDataFunc) cmp_group, NULL);
+            bz_collated_store_add (self->installed_apps, new_group);
         }
     }
 
@@ -1944,6 +2010,12 @@ fiber_check_for_updates (BzApplication *self)
   g_autoptr (GError) local_error   = NULL;
   g_autoptr (GPtrArray) update_ids = NULL;
   GtkWindow *window                = NULL;
+  g_autoptr (GHashTable) new_set   = NULL;
+  g_autoptr (GHashTable) old_set   = NULL;
+  g_autoptr (GPtrArray) futures    = NULL;
+  g_autoptr (GPtrArray) added      = NULL;
+  guint    n_items                 = 0;
+  gboolean changed                 = FALSE;
 
   g_debug ("Checking for updates...");
   bz_state_info_set_checking_for_updates (self->state, TRUE);
@@ -1951,27 +2023,85 @@ fiber_check_for_updates (BzApplication *self)
   update_ids = dex_await_boxed (
       bz_backend_retrieve_update_ids (BZ_BACKEND (self->flatpak), NULL),
       &local_error);
-  window = gtk_application_get_active_window (GTK_APPLICATION (self));
-  if (update_ids != NULL &&
-      update_ids->len > 0)
+  if (update_ids == NULL)
     {
-      g_autoptr (GPtrArray) futures = NULL;
-      g_autoptr (GListStore) store  = NULL;
+      g_warning ("Failed to check for updates: %s", local_error->message);
 
-      futures = g_ptr_array_new_with_free_func (dex_unref);
-      for (guint i = 0; i < update_ids->len; i++)
+      window = gtk_application_get_active_window (GTK_APPLICATION (self));
+      if (window != NULL)
+        bz_show_error_for_widget (GTK_WIDGET (window), _ ("Failed to check for updates"), local_error->message);
+
+      bz_state_info_set_checking_for_updates (self->state, FALSE);
+      return;
+    }
+
+  if (self->available_updates == NULL)
+    self->available_updates = g_list_store_new (BZ_TYPE_ENTRY);
+
+  /* The store is patched rather than replaced so the updates card doesn't
+     rebind, and only ids which weren't there before get resolved. Entries
+     may also have been taken out of the store by the window once updating
+     started, so the store itself is the baseline */
+  new_set = g_hash_table_new (g_str_hash, g_str_equal);
+  for (guint i = 0; i < update_ids->len; i++)
+    g_hash_table_add (new_set, g_ptr_array_index (update_ids, i));
+
+  old_set = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self->available_updates));
+  for (guint i = n_items; i > 0;)
+    {
+      guint run_end = i;
+
+      /* Remove each contiguous run of stale entries with one splice */
+      while (i > 0)
         {
-          const char *unique_id = NULL;
+          g_autoptr (BzEntry) entry = NULL;
+          const char *unique_id     = NULL;
 
-          unique_id = g_ptr_array_index (update_ids, i);
-          g_ptr_array_add (futures, bz_entry_cache_manager_get (self->cache, unique_id));
+          entry     = g_list_model_get_item (G_LIST_MODEL (self->available_updates), i - 1);
+          unique_id = bz_entry_get_unique_id (entry);
+          if (g_hash_table_contains (new_set, unique_id))
+            {
+              g_hash_table_add (old_set, g_strdup (unique_id));
+              break;
+            }
+          i--;
         }
 
+      if (i < run_end)
+        {
+          g_list_store_splice (self->available_updates, i, run_end - i, NULL, 0);
+          changed = TRUE;
+        }
+      if (i > 0)
+        i--;
+    }
+
+  futures = g_ptr_array_new_with_free_func (dex_unref);
+  added   = g_ptr_array_new ();
+  for (guint i = 0; i < update_ids->len; i++)
+    {
+      const char *unique_id = NULL;
+
+      unique_id = g_ptr_array_index (update_ids, i);
+      if (g_hash_table_contains (old_set, unique_id))
+        continue;
+
+      /* Guards against the backend reporting an id twice */
+      g_hash_table_add (old_set, g_strdup (unique_id));
+      g_ptr_array_add (added, (gpointer) unique_id);
+      g_ptr_array_add (futures, bz_entry_cache_manager_get (self->cache, unique_id));
+    }
+
+  if (futures->len > 0)
+    {
+      g_autoptr (GPtrArray) entries = NULL;
+
       dex_await (
           dex_future_allv ((DexFuture *const *) futures->pdata, futures->len),
           NULL);
 
-      store = g_list_store_new (BZ_TYPE_ENTRY);
+      entries = g_ptr_array_new_with_free_func (g_object_unref);
       for (guint i = 0; i < futures->len; i++)
         {
           DexFuture    *future = NULL;
@@ -1981,32 +2111,124 @@ fiber_check_for_updates (BzApplication *self)
           value  = dex_future_get_value (future, &local_error);
 
           if (value != NULL)
-            g_list_store_append (store, g_value_get_object (value));
+            g_ptr_array_add (entries, g_value_dup_object (value));
           else
             {
-              const char *unique_id = NULL;
-
-              unique_id = g_ptr_array_index (update_ids, i);
               g_warning ("%s could not be resolved for the update list and thus will not be included: %s",
-                         unique_id, local_error->message);
+                         (const char *) g_ptr_array_index (added, i), local_error->message);
               g_clear_pointer (&local_error, g_error_free);
             }
         }
 
-      if (g_list_model_get_n_items (G_LIST_MODEL (store)) > 0)
-        bz_state_info_set_available_updates (self->state, G_LIST_MODEL (store));
+      g_list_store_splice (
+          self->available_updates,
+          g_list_model_get_n_items (G_LIST_MODEL (self->available_updates)),
+          0, entries->pdata, entries->len);
+      if (entries->len > 0)
+        changed = TRUE;
     }
-  else if (local_error != NULL)
-    {
-      g_warning ("Failed to check for updates: %s", local_error->message);
 
-      if (window != NULL)
-        bz_show_error_for_widget (GTK_WIDGET (window), _ ("Failed to check for updates"), local_error->message);
+  g_debug ("%u updates available, %u newly found",
+           g_list_model_get_n_items (G_LIST_MODEL (self->available_updates)),
+           futures->len);
+
+  if (bz_state_info_get_available_updates (self->state) == G_LIST_MODEL (self->available_updates))
+    {
+      /* Bindings on the count don't follow items-changed */
+      if (changed)
+        g_object_notify (G_OBJECT (self->state), "available-updates");
     }
+  else if (g_list_model_get_n_items (G_LIST_MODEL (self->available_updates)) > 0)
+    bz_state_info_set_available_updates (self->state, G_LIST_MODEL (self->available_updates));
+
+  /* Also picks staging back up after a transaction cancelled it */
+  if (g_list_model_get_n_items (G_LIST_MODEL (self->available_updates)) > 0 &&
+      (futures->len > 0 || self->stage_updates == NULL))
+    maybe_stage_updates (self, G_LIST_MODEL (self->available_updates));
 
   bz_state_info_set_checking_for_updates (self->state, FALSE);
 }
 
+static void
+maybe_stage_updates (BzApplication *self,
+                     GListModel    *updates)
+{
+  guint n_updates               = 0;
+  guint64 budget                = 0;
+  g_autoptr (GPtrArray) entries = NULL;
+  DexFuture *future             = NULL;
+
+  if (!g_settings_get_boolean (self->settings, "stage-updates"))
+    return;
+  if (!bz_state_info_get_have_connection (self->state) ||
+      bz_state_info_get_metered_connection (self->state))
+    return;
+  if (bz_transaction_manager_get_active (self->transactions))
+    /* Do not compete for bandwidth with transactions the user asked for */
+    return;
+
+  cancel_staged_updates (self);
+
+  n_updates = g_list_model_get_n_items (updates);
+  entries   = g_ptr_array_new_full (n_updates, g_object_unref);
+  for (guint i = 0; i < n_updates; i++)
+    g_ptr_array_add (entries, g_list_model_get_item (updates, i));
+
+  budget = (guint64) g_settings_get_uint (self->settings, "stage-updates-budget") * 1024 * 1024;
+
+  g_debug ("Staging %u updates in the background...", n_updates);
+  self->stage_cancellable = g_cancellable_new ();
+  future                  = bz_backend_stage_updates (
+      BZ_BACKEND (self->flatpak),
+      (BzEntry **) entries->pdata,
+      entries->len,
+      budget,
+      self->stage_cancellable);
+  future = dex_future_finally (
+      future,
+      (DexFutureCallback) stage_updates_finally,
+      bz_track_weak (self),
+      bz_weak_release);
+  self->stage_updates = future;
+}
+
+static void
+cancel_staged_updates (BzApplication *self)
+{
+  if (self->stage_cancellable != NULL)
+    g_cancellable_cancel (self->stage_cancellable);
+  g_clear_object (&self->stage_cancellable);
+  dex_clear (&self->stage_updates);
+}
+
+static DexFuture *
+stage_updates_finally (DexFuture *future,
+                       GWeakRef  *wr)
+{
+  g_autoptr (GError) local_error = NULL;
+  const GValue *value            = NULL;
+
+  value = dex_future_get_value (future, &local_error);
+  if (value != NULL)
+    g_debug ("Finished staging updates, downloaded %" G_GUINT64_FORMAT " bytes",
+             g_value_get_uint64 (value));
+  else if (!g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    g_warning ("Failed to stage updates in the background: %s", local_error->message);
+
+  return dex_future_new_true ();
+}
+
+static void
+transactions_active_changed (BzApplication        *self,
+                             GParamSpec           *pspec,
+                             BzTransactionManager *transactions)
+{
+  /* Staging would only slow down whatever the user just asked for, and an
+     update transaction picks up whatever was already staged */
+  if (bz_transaction_manager_get_active (transactions))
+    cancel_staged_updates (self);
+}
+
 static GFile *
 fiber_dup_flathub_cache_file (char   **path_out,
                               GError **error)
@@ -2098,6 +2320,12 @@ network_status_changed (BzApplication   *self,
   have_connection = connectivity == G_NETWORK_CONNECTIVITY_FULL;
   is_metered      = g_network_monitor_get_network_metered (network);
 
+  if (!was_connected &&
+      have_connection &&
+      self->flatpak != NULL)
+    /* Failures from before probably came from being offline */
+    bz_flatpak_instance_reset_backoff (self->flatpak);
+
   if (!bz_state_info_get_busy (self->state) &&
       ((!was_connected &&
         have_connection &&
@@ -2110,6 +2338,9 @@ network_status_changed (BzApplication   *self,
         500, (GSourceFunc) scheduled_timeout_cb,
         bz_track_weak (self), bz_weak_release);
 
+  if (!have_connection || is_metered)
+    cancel_staged_updates (self);
+
   bz_state_info_set_have_connection (self->state, have_connection);
   bz_state_info_set_metered_connection (self->state, is_metered);
 }
@@ -2158,6 +2389,67 @@ window_close_request (BzApplication *self,
   return FALSE;
 }
 
+static void
+window_added (BzApplication *self,
+              GtkWindow     *window)
+{
+  g_signal_connect_object (
+      window, "notify::visible",
+      G_CALLBACK (windows_changed),
+      self, G_CONNECT_SWAPPED);
+  windows_changed (self);
+
+  /* Bring back what was dropped in the background before the window
+     gets to the flathub page */
+  if (self->flathub == NULL && self->flathub_cached)
+    dex_future_disown (dex_scheduler_spawn (
+        dex_scheduler_get_default (),
+        bz_get_dex_stack_size (),
+        (DexFiberFunc) rehydrate_fiber,
+        bz_track_weak (self),
+        bz_weak_release));
+}
+
+static void
+windows_changed (BzApplication *self)
+{
+  gboolean background = TRUE;
+
+  for (GList *l = gtk_application_get_windows (GTK_APPLICATION (self));
+       l != NULL;
+       l = l->next)
+    {
+      if (gtk_widget_get_visible (l->data))
+        {
+          background = FALSE;
+          break;
+        }
+    }
+
+  bz_cache_registry_set_background (background);
+}
+
+static void
+shed_flathub_cb (GWeakRef *wr)
+{
+  g_autoptr (BzApplication) self = NULL;
+
+  self = g_weak_ref_get (wr);
+  if (self == NULL)
+    return;
+
+  /* The flathub state only backs the UI. Without a window it can go
+     entirely, provided it can be read back from the cache */
+  if (!bz_cache_registry_get_background () ||
+      !self->flathub_cached ||
+      self->flathub == NULL)
+    return;
+
+  g_debug ("Dropping flathub state while in the background");
+  bz_state_info_set_flathub (self->state, NULL);
+  g_clear_object (&self->flathub);
+}
+
 static void
 blocklists_changed (BzApplication *self,
                     guint          position,
@@ -2701,6 +2993,17 @@ init_service_struct (BzApplication *self,
   else
     g_warning ("Unable to detect networking device! Continuing anyway...");
 
+  /* Nothing needs to stay warm while no window is shown */
+  bz_cache_registry_init ();
+  self->shed_id = bz_cache_registry_add (
+      BZ_CACHE_PRIORITY_COLLECTIONS,
+      (BzCacheShedFunc) shed_flathub_cb,
+      bz_track_weak (self),
+      bz_weak_release);
+  g_signal_connect (self, "window-added", G_CALLBACK (window_added), NULL);
+  g_signal_connect (self, "window-removed", G_CALLBACK (windows_changed), NULL);
+  windows_changed (self);
+
   app_id = g_application_get_application_id (G_APPLICATION (self));
   g_assert (app_id != NULL);
   g_debug ("Constructing gsettings for %s ...", app_id);
@@ -2759,7 +3062,9 @@ init_service_struct (BzApplication *self,
   g_signal_connect_swapped (self->txt_blocklists_provider, "items-changed", G_CALLBACK (txt_blocklists_changed), self);
 
   self->groups         = g_list_store_new (BZ_TYPE_ENTRY_GROUP);
-  self->installed_apps = g_list_store_new (BZ_TYPE_ENTRY_GROUP);
+  self->installed_apps = bz_collated_store_new (
+      BZ_TYPE_ENTRY_GROUP,
+      (BzCollatedStoreTextFunc) bz_entry_group_get_title);
   self->ids_to_groups  = g_hash_table_new_full (
       g_str_hash, g_str_equal, g_free, g_object_unref);
   self->eol_runtimes = g_hash_table_new_full (
@@ -2786,6 +3091,7 @@ init_service_struct (BzApplication *self,
   self->group_filter_model = gtk_filter_list_model_new (
       g_object_ref (G_LIST_MODEL (self->groups)),
       g_object_ref (GTK_FILTER (self->group_filter)));
+  self->catalog_index = bz_catalog_index_new (GTK_FILTER (self->group_filter));
 
   self->search_engine = bz_search_engine_new ();
   bz_search_engine_set_model (self->search_engine, G_LIST_MODEL (self->group_filter_model));
@@ -2799,12 +3105,18 @@ init_service_struct (BzApplication *self,
 
   self->transactions = bz_transaction_manager_new ();
   bz_transaction_manager_set_config (self->transactions, self->config);
+  g_signal_connect_swapped (
+      self->transactions,
+      "notify::active",
+      G_CALLBACK (transactions_active_changed),
+      self);
 
   bz_state_info_set_all_entry_groups (self->state, G_LIST_MODEL (self->groups));
   bz_state_info_set_all_installed_entry_groups (self->state, G_LIST_MODEL (self->installed_apps));
   bz_state_info_set_application_factory (self->state, self->application_factory);
   bz_state_info_set_blocklists (self->state, G_LIST_MODEL (self->blocklists));
   bz_state_info_set_blocklists_provider (self->state, self->blocklists_provider);
+  bz_state_info_set_catalog_index (self->state, self->catalog_index);
   bz_state_info_set_curated_configs (self->state, G_LIST_MODEL (self->curated_configs));
   bz_state_info_set_curated_provider (self->state, self->curated_provider);
   bz_state_info_set_entry_factory (self->state, self->entry_factory);
@@ -3029,25 +3341,6 @@ filter_entry_groups (BzEntryGroup  *group,
   return validate_group_for_ui (self, group);
 }
 
-static gint
-cmp_group (BzEntryGroup *a,
-           BzEntryGroup *b,
-           gpointer      user_data)
-{
-  const char *title_a = NULL;
-  const char *title_b = NULL;
-
-  title_a = bz_entry_group_get_title (a);
-  title_b = bz_entry_group_get_title (b);
-
-  if (title_a == NULL)
-    return 1;
-  if (title_b == NULL)
-    return -1;
-
-  return strcasecmp (title_a, title_b);
-}
-
 static gint
 cmp_entry (BzEntry *a,
            BzEntry *b,
@@ -25,12 +25,14 @@
 #include "bz-app-tile.h"
 #include "bz-application.h"
 #include "bz-apps-page.h"
+#include "bz-catalog-index.h"
 #include "bz-dynamic-list-view.h"
 #include "bz-entry-group.h"
 #include "bz-env.h"
 #include "bz-flathub-category.h"
 #include "bz-subcategory-list.h"
 #include "bz-state-info.h"
+#include "bz-vocabulary.h"
 
 struct _BzAppsPage
 {
@@ -44,6 +46,7 @@ struct _BzAppsPage
   BzFlathubCategory *category;
 
   /* Template widgets */
+  GtkScrolledWindow *scrolled_window;
 };
 
 G_DEFINE_FINAL_TYPE (BzAppsPage, bz_apps_page, ADW_TYPE_NAVIGATION_PAGE)
@@ -162,6 +165,26 @@ bz_apps_page_set_property (GObject      *object,
     }
 }
 
+static void
+vadjustment_changed_cb (BzAppsPage    *self,
+                        GtkAdjustment *adjustment)
+{
+  double value     = 0.0;
+  double page_size = 0.0;
+  double upper     = 0.0;
+
+  if (self->category == NULL)
+    return;
+
+  value     = gtk_adjustment_get_value (adjustment);
+  page_size = gtk_adjustment_get_page_size (adjustment);
+  upper     = gtk_adjustment_get_upper (adjustment);
+
+  /* Start loading once the remaining content is shorter than a viewport */
+  if (value + page_size * 2.0 >= upper)
+    bz_flathub_category_load_more (self->category);
+}
+
 static void
 bind_widget_cb (BzAppsPage        *self,
                 BzAppTile         *tile,
@@ -326,6 +349,7 @@ bz_apps_page_class_init (BzAppsPageClass *klass)
   g_type_ensure (BZ_TYPE_SUBCATEGORY_LIST);
 
   gtk_widget_class_set_template_from_resource (widget_class, "/io/github/kolunmi/Bazaar/bz-apps-page.ui");
+  gtk_widget_class_bind_template_child (widget_class, BzAppsPage, scrolled_window);
   gtk_widget_class_bind_template_callback (widget_class, is_not_null);
   gtk_widget_class_bind_template_callback (widget_class, is_not_empty_string);
   gtk_widget_class_bind_template_callback (widget_class, is_not_empty_list);
@@ -369,32 +393,10 @@ bz_apps_page_new_with_carousel (const char *title,
 
 static gboolean
 filter_by_category (BzEntryGroup *group,
-                    const char   *category_name)
+                    gpointer      category_id)
 {
-  GListModel *categories = NULL;
-  guint       n_items    = 0;
-
   g_return_val_if_fail (BZ_IS_ENTRY_GROUP (group), FALSE);
-  g_return_val_if_fail (category_name != NULL, FALSE);
-
-  categories = bz_entry_group_get_categories (group);
-  if (categories == NULL)
-    return FALSE;
-
-  n_items = g_list_model_get_n_items (categories);
-  for (guint i = 0; i < n_items; i++)
-    {
-      g_autoptr (BzFlathubCategory) category = NULL;
-      const char *name                       = NULL;
-
-      category = g_list_model_get_item (categories, i);
-      name     = bz_flathub_category_get_name (category);
-
-      if (g_strcmp0 (name, category_name) == 0)
-        return TRUE;
-    }
-
-  return FALSE;
+  return bz_entry_group_has_category (group, GPOINTER_TO_UINT (category_id));
 }
 
 static DexFuture *
@@ -402,9 +404,11 @@ filter_applications_fiber (BzAppsPage *self)
 {
   g_autoptr (GError) error                      = NULL;
   g_autoptr (GtkFilterListModel) filtered_model = NULL;
-  GListModel  *all_model                        = NULL;
-  const char  *category_name                    = NULL;
-  BzStateInfo *state_info                       = NULL;
+  g_autoptr (GListModel) indexed_model          = NULL;
+  GListModel     *all_model                     = NULL;
+  const char     *category_name                 = NULL;
+  BzStateInfo    *state_info                    = NULL;
+  BzCatalogIndex *catalog_index                 = NULL;
 
   state_info = bz_state_info_get_default ();
   if (state_info == NULL)
@@ -418,12 +422,22 @@ filter_applications_fiber (BzAppsPage *self)
   if (category_name == NULL)
     return NULL;
 
+  catalog_index = bz_state_info_get_catalog_index (state_info);
+  if (catalog_index != NULL)
+    {
+      indexed_model = bz_catalog_index_dup_category (catalog_index, category_name);
+
+      g_set_object (&self->all_applications, indexed_model);
+      g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ALL_APPLICATIONS]);
+      return NULL;
+    }
+
   filtered_model = gtk_filter_list_model_new (
       g_object_ref (all_model),
       GTK_FILTER (gtk_custom_filter_new (
           (GtkCustomFilterFunc) filter_by_category,
-          g_strdup (category_name),
-          g_free)));
+          GUINT_TO_POINTER (bz_vocabulary_intern (bz_vocabulary_get_categories (), category_name)),
+          NULL)));
 
   g_set_object (&self->all_applications, G_LIST_MODEL (filtered_model));
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ALL_APPLICATIONS]);
@@ -506,6 +520,7 @@ bz_apps_page_new_from_category (BzFlathubCategory *category)
   g_autofree char   *subtitle           = NULL;
   int                total_entries      = 0;
   guint              n_items            = 0;
+  gboolean           paged              = FALSE;
 
   g_return_val_if_fail (BZ_IS_FLATHUB_CATEGORY (category), NULL);
 
@@ -519,8 +534,10 @@ bz_apps_page_new_from_category (BzFlathubCategory *category)
 
   carousel_model = bz_flathub_category_dup_quality_applications (category);
   total_entries  = bz_flathub_category_get_total_entries (category);
+  paged          = bz_flathub_category_get_page_route (category) != NULL;
 
-  if (n_items > 48)
+  /* A paged category grows as it is scrolled, so it never needs splitting */
+  if (n_items > 48 && !paged)
     apps_page = create_split_page (title, model, carousel_model);
   else
     apps_page = create_standard_page (title, model, carousel_model);
@@ -534,7 +551,21 @@ bz_apps_page_new_from_category (BzFlathubCategory *category)
   BZ_APPS_PAGE(apps_page)->category = g_object_ref (category);
   g_object_notify_by_pspec (G_OBJECT (apps_page), props[PROP_CATEGORY]);
 
-  if (n_items <= 48)
+  if (paged)
+    {
+      GtkAdjustment *vadjustment = NULL;
+
+      vadjustment = gtk_scrolled_window_get_vadjustment (BZ_APPS_PAGE (apps_page)->scrolled_window);
+      g_signal_connect_object (vadjustment, "value-changed",
+                               G_CALLBACK (vadjustment_changed_cb),
+                               apps_page, G_CONNECT_SWAPPED);
+      g_signal_connect_object (vadjustment, "changed",
+                               G_CALLBACK (vadjustment_changed_cb),
+                               apps_page, G_CONNECT_SWAPPED);
+      bz_flathub_category_prefetch (category);
+    }
+
+  if (n_items <= 48 || paged)
     setup_category_filter (apps_page, category_name);
 
   return apps_page;
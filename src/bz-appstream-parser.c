@@ -12,6 +12,7 @@
 #include "bz-flathub-category.h"
 #include "bz-io.h"
 #include "bz-release.h"
+#include "bz-spdx.h"
 #include "bz-url.h"
 #include "bz-verification-status.h"
 
@@ -49,9 +50,17 @@ calculate_is_mobile_friendly (guint required_controls,
   return (supported_controls & BZ_CONTROL_TOUCH) != 0;
 }
 
+/* The resize options are only the default variant, BzAsyncTexture swaps
+   them for ones matching the widget that ends up drawing the image. When
+   the source dimensions are known they are spelled out so the texture
+   knows its natural size before anything is downloaded */
 static char *
-proxy_screenshot_url (const char *url, gboolean high_quality)
+proxy_screenshot_url (const char *url,
+                      gboolean    high_quality,
+                      guint       width,
+                      guint       height)
 {
+  g_autofree char *options     = NULL;
   g_autofree char *src         = NULL;
   g_autofree char *encoded_url = NULL;
   const char      *suffix      = NULL;
@@ -79,9 +88,17 @@ proxy_screenshot_url (const char *url, gboolean high_quality)
       if (*p == '/') *p = '_';
     }
 
+  if (width > 0 && height > 0)
+    options = g_strdup_printf (
+        high_quality ? "rs:fit:%u:%u/q:90/f:avif" : "rs:fit:%u:%u/dpr:1/f:avif",
+        width, height);
+  else
+    options = g_strdup (high_quality ? "q:90/f:avif" : "dpr:1/f:avif/rs:fill-down");
+
   return g_strdup_printf (
-      "https://imgproxy.flathub.org/insecure/%s/%s",
-      high_quality ? "q:90/f:avif" : "dpr:1/f:avif/rs:fill-down",
+      "%s%s/%s",
+      BZ_ASYNC_TEXTURE_IMGPROXY_PREFIX,
+      options,
       encoded_url);
 }
 
@@ -98,8 +115,12 @@ find_screenshot (GPtrArray  *images,
                  char      **out_caption)
 {
   const char *best_url      = NULL;
+  guint       best_width    = 0;
+  guint       best_height   = 0;
   gint        best_diff     = G_MAXINT;
   guint       best_res      = 0;
+  const char *proxy_url     = NULL;
+  guint       proxy_res     = 0;
   guint       target_pixels = target_width * target_height;
 
   if (images == NULL)
@@ -112,19 +133,29 @@ find_screenshot (GPtrArray  *images,
       guint       width     = as_image_get_width (image_obj);
       guint       height    = as_image_get_height (image_obj);
       guint       pixels    = width * height;
+      gboolean    flathub   = FALSE;
 
       if (url == NULL)
         continue;
 
-      if (require_flathub && !g_str_has_prefix (url, "https://dl.flathub.org/"))
+      flathub = g_str_has_prefix (url, "https://dl.flathub.org/");
+      if (require_flathub && !flathub)
         continue;
 
+      if (flathub && (proxy_url == NULL || pixels > proxy_res))
+        {
+          proxy_url = url;
+          proxy_res = pixels;
+        }
+
       if (match_highest)
         {
           if (pixels > best_res)
             {
-              best_url = url;
-              best_res = pixels;
+              best_url    = url;
+              best_width  = width;
+              best_height = height;
+              best_res    = pixels;
             }
         }
       else
@@ -132,12 +163,20 @@ find_screenshot (GPtrArray  *images,
           gint diff = ABS ((gint) pixels - (gint) target_pixels);
           if (diff < best_diff)
             {
-              best_url  = url;
-              best_diff = diff;
+              best_url    = url;
+              best_width  = width;
+              best_height = height;
+              best_diff   = diff;
             }
         }
     }
 
+  /* Anything imgproxy can resize is best fetched from the largest source,
+     the pick above then only decides the default size. The size actually
+     fetched is decided at load time */
+  if (best_url != NULL && g_str_has_prefix (best_url, "https://dl.flathub.org/"))
+    best_url = proxy_url;
+
   if (best_url != NULL)
     {
       g_autoptr (GFile) screenshot_file = NULL;
@@ -145,7 +184,7 @@ find_screenshot (GPtrArray  *images,
       g_autofree char  *proxied_url     = NULL;
       BzAsyncTexture *texture           = NULL;
 
-      proxied_url     = proxy_screenshot_url (best_url, match_highest);
+      proxied_url     = proxy_screenshot_url (best_url, match_highest, best_width, best_height);
       screenshot_file = g_file_new_for_uri (proxied_url);
       cache_file      = g_file_new_build_filename (
           module_dir, unique_id_checksum, cache_filename, NULL);
@@ -230,7 +269,7 @@ bz_appstream_parser_populate_entry (BzEntry     *entry,
   description      = as_component_get_summary (component);
   metadata_license = as_component_get_metadata_license (component);
   project_license  = as_component_get_project_license (component);
-  is_floss         = as_component_is_floss (component);
+  is_floss         = project_license != NULL && bz_spdx_is_floss (project_license);
   project_group    = as_component_get_project_group (component);
   project_url      = as_component_get_url (component, AS_URL_KIND_HOMEPAGE);
   as_search_tokens = as_component_get_search_tokens (component);
@@ -26,12 +26,27 @@
 #define MAX_LOAD_RETRIES       3
 #define RETRY_INTERVAL_SECONDS 1
 
+/* Decoded pixels are cached next to the encoded image so that reviving a
+   texture is a mapping of the file rather than a full decode */
+#define RAW_CACHE_MAGIC      0x58545a42 /* "BZTX" */
+#define RAW_CACHE_VERSION    1
+#define RAW_CACHE_FORMAT     GDK_MEMORY_R8G8B8A8_PREMULTIPLIED
+#define RAW_CACHE_MAX_PIXELS (2048 * 2048)
+
+/* Textures loaded through imgproxy can be re-requested at the size they are
+   actually drawn at. Requested sizes are rounded up to this many logical
+   pixels so small allocation changes don't each produce a new download */
+#define VARIANT_STEP             128
+#define ROUND_UP_VARIANT(_size) (((_size) + VARIANT_STEP - 1) / VARIANT_STEP * VARIANT_STEP)
+
 #include "config.h"
 
+#include <glib/gstdio.h>
 #include <glycin-gtk4-2/glycin-gtk4.h>
 #include <libdex.h>
 
 #include "bz-async-texture.h"
+#include "bz-cache-registry.h"
 #include "bz-download-worker.h"
 #include "bz-env.h"
 #include "bz-io.h"
@@ -47,6 +62,9 @@ BZ_DEFINE_DATA (
       char         *cache_into_path;
       GCancellable *cancellable;
       int           retries;
+      int           variant_width;
+      int           variant_height;
+      int           variant_scale;
       GWeakRef      self;
     },
     BZ_RELEASE_DATA (source, g_object_unref);
@@ -56,6 +74,16 @@ BZ_DEFINE_DATA (
     BZ_RELEASE_DATA (cancellable, g_object_unref);
     g_weak_ref_clear (&self->self);)
 
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  guint32 format;
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+} RawCacheHeader;
+
 struct _BzAsyncTexture
 {
   GObject parent_instance;
@@ -66,6 +94,26 @@ struct _BzAsyncTexture
   char    *cache_into_path;
   gboolean lazy;
 
+  /* Only set for imgproxy sources. The variant fields describe the bounds
+     of whatever is loaded or loading, in logical pixels where 0 means
+     unbounded, and the request fields what the widgets drawing us want.
+     The natural size is that of the default variant, which the parser
+     sizes explicitly, so that other variants only sharpen the image
+     without changing the layout around it. The cache path of the last
+     loaded variant is kept so it can be pruned once a larger one lands */
+  gboolean resizable;
+  gboolean exhausted;
+  char    *variant_cache_path;
+  int      variant_width;
+  int      variant_height;
+  int      variant_scale;
+  int      natural_width;
+  int      natural_height;
+  int      request_width;
+  int      request_height;
+  int      request_scale;
+  guint    deferred_load;
+
   DexFuture    *task;
   GCancellable *cancellable;
 
@@ -74,6 +122,11 @@ struct _BzAsyncTexture
 
   GdkPaintable *paintable;
   GMutex        texture_mutex;
+
+  /* The intrinsic size of pixels dropped by a shed, so nothing around us
+     moves while they are reloaded */
+  int shed_width;
+  int shed_height;
 };
 
 static void paintable_iface_init (GdkPaintableInterface *iface);
@@ -96,6 +149,11 @@ enum
 };
 static GParamSpec *props[LAST_PROP] = { 0 };
 
+/* Every texture alive in the process, so their pixels can be dropped under
+   memory pressure. BzAsyncTexture -> GWeakRef */
+static GMutex      live_mutex = { 0 };
+static GHashTable *live       = NULL;
+
 static DexFuture *
 load_fiber_work (LoadData *data);
 
@@ -106,18 +164,55 @@ load_finally (DexFuture *future,
 static void
 maybe_load (BzAsyncTexture *self);
 
+static void
+maybe_load_deferred (BzAsyncTexture *self);
+
+static gboolean
+deferred_load_cb (BzAsyncTexture *self);
+
+static gboolean
+needs_larger_variant (BzAsyncTexture *self);
+
+static void
+parse_variant (BzAsyncTexture *self);
+
+static char *
+dup_variant_uri (const char *uri,
+                 int         width,
+                 int         height,
+                 int         scale);
+
 static DexFuture *
 retry_cb (DexFuture *future,
           LoadData  *data);
 
+static DexFuture *
+prune_variant_fiber (char *path);
+
 static gboolean
 idle_notify (BzAsyncTexture *self);
 
+static void
+shed_textures (gpointer user_data);
+
+static GdkTexture *
+load_raw_texture (const char *path,
+                  GError    **error);
+
+static gboolean
+save_raw_texture (GdkTexture *texture,
+                  const char *path,
+                  GError    **error);
+
 static void
 bz_async_texture_dispose (GObject *object)
 {
   BzAsyncTexture *self = BZ_ASYNC_TEXTURE (object);
 
+  g_mutex_lock (&live_mutex);
+  g_hash_table_remove (live, self);
+  g_mutex_unlock (&live_mutex);
+
   if (self->cancellable != NULL)
     g_cancellable_cancel (self->cancellable);
   dex_clear (&self->task);
@@ -128,6 +223,7 @@ bz_async_texture_dispose (GObject *object)
   g_clear_pointer (&self->source_uri, g_free);
   g_clear_object (&self->cache_into);
   g_clear_pointer (&self->cache_into_path, g_free);
+  g_clear_pointer (&self->variant_cache_path, g_free);
   g_clear_object (&self->paintable);
   g_mutex_clear (&self->texture_mutex);
 
@@ -207,14 +303,22 @@ bz_async_texture_class_init (BzAsyncTextureClass *klass)
           G_PARAM_READABLE);
 
   g_object_class_install_properties (object_class, LAST_PROP, props);
+
+  live = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, bz_weak_release);
+  bz_cache_registry_add (BZ_CACHE_PRIORITY_TEXTURES, shed_textures, NULL, NULL);
 }
 
 static void
 bz_async_texture_init (BzAsyncTexture *self)
 {
-  self->retries   = 0;
-  self->paintable = NULL;
+  self->retries       = 0;
+  self->paintable     = NULL;
+  self->variant_scale = 1;
   g_mutex_init (&self->texture_mutex);
+
+  g_mutex_lock (&live_mutex);
+  g_hash_table_replace (live, self, bz_track_weak (self));
+  g_mutex_unlock (&live_mutex);
 }
 
 static void
@@ -227,7 +331,7 @@ paintable_snapshot (GdkPaintable *paintable,
   g_autoptr (GMutexLocker) locker = NULL;
 
   locker = g_mutex_locker_new (&self->texture_mutex);
-  maybe_load (self);
+  maybe_load_deferred (self);
 
   if (self->paintable != NULL)
     gdk_paintable_snapshot (self->paintable, snapshot, width, height);
@@ -240,7 +344,7 @@ paintable_get_current_image (GdkPaintable *paintable)
   g_autoptr (GMutexLocker) locker = NULL;
 
   locker = g_mutex_locker_new (&self->texture_mutex);
-  maybe_load (self);
+  maybe_load_deferred (self);
 
   if (self->paintable != NULL)
     return gdk_paintable_get_current_image (self->paintable);
@@ -255,7 +359,7 @@ paintable_get_flags (GdkPaintable *paintable)
   g_autoptr (GMutexLocker) locker = NULL;
 
   locker = g_mutex_locker_new (&self->texture_mutex);
-  maybe_load (self);
+  maybe_load_deferred (self);
   return 0;
 }
 
@@ -266,12 +370,14 @@ paintable_get_intrinsic_width (GdkPaintable *paintable)
   g_autoptr (GMutexLocker) locker = NULL;
 
   locker = g_mutex_locker_new (&self->texture_mutex);
-  maybe_load (self);
+  maybe_load_deferred (self);
 
-  if (self->paintable != NULL)
+  if (self->natural_width > 0)
+    return self->natural_width;
+  else if (self->paintable != NULL)
     return gdk_paintable_get_intrinsic_width (self->paintable);
 
-  return 0;
+  return self->shed_width;
 }
 
 static int
@@ -281,12 +387,14 @@ paintable_get_intrinsic_height (GdkPaintable *paintable)
   g_autoptr (GMutexLocker) locker = NULL;
 
   locker = g_mutex_locker_new (&self->texture_mutex);
-  maybe_load (self);
+  maybe_load_deferred (self);
 
-  if (self->paintable != NULL)
+  if (self->natural_height > 0)
+    return self->natural_height;
+  else if (self->paintable != NULL)
     return gdk_paintable_get_intrinsic_height (self->paintable);
 
-  return 0;
+  return self->shed_height;
 }
 
 static double
@@ -296,10 +404,14 @@ paintable_get_intrinsic_aspect_ratio (GdkPaintable *paintable)
   g_autoptr (GMutexLocker) locker = NULL;
 
   locker = g_mutex_locker_new (&self->texture_mutex);
-  maybe_load (self);
+  maybe_load_deferred (self);
 
+  if (self->natural_width > 0 && self->natural_height > 0)
+    return (double) self->natural_width / (double) self->natural_height;
   if (self->paintable != NULL)
     return gdk_paintable_get_intrinsic_aspect_ratio (self->paintable);
+  if (self->shed_width > 0 && self->shed_height > 0)
+    return (double) self->shed_width / (double) self->shed_height;
 
   return 0.0;
 }
@@ -330,6 +442,7 @@ bz_async_texture_new (GFile *source,
   self->cache_into      = bz_object_maybe_ref (cache_into);
   self->cache_into_path = bz_maybe (cache_into, g_file_get_path);
   self->lazy            = FALSE;
+  parse_variant (self);
 
   maybe_load (self);
   return self;
@@ -350,6 +463,7 @@ bz_async_texture_new_lazy (GFile *source,
   self->cache_into      = bz_object_maybe_ref (cache_into);
   self->cache_into_path = bz_maybe (cache_into, g_file_get_path);
   self->lazy            = TRUE;
+  parse_variant (self);
 
   return self;
 }
@@ -458,13 +572,49 @@ bz_async_texture_is_loading (BzAsyncTexture *self)
   return self->task != NULL && dex_future_is_pending (self->task);
 }
 
+void
+bz_async_texture_request_size (BzAsyncTexture *self,
+                               int             width,
+                               int             height,
+                               int             scale)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+
+  g_return_if_fail (BZ_IS_ASYNC_TEXTURE (self));
+
+  if (!self->resizable || (width <= 0 && height <= 0))
+    return;
+
+  width  = MAX (width, 0);
+  height = MAX (height, 0);
+  scale  = MAX (scale, 1);
+
+  locker = g_mutex_locker_new (&self->texture_mutex);
+
+  /* Never shrink what was asked for, one widget drawing us large shouldn't
+     be undone by another drawing us small */
+  if ((gint64) width * scale <= (gint64) self->request_width * self->request_scale &&
+      (gint64) height * scale <= (gint64) self->request_height * self->request_scale)
+    return;
+
+  self->request_width  = MAX (width, self->request_width);
+  self->request_height = MAX (height, self->request_height);
+  self->request_scale  = MAX (scale, self->request_scale);
+
+  if (needs_larger_variant (self))
+    {
+      self->retries = 0;
+      maybe_load (self);
+    }
+}
+
 static void
 maybe_load (BzAsyncTexture *self)
 {
   g_autoptr (LoadData) data    = NULL;
   g_autoptr (DexFuture) future = NULL;
 
-  if (GDK_IS_TEXTURE (self->paintable) ||
+  if ((GDK_IS_TEXTURE (self->paintable) && !needs_larger_variant (self)) ||
       (self->task != NULL && dex_future_is_pending (self->task)) ||
       self->retries >= MAX_LOAD_RETRIES)
     return;
@@ -476,15 +626,52 @@ maybe_load (BzAsyncTexture *self)
 
   self->cancellable = g_cancellable_new ();
 
-  data                  = load_data_new ();
-  data->source          = g_object_ref (self->source);
-  data->source_uri      = g_strdup (self->source_uri);
-  data->cache_into      = bz_object_maybe_ref (self->cache_into);
-  data->cache_into_path = bz_maybe_strdup (self->cache_into_path);
-  data->cancellable     = g_object_ref (self->cancellable);
-  data->retries         = self->retries;
+  data                 = load_data_new ();
+  data->cancellable    = g_object_ref (self->cancellable);
+  data->retries        = self->retries;
+  data->variant_width  = self->variant_width;
+  data->variant_height = self->variant_height;
+  data->variant_scale  = self->variant_scale;
   g_weak_ref_init (&data->self, self);
 
+  if (self->resizable &&
+      (self->request_width > 0 || self->request_height > 0))
+    {
+      data->variant_width  = ROUND_UP_VARIANT (self->request_width);
+      data->variant_height = ROUND_UP_VARIANT (self->request_height);
+      data->variant_scale  = self->request_scale;
+
+      data->source_uri = dup_variant_uri (
+          self->source_uri,
+          data->variant_width,
+          data->variant_height,
+          data->variant_scale);
+      data->source = g_file_new_for_uri (data->source_uri);
+
+      /* Each variant gets its own cache entry */
+      if (self->cache_into_path != NULL)
+        {
+          data->cache_into_path = g_strdup_printf (
+              "%s-%dx%d@%d",
+              self->cache_into_path,
+              data->variant_width,
+              data->variant_height,
+              data->variant_scale);
+          data->cache_into = g_file_new_for_path (data->cache_into_path);
+        }
+
+      self->variant_width  = data->variant_width;
+      self->variant_height = data->variant_height;
+      self->variant_scale  = data->variant_scale;
+    }
+  else
+    {
+      data->source          = g_object_ref (self->source);
+      data->source_uri      = g_strdup (self->source_uri);
+      data->cache_into      = bz_object_maybe_ref (self->cache_into);
+      data->cache_into_path = bz_maybe_strdup (self->cache_into_path);
+    }
+
   future = dex_scheduler_spawn (
       bz_get_io_scheduler (),
       bz_get_dex_stack_size (),
@@ -526,6 +713,8 @@ load_fiber_work (LoadData *data)
   g_autoptr (GDateTime) now             = NULL;
   g_autofree char *async_tex_data_path  = NULL;
   g_autoptr (GFile) async_tex_data_file = NULL;
+  g_autofree char *async_tex_raw_path   = NULL;
+  gboolean         write_raw            = FALSE;
   g_autoptr (GdkTexture) texture        = NULL;
   g_autoptr (GlyFrame) frame            = NULL;
 
@@ -614,6 +803,7 @@ load_fiber_work (LoadData *data)
     {
       async_tex_data_path = g_strdup_printf ("%s.bz-async-texture-data", cache_into_path);
       async_tex_data_file = g_file_new_for_path (async_tex_data_path);
+      async_tex_raw_path  = g_strdup_printf ("%s.bz-async-texture-raw", cache_into_path);
     }
 
   if (cache_into != NULL)
@@ -653,20 +843,32 @@ load_fiber_work (LoadData *data)
             {
               if (age_span < CACHE_INVALID_AGE)
                 {
-                  RATE_LIMIT_END ();
-                  RATE_LIMIT_BEGIN (glycin);
-
-                  loader = gly_loader_new (cache_into);
-                  /* We assume we exported this file, so uhhh it is safe to
-                     not use sandboxing, since it is faster :-) */
-                  gly_loader_set_sandbox_selector (loader, GLY_SANDBOX_SELECTOR_NOT_SANDBOXED);
-
-                  image = gly_loader_load (loader, &local_error);
-                  if (image != NULL)
-                    frame = gly_image_next_frame (image, &local_error);
-
-                  RATE_LIMIT_END ();
-                  RATE_LIMIT_BEGIN (io);
+                  texture = load_raw_texture (async_tex_raw_path, &local_error);
+                  if (texture == NULL)
+                    {
+                      if (!g_error_matches (local_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+                        g_debug ("Couldn't map decoded pixel cache %s for cached texture at %s, "
+                                 "decoding the encoded image instead: %s",
+                                 async_tex_raw_path, cache_into_path, local_error->message);
+                      g_clear_pointer (&local_error, g_error_free);
+
+                      RATE_LIMIT_END ();
+                      RATE_LIMIT_BEGIN (glycin);
+
+                      loader = gly_loader_new (cache_into);
+                      /* We assume we exported this file, so uhhh it is safe to
+                         not use sandboxing, since it is faster :-) */
+                      gly_loader_set_sandbox_selector (loader, GLY_SANDBOX_SELECTOR_NOT_SANDBOXED);
+
+                      image = gly_loader_load (loader, &local_error);
+                      if (image != NULL)
+                        frame = gly_image_next_frame (image, &local_error);
+
+                      RATE_LIMIT_END ();
+                      RATE_LIMIT_BEGIN (io);
+
+                      write_raw = frame != NULL;
+                    }
                 }
               else
                 g_debug ("Metadata file %s for cached texture at %s indicates this resource is too old (GTimeSpan: %zu), "
@@ -681,7 +883,7 @@ load_fiber_work (LoadData *data)
               g_clear_pointer (&local_error, g_error_free);
             }
 
-          if (frame == NULL)
+          if (texture == NULL && frame == NULL)
             {
               if (local_error != NULL)
                 g_warning ("An attempt to revive cached texture at %s has failed, "
@@ -696,13 +898,14 @@ load_fiber_work (LoadData *data)
                              cache_into_path, local_error->message);
                   g_clear_pointer (&local_error, g_error_free);
                 }
+              g_unlink (async_tex_raw_path);
             }
         }
 
       RATE_LIMIT_END ();
     }
 
-  if (frame == NULL)
+  if (texture == NULL && frame == NULL)
     {
       g_autoptr (GFile) load_file  = NULL;
       g_autoptr (GlyLoader) loader = NULL;
@@ -825,6 +1028,8 @@ load_fiber_work (LoadData *data)
 
       RATE_LIMIT_END ();
 
+      write_raw = cache_into != NULL;
+
       if (async_tex_data_file != NULL)
         {
           g_autoptr (GVariantBuilder) builder  = NULL;
@@ -870,12 +1075,30 @@ load_fiber_work (LoadData *data)
         }
     }
 
-  texture = gly_gtk_frame_get_texture (frame);
   if (texture == NULL)
-    return dex_future_new_reject (
-        G_IO_ERROR,
-        G_IO_ERROR_FAILED,
-        "texture loading failed");
+    {
+      texture = gly_gtk_frame_get_texture (frame);
+      if (texture == NULL)
+        return dex_future_new_reject (
+            G_IO_ERROR,
+            G_IO_ERROR_FAILED,
+            "texture loading failed");
+    }
+
+  if (write_raw &&
+      async_tex_raw_path != NULL &&
+      (gint64) gdk_texture_get_width (texture) * gdk_texture_get_height (texture) <= RAW_CACHE_MAX_PIXELS)
+    {
+      RATE_LIMIT_BEGIN (io);
+      result = save_raw_texture (texture, async_tex_raw_path, &local_error);
+      RATE_LIMIT_END ();
+
+      if (!result)
+        g_warning ("Failed to write decoded pixel cache to %s ; "
+                   "The image will be decoded again next time: %s",
+                   async_tex_raw_path, local_error->message);
+      g_clear_pointer (&local_error, g_error_free);
+    }
 
   return dex_future_new_for_object (texture);
 }
@@ -898,11 +1121,42 @@ load_finally (DexFuture *future,
       g_clear_object (&self->paintable);
       self->paintable = g_value_dup_object (dex_future_get_value (future, NULL));
 
+      /* imgproxy doesn't enlarge, so if the source couldn't fill the variant
+         in either direction there's nothing bigger to ask for */
+      if (self->resizable &&
+          (data->variant_width == 0 ||
+           gdk_texture_get_width (GDK_TEXTURE (self->paintable)) <
+               data->variant_width * data->variant_scale) &&
+          (data->variant_height == 0 ||
+           gdk_texture_get_height (GDK_TEXTURE (self->paintable)) <
+               data->variant_height * data->variant_scale))
+        self->exhausted = TRUE;
+
+      /* Variants only ever grow, so the one this replaces is dead weight */
+      if (self->resizable &&
+          data->cache_into_path != NULL &&
+          g_strcmp0 (data->cache_into_path, self->cache_into_path) != 0)
+        {
+          if (self->variant_cache_path != NULL &&
+              !g_str_equal (self->variant_cache_path, data->cache_into_path))
+            dex_future_disown (dex_scheduler_spawn (
+                bz_get_io_scheduler (),
+                bz_get_dex_stack_size (),
+                (DexFiberFunc) prune_variant_fiber,
+                g_steal_pointer (&self->variant_cache_path), g_free));
+          g_free (self->variant_cache_path);
+          self->variant_cache_path = g_strdup (data->cache_into_path);
+        }
+
       g_idle_add_full (
           G_PRIORITY_DEFAULT_IDLE,
           (GSourceFunc) idle_notify,
           g_object_ref (self), g_object_unref);
 
+      /* The request may have grown while we were loading */
+      if (needs_larger_variant (self))
+        maybe_load (self);
+
       return dex_future_new_for_object (self->paintable);
     }
   else
@@ -951,6 +1205,132 @@ retry_cb (DexFuture *future,
   return NULL;
 }
 
+static DexFuture *
+prune_variant_fiber (char *path)
+{
+  g_autofree char *data_path = NULL;
+  g_autofree char *raw_path  = NULL;
+
+  data_path = g_strdup_printf ("%s.bz-async-texture-data", path);
+  raw_path  = g_strdup_printf ("%s.bz-async-texture-raw", path);
+
+  g_unlink (path);
+  g_unlink (data_path);
+  g_unlink (raw_path);
+
+  return dex_future_new_true ();
+}
+
+static void
+maybe_load_deferred (BzAsyncTexture *self)
+{
+  /* The first size query on a resizable texture comes from measuring,
+     before the widget has been allocated and could request a size, so
+     wait until after the current frame to start loading */
+  if (self->resizable &&
+      self->paintable == NULL &&
+      self->task == NULL &&
+      self->request_width == 0 &&
+      self->request_height == 0)
+    {
+      if (self->deferred_load == 0)
+        self->deferred_load = g_idle_add_full (
+            G_PRIORITY_DEFAULT_IDLE,
+            (GSourceFunc) deferred_load_cb,
+            g_object_ref (self), g_object_unref);
+      return;
+    }
+
+  maybe_load (self);
+}
+
+static gboolean
+deferred_load_cb (BzAsyncTexture *self)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+
+  locker              = g_mutex_locker_new (&self->texture_mutex);
+  self->deferred_load = 0;
+  maybe_load (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+needs_larger_variant (BzAsyncTexture *self)
+{
+  if (!self->resizable || self->exhausted)
+    return FALSE;
+
+  return (self->variant_width > 0 &&
+          (gint64) self->request_width * self->request_scale >
+              (gint64) self->variant_width * self->variant_scale) ||
+         (self->variant_height > 0 &&
+          (gint64) self->request_height * self->request_scale >
+              (gint64) self->variant_height * self->variant_scale);
+}
+
+static void
+parse_variant (BzAsyncTexture *self)
+{
+  const char *options = NULL;
+  const char *end     = NULL;
+
+  if (!g_str_has_prefix (self->source_uri, BZ_ASYNC_TEXTURE_IMGPROXY_PREFIX))
+    return;
+
+  options = self->source_uri + strlen (BZ_ASYNC_TEXTURE_IMGPROXY_PREFIX);
+  end     = strrchr (options, '/');
+  if (end == NULL)
+    return;
+
+  self->resizable = TRUE;
+
+  /* Figure out the bounds of the default variant so we know whether a
+     request needs anything bigger */
+  for (const char *p = options; p < end;)
+    {
+      const char *next = memchr (p, '/', end - p);
+
+      if (next == NULL)
+        next = end;
+
+      if (g_str_has_prefix (p, "rs:fit:"))
+        {
+          char *dim = NULL;
+
+          self->variant_width  = g_ascii_strtoll (p + strlen ("rs:fit:"), &dim, 10);
+          self->variant_height = *dim == ':' ? g_ascii_strtoll (dim + 1, NULL, 10) : 0;
+        }
+      else if (g_str_has_prefix (p, "dpr:"))
+        self->variant_scale = MAX (1, g_ascii_strtoll (p + strlen ("dpr:"), NULL, 10));
+
+      p = next + 1;
+    }
+
+  if (self->variant_width > 0 && self->variant_height > 0)
+    {
+      self->natural_width  = self->variant_width;
+      self->natural_height = self->variant_height;
+    }
+}
+
+static char *
+dup_variant_uri (const char *uri,
+                 int         width,
+                 int         height,
+                 int         scale)
+{
+  const char *encoded = NULL;
+
+  encoded = strrchr (uri, '/') + 1;
+  return g_strdup_printf (
+      "%srs:fit:%d:%d/dpr:%d/f:avif/%s",
+      BZ_ASYNC_TEXTURE_IMGPROXY_PREFIX,
+      width, height, scale,
+      encoded);
+}
+
 static gboolean
 idle_notify (BzAsyncTexture *self)
 {
@@ -960,3 +1340,145 @@ idle_notify (BzAsyncTexture *self)
 
   return G_SOURCE_REMOVE;
 }
+
+static void
+shed_textures (gpointer user_data)
+{
+  g_autoptr (GPtrArray) textures = NULL;
+  GHashTableIter iter            = { 0 };
+  GWeakRef      *wr              = NULL;
+  guint          n_shed          = 0;
+
+  /* There is no telling whether a texture is on screen from here, and one
+     which is would go blank until it is reloaded. Without a visible window
+     nothing is */
+  if (!bz_cache_registry_get_background ())
+    return;
+
+  textures = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_mutex_lock (&live_mutex);
+  g_hash_table_iter_init (&iter, live);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &wr))
+    {
+      BzAsyncTexture *texture = g_weak_ref_get (wr);
+
+      if (texture != NULL)
+        g_ptr_array_add (textures, texture);
+    }
+  g_mutex_unlock (&live_mutex);
+
+  for (guint i = 0; i < textures->len; i++)
+    {
+      BzAsyncTexture *self            = g_ptr_array_index (textures, i);
+      g_autoptr (GMutexLocker) locker = NULL;
+
+      locker = g_mutex_locker_new (&self->texture_mutex);
+
+      /* Only drop what can be revived from disk. Nothing is invalidated
+         here, the next snapshot reloads the texture */
+      if (!GDK_IS_TEXTURE (self->paintable) ||
+          self->cache_into_path == NULL ||
+          (self->task != NULL && dex_future_is_pending (self->task)))
+        continue;
+
+      self->shed_width  = gdk_paintable_get_intrinsic_width (self->paintable);
+      self->shed_height = gdk_paintable_get_intrinsic_height (self->paintable);
+      g_clear_object (&self->paintable);
+      self->retries = 0;
+      n_shed++;
+    }
+
+  g_debug ("Dropped the pixels of %u out of %u textures", n_shed, textures->len);
+}
+
+static GdkTexture *
+load_raw_texture (const char *path,
+                  GError    **error)
+{
+  g_autoptr (GMappedFile) mapped = NULL;
+  const char    *contents        = NULL;
+  gsize          length          = 0;
+  RawCacheHeader header          = { 0 };
+  g_autoptr (GBytes) bytes       = NULL;
+  g_autoptr (GBytes) pixels      = NULL;
+
+  mapped = g_mapped_file_new (path, FALSE, error);
+  if (mapped == NULL)
+    return NULL;
+
+  contents = g_mapped_file_get_contents (mapped);
+  length   = g_mapped_file_get_length (mapped);
+  if (contents == NULL || length < sizeof (header))
+    goto invalid;
+
+  memcpy (&header, contents, sizeof (header));
+  if (header.magic != RAW_CACHE_MAGIC ||
+      header.version != RAW_CACHE_VERSION ||
+      header.format != RAW_CACHE_FORMAT ||
+      header.width == 0 ||
+      header.height == 0 ||
+      header.stride < (guint64) header.width * 4 ||
+      length - sizeof (header) != (guint64) header.stride * header.height)
+    goto invalid;
+
+  /* The texture keeps the mapping alive for as long as it exists, and since
+     cache files are only ever replaced, never rewritten in place, the pages
+     can't change underneath it */
+  bytes  = g_mapped_file_get_bytes (mapped);
+  pixels = g_bytes_new_from_bytes (bytes, sizeof (header), length - sizeof (header));
+
+  return gdk_memory_texture_new (
+      header.width,
+      header.height,
+      RAW_CACHE_FORMAT,
+      pixels,
+      header.stride);
+
+invalid:
+  g_set_error (
+      error,
+      G_IO_ERROR,
+      G_IO_ERROR_INVALID_DATA,
+      "decoded pixel cache at %s is malformed",
+      path);
+  return NULL;
+}
+
+static gboolean
+save_raw_texture (GdkTexture *texture,
+                  const char *path,
+                  GError    **error)
+{
+  g_autoptr (GdkTextureDownloader) downloader = NULL;
+  g_autoptr (GBytes) pixels                   = NULL;
+  gsize          stride                       = 0;
+  RawCacheHeader header                       = { 0 };
+  g_autoptr (GByteArray) contents             = NULL;
+
+  downloader = gdk_texture_downloader_new (texture);
+  gdk_texture_downloader_set_format (downloader, RAW_CACHE_FORMAT);
+  pixels = gdk_texture_downloader_download_bytes (downloader, &stride);
+
+  header.magic   = RAW_CACHE_MAGIC;
+  header.version = RAW_CACHE_VERSION;
+  header.format  = RAW_CACHE_FORMAT;
+  header.width   = gdk_texture_get_width (texture);
+  header.height  = gdk_texture_get_height (texture);
+  header.stride  = stride;
+
+  contents = g_byte_array_sized_new (sizeof (header) + g_bytes_get_size (pixels));
+  g_byte_array_append (contents, (const guint8 *) &header, sizeof (header));
+  g_byte_array_append (
+      contents,
+      g_bytes_get_data (pixels, NULL),
+      g_bytes_get_size (pixels));
+
+  return g_file_set_contents_full (
+      path,
+      (const char *) contents->data,
+      contents->len,
+      G_FILE_SET_CONTENTS_CONSISTENT,
+      0644,
+      error);
+}
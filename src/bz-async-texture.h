@@ -25,6 +25,10 @@
 
 G_BEGIN_DECLS
 
+/* Sources under this prefix can be resized on request, see
+   bz_async_texture_request_size () */
+#define BZ_ASYNC_TEXTURE_IMGPROXY_PREFIX "https://imgproxy.flathub.org/insecure/"
+
 #define BZ_TYPE_ASYNC_TEXTURE (bz_async_texture_get_type ())
 G_DECLARE_FINAL_TYPE (BzAsyncTexture, bz_async_texture, BZ, ASYNC_TEXTURE, GObject)
 
@@ -66,4 +70,13 @@ bz_async_texture_cancel (BzAsyncTexture *self);
 gboolean
 bz_async_texture_is_loading (BzAsyncTexture *self);
 
+/* Tells the texture it is drawn at `width` by `height` logical pixels (0
+   for an unconstrained dimension) at `scale`, so it can fetch a variant
+   that matches. Only ever grows the texture */
+void
+bz_async_texture_request_size (BzAsyncTexture *self,
+                               int             width,
+                               int             height,
+                               int             scale);
+
 G_END_DECLS
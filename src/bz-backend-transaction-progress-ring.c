@@ -0,0 +1,135 @@
+/* bz-backend-transaction-progress-ring.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::TRANSACTION-PROGRESS-RING"
+
+#include "bz-backend-transaction-progress-ring.h"
+
+#define CAPACITY BZ_BACKEND_TRANSACTION_PROGRESS_RING_CAPACITY
+
+struct _BzBackendTransactionProgressRing
+{
+  GObject parent_instance;
+
+  GMutex   mutex;
+  guint    head;
+  guint    len;
+  gboolean signalled;
+
+  BzBackendTransactionProgress ticks[CAPACITY];
+};
+
+G_DEFINE_FINAL_TYPE (BzBackendTransactionProgressRing, bz_backend_transaction_progress_ring, G_TYPE_OBJECT)
+
+static void
+bz_backend_transaction_progress_ring_finalize (GObject *object)
+{
+  BzBackendTransactionProgressRing *self = BZ_BACKEND_TRANSACTION_PROGRESS_RING (object);
+
+  g_mutex_clear (&self->mutex);
+
+  G_OBJECT_CLASS (bz_backend_transaction_progress_ring_parent_class)->finalize (object);
+}
+
+static void
+bz_backend_transaction_progress_ring_class_init (BzBackendTransactionProgressRingClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = bz_backend_transaction_progress_ring_finalize;
+}
+
+static void
+bz_backend_transaction_progress_ring_init (BzBackendTransactionProgressRing *self)
+{
+  g_mutex_init (&self->mutex);
+}
+
+BzBackendTransactionProgressRing *
+bz_backend_transaction_progress_ring_new (void)
+{
+  return g_object_new (BZ_TYPE_BACKEND_TRANSACTION_PROGRESS_RING, NULL);
+}
+
+gboolean
+bz_backend_transaction_progress_ring_push (BzBackendTransactionProgressRing   *self,
+                                           const BzBackendTransactionProgress *progress)
+{
+  g_autoptr (GMutexLocker) locker    = NULL;
+  BzBackendTransactionProgress *slot = NULL;
+  gboolean                      wake = FALSE;
+
+  g_return_val_if_fail (BZ_IS_BACKEND_TRANSACTION_PROGRESS_RING (self), FALSE);
+  g_return_val_if_fail (progress != NULL, FALSE);
+
+  locker = g_mutex_locker_new (&self->mutex);
+
+  /* Consecutive ticks from the same operation supersede each other */
+  if (self->len > 0)
+    {
+      slot = &self->ticks[(self->head + self->len - 1) % CAPACITY];
+      if (slot->op_id != progress->op_id)
+        slot = NULL;
+    }
+
+  if (slot == NULL)
+    {
+      if (self->len == CAPACITY)
+        {
+          self->head = (self->head + 1) % CAPACITY;
+          self->len--;
+        }
+      slot = &self->ticks[(self->head + self->len) % CAPACITY];
+      self->len++;
+    }
+  *slot = *progress;
+
+  wake            = !self->signalled;
+  self->signalled = TRUE;
+
+  return wake;
+}
+
+guint
+bz_backend_transaction_progress_ring_drain (BzBackendTransactionProgressRing *self,
+                                            BzBackendTransactionProgress     *out,
+                                            guint                             n_out)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+  guint n_ticks                   = 0;
+
+  g_return_val_if_fail (BZ_IS_BACKEND_TRANSACTION_PROGRESS_RING (self), 0);
+  g_return_val_if_fail (out != NULL, 0);
+  g_return_val_if_fail (n_out >= CAPACITY, 0);
+
+  locker = g_mutex_locker_new (&self->mutex);
+
+  n_ticks = self->len;
+  for (guint i = 0; i < n_ticks; i++)
+    out[i] = self->ticks[(self->head + i) % CAPACITY];
+
+  self->head      = 0;
+  self->len       = 0;
+  self->signalled = FALSE;
+
+  return n_ticks;
+}
+
+/* End of bz-backend-transaction-progress-ring.c */
@@ -0,0 +1,66 @@
+/* bz-backend-transaction-progress-ring.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define BZ_BACKEND_TRANSACTION_PROGRESS_RING_CAPACITY 64
+#define BZ_BACKEND_TRANSACTION_PROGRESS_STATUS_MAX    128
+
+/* A single progress tick for the operation whose payload has the same
+   "op-id" property */
+typedef struct
+{
+  guint    op_id;
+  gboolean is_estimating;
+  double   progress;
+  double   total_progress;
+  guint64  bytes_transferred;
+  guint64  start_time;
+  char     status[BZ_BACKEND_TRANSACTION_PROGRESS_STATUS_MAX];
+} BzBackendTransactionProgress;
+
+#define BZ_TYPE_BACKEND_TRANSACTION_PROGRESS_RING (bz_backend_transaction_progress_ring_get_type ())
+G_DECLARE_FINAL_TYPE (BzBackendTransactionProgressRing, bz_backend_transaction_progress_ring, BZ, BACKEND_TRANSACTION_PROGRESS_RING, GObject)
+
+BzBackendTransactionProgressRing *
+bz_backend_transaction_progress_ring_new (void);
+
+/* Safe to call from any thread. Returns TRUE if the reader has to be woken
+   up, in which case the caller should send the ring itself over the
+   transaction channel. Once full, the oldest tick is overwritten */
+gboolean
+bz_backend_transaction_progress_ring_push (BzBackendTransactionProgressRing   *self,
+                                           const BzBackendTransactionProgress *progress);
+
+/* Copies every unread tick into `out` in order, which must have room for
+   BZ_BACKEND_TRANSACTION_PROGRESS_RING_CAPACITY ticks, and rearms the
+   wakeup */
+guint
+bz_backend_transaction_progress_ring_drain (BzBackendTransactionProgressRing *self,
+                                            BzBackendTransactionProgress     *out,
+                                            guint                             n_out);
+
+G_END_DECLS
+
+/* End of bz-backend-transaction-progress-ring.h */
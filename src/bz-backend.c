@@ -88,6 +88,25 @@ bz_backend_real_cancel_task_for_entry (BzBackend *self,
   return FALSE;
 }
 
+static DexFuture *
+bz_backend_real_stage_updates (BzBackend    *self,
+                               BzEntry     **updates,
+                               guint         n_updates,
+                               guint64       byte_budget,
+                               GCancellable *cancellable)
+{
+  return dex_future_new_reject (G_IO_ERROR, G_IO_ERROR_UNKNOWN, "Unimplemented");
+}
+
+static DexFuture *
+bz_backend_real_plan_installs (BzBackend    *self,
+                               BzEntry     **installs,
+                               guint         n_installs,
+                               GCancellable *cancellable)
+{
+  return dex_future_new_reject (G_IO_ERROR, G_IO_ERROR_UNKNOWN, "Unimplemented");
+}
+
 static void
 bz_backend_default_init (BzBackendInterface *iface)
 {
@@ -99,6 +118,8 @@ bz_backend_default_init (BzBackendInterface *iface)
   iface->list_repositories           = bz_backend_real_list_repositories;
   iface->schedule_transaction        = bz_backend_real_schedule_transaction;
   iface->cancel_task_for_entry       = bz_backend_real_cancel_task_for_entry;
+  iface->stage_updates               = bz_backend_real_stage_updates;
+  iface->plan_installs               = bz_backend_real_plan_installs;
 }
 
 DexChannel *
@@ -271,3 +292,43 @@ bz_backend_cancel_task_for_entry (BzBackend *self,
 
   return BZ_BACKEND_GET_IFACE (self)->cancel_task_for_entry (self, entry);
 }
+
+DexFuture *
+bz_backend_stage_updates (BzBackend    *self,
+                          BzEntry     **updates,
+                          guint         n_updates,
+                          guint64       byte_budget,
+                          GCancellable *cancellable)
+{
+  dex_return_error_if_fail (BZ_IS_BACKEND (self));
+  dex_return_error_if_fail (updates != NULL && n_updates > 0);
+  dex_return_error_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  for (guint i = 0; i < n_updates; i++)
+    dex_return_error_if_fail (BZ_IS_ENTRY (updates[i]));
+
+  return BZ_BACKEND_GET_IFACE (self)->stage_updates (
+      self,
+      updates,
+      n_updates,
+      byte_budget,
+      cancellable);
+}
+
+DexFuture *
+bz_backend_plan_installs (BzBackend    *self,
+                          BzEntry     **installs,
+                          guint         n_installs,
+                          GCancellable *cancellable)
+{
+  dex_return_error_if_fail (BZ_IS_BACKEND (self));
+  dex_return_error_if_fail (installs != NULL && n_installs > 0);
+  dex_return_error_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  for (guint i = 0; i < n_installs; i++)
+    dex_return_error_if_fail (BZ_IS_ENTRY (installs[i]));
+
+  return BZ_BACKEND_GET_IFACE (self)->plan_installs (
+      self,
+      installs,
+      n_installs,
+      cancellable);
+}
@@ -69,6 +69,19 @@ struct _BzBackendInterface
 
   gboolean (*cancel_task_for_entry) (BzBackend *self,
                                      BzEntry   *entry);
+
+  /* DexFuture* -> guint64 (bytes downloaded) */
+  DexFuture *(*stage_updates) (BzBackend    *self,
+                               BzEntry     **updates,
+                               guint         n_updates,
+                               guint64       byte_budget,
+                               GCancellable *cancellable);
+
+  /* DexFuture* -> BzInstallPlan* */
+  DexFuture *(*plan_installs) (BzBackend    *self,
+                               BzEntry     **installs,
+                               guint         n_installs,
+                               GCancellable *cancellable);
 };
 
 DexChannel *
@@ -116,4 +129,17 @@ gboolean
 bz_backend_cancel_task_for_entry (BzBackend *self,
                                   BzEntry   *entry);
 
+DexFuture *
+bz_backend_stage_updates (BzBackend    *self,
+                          BzEntry     **updates,
+                          guint         n_updates,
+                          guint64       byte_budget,
+                          GCancellable *cancellable);
+
+DexFuture *
+bz_backend_plan_installs (BzBackend    *self,
+                          BzEntry     **installs,
+                          guint         n_installs,
+                          GCancellable *cancellable);
+
 G_END_DECLS
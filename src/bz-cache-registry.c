@@ -0,0 +1,215 @@
+/* bz-cache-registry.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::CACHE-REGISTRY"
+
+/* Closing and reopening the window right away shouldn't throw anything
+   away */
+#define BACKGROUND_SHED_DELAY_SECONDS 30
+
+#include <malloc.h>
+
+#include "bz-cache-registry.h"
+
+/* Refcounted so a shed can call them without holding the lock */
+typedef struct
+{
+  gboolean        removed;
+  guint           id;
+  BzCachePriority priority;
+  BzCacheShedFunc func;
+  gpointer        user_data;
+  GDestroyNotify  destroy;
+} Shedder;
+
+/* Recursive since dropping a shedder may drop the last reference to
+   something which removes another */
+static GRecMutex  mutex          = { 0 };
+static GPtrArray *shedders       = NULL;
+static guint      next_id        = 1;
+static gboolean   background     = FALSE;
+static guint      background_src = 0;
+
+static GMemoryMonitor *monitor = NULL;
+
+static void
+shedder_clear (Shedder *shedder)
+{
+  if (shedder->destroy != NULL)
+    shedder->destroy (shedder->user_data);
+}
+
+static void
+shedder_unref (Shedder *shedder)
+{
+  g_atomic_rc_box_release_full (shedder, (GDestroyNotify) shedder_clear);
+}
+
+static void
+low_memory_warning (GMemoryMonitor            *memory_monitor,
+                    GMemoryMonitorWarningLevel level,
+                    gpointer                   user_data)
+{
+  BzCachePriority up_to = BZ_CACHE_PRIORITY_TEXTURES;
+
+  if (g_atomic_int_get (&background) ||
+      level >= G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL)
+    up_to = BZ_CACHE_PRIORITY_COLLECTIONS;
+
+  g_debug ("Received low memory warning at level %d, shedding caches", level);
+  bz_cache_registry_shed (up_to);
+}
+
+static gboolean
+background_timeout_cb (gpointer user_data)
+{
+  background_src = 0;
+
+  g_debug ("In the background for %d seconds, shedding caches",
+           BACKGROUND_SHED_DELAY_SECONDS);
+  bz_cache_registry_shed (BZ_CACHE_PRIORITY_COLLECTIONS);
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+bz_cache_registry_init (void)
+{
+  g_return_if_fail (monitor == NULL);
+
+  monitor = g_memory_monitor_dup_default ();
+  if (monitor != NULL)
+    g_signal_connect (monitor, "low-memory-warning",
+                      G_CALLBACK (low_memory_warning), NULL);
+  else
+    g_warning ("Unable to monitor memory pressure! Caches will only be shed in the background");
+}
+
+guint
+bz_cache_registry_add (BzCachePriority priority,
+                       BzCacheShedFunc func,
+                       gpointer        user_data,
+                       GDestroyNotify  destroy)
+{
+  g_autoptr (GRecMutexLocker) locker = NULL;
+  Shedder *shedder                   = NULL;
+
+  g_return_val_if_fail (func != NULL, 0);
+
+  locker = g_rec_mutex_locker_new (&mutex);
+  if (shedders == NULL)
+    shedders = g_ptr_array_new_with_free_func ((GDestroyNotify) shedder_unref);
+
+  shedder            = g_atomic_rc_box_new0 (Shedder);
+  shedder->id        = next_id++;
+  shedder->priority  = priority;
+  shedder->func      = func;
+  shedder->user_data = user_data;
+  shedder->destroy   = destroy;
+  g_ptr_array_add (shedders, shedder);
+
+  return shedder->id;
+}
+
+void
+bz_cache_registry_remove (guint id)
+{
+  g_autoptr (GRecMutexLocker) locker = NULL;
+
+  g_return_if_fail (id > 0);
+
+  locker = g_rec_mutex_locker_new (&mutex);
+  for (guint i = 0; shedders != NULL && i < shedders->len; i++)
+    {
+      Shedder *shedder = g_ptr_array_index (shedders, i);
+
+      if (shedder->id == id)
+        {
+          g_atomic_int_set (&shedder->removed, TRUE);
+          g_ptr_array_remove_index (shedders, i);
+          return;
+        }
+    }
+
+  g_critical ("No cache shedder with ID %u", id);
+}
+
+void
+bz_cache_registry_shed (BzCachePriority up_to)
+{
+  g_autoptr (GRecMutexLocker) locker = NULL;
+  g_autoptr (GPtrArray) to_shed      = NULL;
+
+  /* Take references under the lock and shed outside of it so that a slow
+     shedder doesn't hold up others registering */
+  locker  = g_rec_mutex_locker_new (&mutex);
+  to_shed = g_ptr_array_new_with_free_func ((GDestroyNotify) shedder_unref);
+  for (BzCachePriority priority = BZ_CACHE_PRIORITY_TEXTURES;
+       shedders != NULL && priority <= up_to;
+       priority++)
+    {
+      for (guint i = 0; i < shedders->len; i++)
+        {
+          Shedder *shedder = g_ptr_array_index (shedders, i);
+
+          if (shedder->priority == priority)
+            g_ptr_array_add (to_shed, g_atomic_rc_box_acquire (shedder));
+        }
+    }
+  g_clear_pointer (&locker, g_rec_mutex_locker_free);
+
+  /* Shedders may remove themselves or others */
+  for (guint i = 0; i < to_shed->len; i++)
+    {
+      Shedder *shedder = g_ptr_array_index (to_shed, i);
+
+      if (!g_atomic_int_get (&shedder->removed))
+        shedder->func (shedder->user_data);
+    }
+
+#ifdef __GLIBC__
+  malloc_trim (0);
+#endif
+}
+
+void
+bz_cache_registry_set_background (gboolean is_background)
+{
+  is_background = !!is_background;
+  if (is_background == g_atomic_int_get (&background))
+    return;
+
+  g_atomic_int_set (&background, is_background);
+  g_clear_handle_id (&background_src, g_source_remove);
+
+  if (is_background)
+    background_src = g_timeout_add_seconds (
+        BACKGROUND_SHED_DELAY_SECONDS,
+        background_timeout_cb,
+        NULL);
+}
+
+gboolean
+bz_cache_registry_get_background (void)
+{
+  return g_atomic_int_get (&background);
+}
+
+/* End of bz-cache-registry.c */
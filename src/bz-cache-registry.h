@@ -0,0 +1,69 @@
+/* bz-cache-registry.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* Caches are shed cheapest-to-rebuild first. Shedding at a priority also
+   sheds everything before it */
+typedef enum
+{
+  BZ_CACHE_PRIORITY_TEXTURES,
+  BZ_CACHE_PRIORITY_COLLECTIONS,
+} BzCachePriority;
+
+/* Called on the main thread. Whatever is dropped must be reloaded on
+   demand by its owner without any help from the caller */
+typedef void (*BzCacheShedFunc) (gpointer user_data);
+
+/* Starts listening for low memory warnings, call once from the main
+   thread */
+void
+bz_cache_registry_init (void);
+
+/* Safe to call from any thread. Returns an ID for
+   bz_cache_registry_remove () */
+guint
+bz_cache_registry_add (BzCachePriority priority,
+                       BzCacheShedFunc func,
+                       gpointer        user_data,
+                       GDestroyNotify  destroy);
+
+void
+bz_cache_registry_remove (guint id);
+
+void
+bz_cache_registry_shed (BzCachePriority up_to);
+
+/* While in the background, for instance with no window shown, everything
+   is shed after a grace period and on any memory warning */
+void
+bz_cache_registry_set_background (gboolean background);
+
+/* Safe to call from any thread */
+gboolean
+bz_cache_registry_get_background (void);
+
+G_END_DECLS
+
+/* End of bz-cache-registry.h */
@@ -0,0 +1,363 @@
+/* bz-catalog-index.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::CATALOG-INDEX"
+
+#include "bz-catalog-index.h"
+#include "bz-vocabulary.h"
+
+struct _BzCatalogIndex
+{
+  GObject parent_instance;
+
+  GtkFilter *filter;
+
+  /* Position -> group, with the reverse in `positions` (stored plus one) */
+  GPtrArray  *groups;
+  GHashTable *positions;
+
+  /* Vocabulary ID -> GtkBitset of group positions */
+  GHashTable *categories;
+  GHashTable *keywords;
+
+  /* Positions of the groups `filter` lets through, or NULL if either has
+     changed since it was last needed */
+  GtkBitset *visible;
+
+  /* Category vocabulary ID -> LiveCategory, for the models handed out so
+     far, which are kept up to date as groups arrive */
+  GHashTable *live_categories;
+};
+
+typedef struct
+{
+  GListStore *store;
+  /* Positions of the groups currently in `store` */
+  GtkBitset *shown;
+} LiveCategory;
+
+G_DEFINE_FINAL_TYPE (BzCatalogIndex, bz_catalog_index, G_TYPE_OBJECT);
+
+static void
+live_category_free (LiveCategory *live)
+{
+  g_clear_object (&live->store);
+  g_clear_pointer (&live->shown, gtk_bitset_unref);
+  g_free (live);
+}
+
+static void
+filter_changed (BzCatalogIndex  *self,
+                GtkFilterChange  change,
+                GtkFilter       *filter);
+
+static void
+bz_catalog_index_dispose (GObject *object)
+{
+  BzCatalogIndex *self = BZ_CATALOG_INDEX (object);
+
+  if (self->filter != NULL)
+    g_signal_handlers_disconnect_by_func (self->filter, filter_changed, self);
+  g_clear_object (&self->filter);
+  g_clear_pointer (&self->groups, g_ptr_array_unref);
+  g_clear_pointer (&self->positions, g_hash_table_unref);
+  g_clear_pointer (&self->categories, g_hash_table_unref);
+  g_clear_pointer (&self->keywords, g_hash_table_unref);
+  g_clear_pointer (&self->visible, gtk_bitset_unref);
+  g_clear_pointer (&self->live_categories, g_hash_table_unref);
+
+  G_OBJECT_CLASS (bz_catalog_index_parent_class)->dispose (object);
+}
+
+static void
+bz_catalog_index_class_init (BzCatalogIndexClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = bz_catalog_index_dispose;
+}
+
+static void
+bz_catalog_index_init (BzCatalogIndex *self)
+{
+  self->groups     = g_ptr_array_new_with_free_func (g_object_unref);
+  self->positions  = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->categories = g_hash_table_new_full (
+      g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) gtk_bitset_unref);
+  self->keywords = g_hash_table_new_full (
+      g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) gtk_bitset_unref);
+  self->live_categories = g_hash_table_new_full (
+      g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) live_category_free);
+}
+
+BzCatalogIndex *
+bz_catalog_index_new (GtkFilter *filter)
+{
+  BzCatalogIndex *self = NULL;
+
+  g_return_val_if_fail (filter == NULL || GTK_IS_FILTER (filter), NULL);
+
+  self = g_object_new (BZ_TYPE_CATALOG_INDEX, NULL);
+  if (filter != NULL)
+    {
+      self->filter = g_object_ref (filter);
+      g_signal_connect_swapped (filter, "changed", G_CALLBACK (filter_changed), self);
+    }
+
+  return self;
+}
+
+static void
+add_ids (GHashTable  *index,
+         const guint *ids,
+         guint        position)
+{
+  if (ids == NULL)
+    return;
+
+  for (const guint *id = ids; *id != 0; id++)
+    {
+      GtkBitset *bitset = NULL;
+
+      bitset = g_hash_table_lookup (index, GUINT_TO_POINTER (*id));
+      if (bitset == NULL)
+        {
+          bitset = gtk_bitset_new_empty ();
+          g_hash_table_replace (index, GUINT_TO_POINTER (*id), bitset);
+        }
+      gtk_bitset_add (bitset, position);
+    }
+}
+
+/* Puts the group at `position` into or out of `live`, keeping the store
+   in catalog order */
+static void
+update_live_category (LiveCategory *live,
+                      guint         position,
+                      gboolean      show,
+                      BzEntryGroup *group)
+{
+  guint index = 0;
+
+  if (show == gtk_bitset_contains (live->shown, position))
+    return;
+
+  if (position > 0)
+    index = gtk_bitset_get_size_in_range (live->shown, 0, position - 1);
+
+  if (show)
+    {
+      gtk_bitset_add (live->shown, position);
+      g_list_store_insert (live->store, index, group);
+    }
+  else
+    {
+      gtk_bitset_remove (live->shown, position);
+      g_list_store_remove (live->store, index);
+    }
+}
+
+void
+bz_catalog_index_add_entry (BzCatalogIndex *self,
+                            BzEntryGroup   *group,
+                            BzEntry        *entry)
+{
+  guint position = 0;
+
+  g_return_if_fail (BZ_IS_CATALOG_INDEX (self));
+  g_return_if_fail (BZ_IS_ENTRY_GROUP (group));
+  g_return_if_fail (BZ_IS_ENTRY (entry));
+
+  position = GPOINTER_TO_UINT (g_hash_table_lookup (self->positions, group));
+  if (position == 0)
+    {
+      g_ptr_array_add (self->groups, g_object_ref (group));
+      position = self->groups->len;
+      g_hash_table_replace (self->positions, group, GUINT_TO_POINTER (position));
+    }
+  position--;
+
+  /* A group is listed under everything any of its entries carry */
+  add_ids (self->categories, bz_entry_get_category_ids (entry), position);
+  add_ids (self->keywords, bz_entry_get_keyword_ids (entry), position);
+
+  /* Adding an entry can also change whether its group is shown */
+  g_clear_pointer (&self->visible, gtk_bitset_unref);
+
+  if (g_hash_table_size (self->live_categories) > 0)
+    {
+      GHashTableIter iter    = { 0 };
+      gpointer       id      = NULL;
+      LiveCategory  *live    = NULL;
+      int            visible = -1;
+
+      g_hash_table_iter_init (&iter, self->live_categories);
+      while (g_hash_table_iter_next (&iter, &id, (gpointer *) &live))
+        {
+          GtkBitset *bitset = NULL;
+
+          bitset = g_hash_table_lookup (self->categories, id);
+          if (bitset == NULL || !gtk_bitset_contains (bitset, position))
+            continue;
+
+          if (visible < 0)
+            visible = self->filter == NULL || gtk_filter_match (self->filter, group);
+          update_live_category (live, position, visible, group);
+        }
+    }
+}
+
+static GtkBitset *
+ensure_visible (BzCatalogIndex *self)
+{
+  if (self->visible != NULL)
+    return self->visible;
+
+  if (self->filter == NULL)
+    self->visible = gtk_bitset_new_range (0, self->groups->len);
+  else
+    {
+      self->visible = gtk_bitset_new_empty ();
+      for (guint i = 0; i < self->groups->len; i++)
+        {
+          if (gtk_filter_match (self->filter, g_ptr_array_index (self->groups, i)))
+            gtk_bitset_add (self->visible, i);
+        }
+    }
+
+  return self->visible;
+}
+
+static GListModel *
+dup_matching (BzCatalogIndex *self,
+              GHashTable     *index,
+              guint           id)
+{
+  g_autoptr (GListStore) store  = NULL;
+  GtkBitset *bitset             = NULL;
+  g_autoptr (GtkBitset) matches = NULL;
+  GtkBitsetIter iter            = { 0 };
+  guint         position        = 0;
+
+  store = g_list_store_new (BZ_TYPE_ENTRY_GROUP);
+
+  bitset = id != 0 ? g_hash_table_lookup (index, GUINT_TO_POINTER (id)) : NULL;
+  if (bitset == NULL)
+    return G_LIST_MODEL (g_steal_pointer (&store));
+
+  matches = gtk_bitset_copy (bitset);
+  gtk_bitset_intersect (matches, ensure_visible (self));
+
+  for (gboolean valid = gtk_bitset_iter_init_first (&iter, matches, &position);
+       valid;
+       valid = gtk_bitset_iter_next (&iter, &position))
+    g_list_store_append (store, g_ptr_array_index (self->groups, position));
+
+  return G_LIST_MODEL (g_steal_pointer (&store));
+}
+
+static void
+refill_live_category (BzCatalogIndex *self,
+                      guint           id,
+                      LiveCategory   *live)
+{
+  g_autoptr (GListModel) matching = NULL;
+  g_autoptr (GPtrArray) groups    = NULL;
+  guint n_items                   = 0;
+
+  matching = dup_matching (self, self->categories, id);
+  n_items  = g_list_model_get_n_items (matching);
+  groups   = g_ptr_array_new_full (n_items, g_object_unref);
+  for (guint i = 0; i < n_items; i++)
+    g_ptr_array_add (groups, g_list_model_get_item (matching, i));
+
+  g_clear_pointer (&live->shown, gtk_bitset_unref);
+  live->shown = gtk_bitset_new_empty ();
+  for (guint i = 0; i < groups->len; i++)
+    gtk_bitset_add (
+        live->shown,
+        GPOINTER_TO_UINT (g_hash_table_lookup (self->positions, g_ptr_array_index (groups, i))) - 1);
+
+  g_list_store_splice (
+      live->store, 0,
+      g_list_model_get_n_items (G_LIST_MODEL (live->store)),
+      groups->pdata, groups->len);
+}
+
+/* The model stays live, gaining groups as they are added to the catalog,
+   and is in catalog order like the full list of groups */
+GListModel *
+bz_catalog_index_dup_category (BzCatalogIndex *self,
+                               const char     *category)
+{
+  guint         id   = 0;
+  LiveCategory *live = NULL;
+
+  g_return_val_if_fail (BZ_IS_CATALOG_INDEX (self), NULL);
+  g_return_val_if_fail (category != NULL, NULL);
+
+  /* Interned so groups which arrive later under a new category still show
+     up */
+  id = bz_vocabulary_intern (bz_vocabulary_get_categories (), category);
+
+  live = g_hash_table_lookup (self->live_categories, GUINT_TO_POINTER (id));
+  if (live == NULL)
+    {
+      live        = g_new0 (LiveCategory, 1);
+      live->store = g_list_store_new (BZ_TYPE_ENTRY_GROUP);
+      refill_live_category (self, id, live);
+      g_hash_table_replace (self->live_categories, GUINT_TO_POINTER (id), live);
+    }
+
+  return g_object_ref (G_LIST_MODEL (live->store));
+}
+
+GListModel *
+bz_catalog_index_dup_keyword (BzCatalogIndex *self,
+                              const char     *keyword)
+{
+  g_return_val_if_fail (BZ_IS_CATALOG_INDEX (self), NULL);
+  g_return_val_if_fail (keyword != NULL, NULL);
+
+  return dup_matching (
+      self, self->keywords,
+      bz_vocabulary_lookup (bz_vocabulary_get_keywords (), keyword));
+}
+
+static void
+filter_changed (BzCatalogIndex  *self,
+                GtkFilterChange  change,
+                GtkFilter       *filter)
+{
+  GHashTableIter iter = { 0 };
+  gpointer       id   = NULL;
+  LiveCategory  *live = NULL;
+
+  g_clear_pointer (&self->visible, gtk_bitset_unref);
+
+  g_hash_table_iter_init (&iter, self->live_categories);
+  while (g_hash_table_iter_next (&iter, &id, (gpointer *) &live))
+    refill_live_category (self, GPOINTER_TO_UINT (id), live);
+}
+
+/* End of bz-catalog-index.c */
@@ -0,0 +1,53 @@
+/* bz-catalog-index.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+#include "bz-entry-group.h"
+#include "bz-entry.h"
+
+G_BEGIN_DECLS
+
+#define BZ_TYPE_CATALOG_INDEX (bz_catalog_index_get_type ())
+G_DECLARE_FINAL_TYPE (BzCatalogIndex, bz_catalog_index, BZ, CATALOG_INDEX, GObject)
+
+/* Maps every category and keyword of the local catalog to the set of
+   groups carrying it. `filter` decides which groups are shown at all */
+BzCatalogIndex *
+bz_catalog_index_new (GtkFilter *filter);
+
+void
+bz_catalog_index_add_entry (BzCatalogIndex *self,
+                            BzEntryGroup   *group,
+                            BzEntry        *entry);
+
+GListModel *
+bz_catalog_index_dup_category (BzCatalogIndex *self,
+                               const char     *category);
+
+GListModel *
+bz_catalog_index_dup_keyword (BzCatalogIndex *self,
+                              const char     *keyword);
+
+G_END_DECLS
+
+/* End of bz-catalog-index.h */
@@ -0,0 +1,353 @@
+/* bz-collated-store.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::COLLATED-STORE"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bz-collated-store.h"
+
+typedef struct
+{
+  GObject *item;
+  /* NULL sorts last */
+  char *key;
+  /* Breaks ties so equal keys stay in insertion order */
+  guint64 serial;
+} Slot;
+
+struct _BzCollatedStore
+{
+  GObject parent_instance;
+
+  GType                   item_type;
+  BzCollatedStoreTextFunc text_func;
+
+  GPtrArray  *slots;
+  GHashTable *index;
+  guint64     next_serial;
+
+  guint       freeze_count;
+  GPtrArray  *pending_adds;
+  /* Owns the slots, which are still in `slots` until thawed */
+  GHashTable *pending_removes;
+};
+
+static void list_model_iface_init (GListModelInterface *iface);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE (
+    BzCollatedStore,
+    bz_collated_store,
+    G_TYPE_OBJECT,
+    G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, list_model_iface_init))
+
+static void
+slot_free (Slot *slot)
+{
+  g_clear_object (&slot->item);
+  g_clear_pointer (&slot->key, g_free);
+  g_free (slot);
+}
+
+static int
+cmp_slot (const Slot *a,
+          const Slot *b)
+{
+  int result = 0;
+
+  if (a->key == NULL && b->key != NULL)
+    return 1;
+  if (a->key != NULL && b->key == NULL)
+    return -1;
+
+  if (a->key != NULL)
+    result = strcmp (a->key, b->key);
+  if (result != 0)
+    return result;
+
+  return a->serial < b->serial ? -1 : (a->serial > b->serial ? 1 : 0);
+}
+
+static int
+cmp_slot_ptrs (gconstpointer a,
+               gconstpointer b)
+{
+  return cmp_slot (*(const Slot **) a, *(const Slot **) b);
+}
+
+/* Index of the first slot which sorts after `slot` */
+static guint
+bisect (BzCollatedStore *self,
+        const Slot      *slot)
+{
+  guint lo = 0;
+  guint hi = self->slots->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (cmp_slot (g_ptr_array_index (self->slots, mid), slot) <= 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static Slot *
+slot_new (BzCollatedStore *self,
+          gpointer         item)
+{
+  Slot       *slot = NULL;
+  const char *text = NULL;
+
+  slot         = g_new0 (Slot, 1);
+  slot->item   = g_object_ref (item);
+  slot->serial = self->next_serial++;
+
+  text = self->text_func (item);
+  if (text != NULL)
+    {
+      g_autofree char *folded = NULL;
+
+      folded    = g_utf8_casefold (text, -1);
+      slot->key = g_utf8_collate_key (folded, -1);
+    }
+
+  return slot;
+}
+
+static void
+bz_collated_store_dispose (GObject *object)
+{
+  BzCollatedStore *self = BZ_COLLATED_STORE (object);
+
+  g_clear_pointer (&self->index, g_hash_table_unref);
+  if (self->pending_removes != NULL)
+    g_hash_table_steal_all (self->pending_removes);
+  g_clear_pointer (&self->pending_removes, g_hash_table_unref);
+  g_clear_pointer (&self->pending_adds, g_ptr_array_unref);
+  g_clear_pointer (&self->slots, g_ptr_array_unref);
+
+  G_OBJECT_CLASS (bz_collated_store_parent_class)->dispose (object);
+}
+
+static void
+bz_collated_store_class_init (BzCollatedStoreClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = bz_collated_store_dispose;
+}
+
+static void
+bz_collated_store_init (BzCollatedStore *self)
+{
+  self->slots           = g_ptr_array_new_with_free_func ((GDestroyNotify) slot_free);
+  self->index           = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->pending_adds    = g_ptr_array_new_with_free_func ((GDestroyNotify) slot_free);
+  self->pending_removes = g_hash_table_new_full (g_direct_hash, g_direct_equal, (GDestroyNotify) slot_free, NULL);
+}
+
+static GType
+list_model_get_item_type (GListModel *list)
+{
+  BzCollatedStore *self = BZ_COLLATED_STORE (list);
+  return self->item_type;
+}
+
+static guint
+list_model_get_n_items (GListModel *list)
+{
+  BzCollatedStore *self = BZ_COLLATED_STORE (list);
+  return self->slots->len;
+}
+
+static gpointer
+list_model_get_item (GListModel *list,
+                     guint       position)
+{
+  BzCollatedStore *self = BZ_COLLATED_STORE (list);
+  Slot            *slot = NULL;
+
+  if (position >= self->slots->len)
+    return NULL;
+
+  slot = g_ptr_array_index (self->slots, position);
+  return g_object_ref (slot->item);
+}
+
+static void
+list_model_iface_init (GListModelInterface *iface)
+{
+  iface->get_item_type = list_model_get_item_type;
+  iface->get_n_items   = list_model_get_n_items;
+  iface->get_item      = list_model_get_item;
+}
+
+BzCollatedStore *
+bz_collated_store_new (GType                   item_type,
+                       BzCollatedStoreTextFunc text_func)
+{
+  BzCollatedStore *self = NULL;
+
+  g_return_val_if_fail (g_type_is_a (item_type, G_TYPE_OBJECT), NULL);
+  g_return_val_if_fail (text_func != NULL, NULL);
+
+  self            = g_object_new (BZ_TYPE_COLLATED_STORE, NULL);
+  self->item_type = item_type;
+  self->text_func = text_func;
+
+  return self;
+}
+
+gboolean
+bz_collated_store_contains (BzCollatedStore *self,
+                            gpointer         item)
+{
+  g_return_val_if_fail (BZ_IS_COLLATED_STORE (self), FALSE);
+  g_return_val_if_fail (G_IS_OBJECT (item), FALSE);
+
+  return g_hash_table_contains (self->index, item);
+}
+
+void
+bz_collated_store_add (BzCollatedStore *self,
+                       gpointer         item)
+{
+  Slot *slot     = NULL;
+  guint position = 0;
+
+  g_return_if_fail (BZ_IS_COLLATED_STORE (self));
+  g_return_if_fail (G_TYPE_CHECK_INSTANCE_TYPE (item, self->item_type));
+
+  if (g_hash_table_contains (self->index, item))
+    return;
+
+  slot = slot_new (self, item);
+  g_hash_table_replace (self->index, item, slot);
+
+  if (self->freeze_count > 0)
+    {
+      g_ptr_array_add (self->pending_adds, slot);
+      return;
+    }
+
+  position = bisect (self, slot);
+  g_ptr_array_insert (self->slots, position, slot);
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 0, 1);
+}
+
+void
+bz_collated_store_remove (BzCollatedStore *self,
+                          gpointer         item)
+{
+  Slot *slot     = NULL;
+  guint position = 0;
+
+  g_return_if_fail (BZ_IS_COLLATED_STORE (self));
+  g_return_if_fail (G_IS_OBJECT (item));
+
+  slot = g_hash_table_lookup (self->index, item);
+  if (slot == NULL)
+    return;
+  g_hash_table_remove (self->index, item);
+
+  if (self->freeze_count > 0)
+    {
+      /* Never made it into the list, so it can just be dropped */
+      if (!g_ptr_array_remove_fast (self->pending_adds, slot))
+        g_hash_table_add (self->pending_removes, slot);
+      return;
+    }
+
+  /* The slot sorts right before its bisection point */
+  position = bisect (self, slot) - 1;
+  g_assert (g_ptr_array_index (self->slots, position) == slot);
+
+  g_ptr_array_remove_index (self->slots, position);
+  g_list_model_items_changed (G_LIST_MODEL (self), position, 1, 0);
+}
+
+void
+bz_collated_store_freeze (BzCollatedStore *self)
+{
+  g_return_if_fail (BZ_IS_COLLATED_STORE (self));
+  self->freeze_count++;
+}
+
+void
+bz_collated_store_thaw (BzCollatedStore *self)
+{
+  g_autofree Slot **old    = NULL;
+  g_autofree Slot **adds   = NULL;
+  gsize             n_old  = 0;
+  gsize             n_adds = 0;
+  guint             i      = 0;
+  guint             j      = 0;
+  guint             n_new  = 0;
+  guint             prefix = 0;
+  guint             suffix = 0;
+
+  g_return_if_fail (BZ_IS_COLLATED_STORE (self));
+  g_return_if_fail (self->freeze_count > 0);
+
+  if (--self->freeze_count > 0)
+    return;
+  if (self->pending_adds->len == 0 &&
+      g_hash_table_size (self->pending_removes) == 0)
+    return;
+
+  old  = (Slot **) g_ptr_array_steal (self->slots, &n_old);
+  adds = (Slot **) g_ptr_array_steal (self->pending_adds, &n_adds);
+  qsort (adds, n_adds, sizeof (*adds), cmp_slot_ptrs);
+
+  /* Merge the sorted batch in, dropping removals along the way */
+  while (i < n_old || j < n_adds)
+    {
+      if (i < n_old && g_hash_table_contains (self->pending_removes, old[i]))
+        i++;
+      else if (j >= n_adds || (i < n_old && cmp_slot (old[i], adds[j]) <= 0))
+        g_ptr_array_add (self->slots, old[i++]);
+      else
+        g_ptr_array_add (self->slots, adds[j++]);
+    }
+  n_new = self->slots->len;
+
+  /* Only announce the span which actually differs */
+  while (prefix < n_old && prefix < n_new &&
+         old[prefix] == g_ptr_array_index (self->slots, prefix))
+    prefix++;
+  while (suffix < n_old - prefix && suffix < n_new - prefix &&
+         old[n_old - 1 - suffix] == g_ptr_array_index (self->slots, n_new - 1 - suffix))
+    suffix++;
+
+  g_hash_table_remove_all (self->pending_removes);
+
+  g_list_model_items_changed (
+      G_LIST_MODEL (self), prefix,
+      n_old - prefix - suffix,
+      n_new - prefix - suffix);
+}
+
+/* End of bz-collated-store.c */
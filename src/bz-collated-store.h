@@ -0,0 +1,62 @@
+/* bz-collated-store.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* Returns the text an item is sorted by, which is assumed not to change
+   while the item is in the store */
+typedef const char *(*BzCollatedStoreTextFunc) (gpointer item);
+
+#define BZ_TYPE_COLLATED_STORE (bz_collated_store_get_type ())
+G_DECLARE_FINAL_TYPE (BzCollatedStore, bz_collated_store, BZ, COLLATED_STORE, GObject)
+
+BzCollatedStore *
+bz_collated_store_new (GType                   item_type,
+                       BzCollatedStoreTextFunc text_func);
+
+gboolean
+bz_collated_store_contains (BzCollatedStore *self,
+                            gpointer         item);
+
+/* Does nothing if `item` is already present. Items which collate equally
+   keep the order they were added in */
+void
+bz_collated_store_add (BzCollatedStore *self,
+                       gpointer         item);
+
+void
+bz_collated_store_remove (BzCollatedStore *self,
+                          gpointer         item);
+
+/* While frozen, additions and removals are queued and then applied by the
+   final bz_collated_store_thaw () with a single items-changed */
+void
+bz_collated_store_freeze (BzCollatedStore *self);
+
+void
+bz_collated_store_thaw (BzCollatedStore *self);
+
+G_END_DECLS
+
+/* End of bz-collated-store.h */
@@ -90,6 +90,23 @@ bz_decorated_screenshot_set_property (GObject      *object,
     }
 }
 
+static void
+bz_decorated_screenshot_size_allocate (GtkWidget *widget,
+                                       int        width,
+                                       int        height,
+                                       int        baseline)
+{
+  BzDecoratedScreenshot *self = BZ_DECORATED_SCREENSHOT (widget);
+
+  GTK_WIDGET_CLASS (bz_decorated_screenshot_parent_class)->size_allocate (widget, width, height, baseline);
+
+  if (self->async_texture != NULL)
+    bz_async_texture_request_size (
+        self->async_texture,
+        width, height,
+        gtk_widget_get_scale_factor (widget));
+}
+
 static void
 bz_decorated_screenshot_class_init (BzDecoratedScreenshotClass *klass)
 {
@@ -100,6 +117,8 @@ bz_decorated_screenshot_class_init (BzDecoratedScreenshotClass *klass)
   object_class->get_property = bz_decorated_screenshot_get_property;
   object_class->dispose      = bz_decorated_screenshot_dispose;
 
+  widget_class->size_allocate = bz_decorated_screenshot_size_allocate;
+
   props[PROP_ASYNC_TEXTURE] =
       g_param_spec_object (
           "async-texture",
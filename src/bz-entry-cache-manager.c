@@ -24,8 +24,12 @@
 #define MAX_CONCURRENT_WRITES       16
 #define WATCH_CLEANUP_INTERVAL_MSEC 5000
 
+/* Nothing is being browsed without a window, so there is little to prune */
+#define WATCH_CLEANUP_BACKGROUND_INTERVAL_MSEC 60000
+
 #include <malloc.h>
 
+#include "bz-cache-registry.h"
 #include "bz-entry-cache-manager.h"
 #include "bz-env.h"
 #include "bz-flatpak-entry.h"
@@ -845,8 +849,12 @@ watch_work_fiber (OngoingTaskData *task_data)
   guint active                         = 0;
   guint alive                          = 0;
   guint pruned                         = 0;
+  guint interval                       = 0;
 
-  timer = g_timer_new ();
+  timer    = g_timer_new ();
+  interval = bz_cache_registry_get_background ()
+                 ? WATCH_CLEANUP_BACKGROUND_INTERVAL_MSEC
+                 : WATCH_CLEANUP_INTERVAL_MSEC;
 
   BZ_BEGIN_GUARD_WITH_CONTEXT (&guard0, &task_data->alive_mutex, &task_data->alive_gate);
   BZ_BEGIN_GUARD_WITH_CONTEXT (&guard0, &task_data->reading_mutex, &task_data->reading_gate);
@@ -896,7 +904,7 @@ watch_work_fiber (OngoingTaskData *task_data)
            "    %d entries were forgotten by the application and were pruned\n"
            "  Another sweep will take place in %d msec",
            g_timer_elapsed (timer, NULL),
-           total, active, alive, pruned, WATCH_CLEANUP_INTERVAL_MSEC);
+           total, active, alive, pruned, interval);
 
   bz_weak_get_or_return_reject (self, task_data->self);
   g_mutex_lock (&self->mutex);
@@ -910,7 +918,7 @@ watch_work_fiber (OngoingTaskData *task_data)
       bz_track_weak (self),
       bz_weak_release));
 
-  return dex_timeout_new_msec (WATCH_CLEANUP_INTERVAL_MSEC);
+  return dex_timeout_new_msec (interval);
 }
 
 static DexFuture *
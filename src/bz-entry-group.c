@@ -27,6 +27,7 @@
 #include "bz-flatpak-entry.h"
 #include "bz-io.h"
 #include "bz-util.h"
+#include "bz-vocabulary.h"
 
 struct _BzEntryGroup
 {
@@ -53,6 +54,8 @@ struct _BzEntryGroup
   guint64        installed_size;
   int            n_addons;
   char          *donation_url;
+  guint         *category_ids;
+  /* Built alongside category_ids, so readers never need the lock */
   GListModel    *categories;
 
   int max_usefulness;
@@ -66,7 +69,8 @@ struct _BzEntryGroup
   gboolean read_only;
   gboolean searchable;
 
-  guint64 user_data_size;
+  guint64  user_data_size;
+  gboolean user_data_size_known;
 
   DexFuture *user_data_size_future;
   DexFuture *reap_user_data_future;
@@ -157,6 +161,7 @@ bz_entry_group_dispose (GObject *object)
   g_clear_pointer (&self->remote_repos_string, g_free);
   g_clear_pointer (&self->eol, g_free);
   g_clear_pointer (&self->donation_url, g_free);
+  g_clear_pointer (&self->category_ids, g_free);
   g_clear_object (&self->categories);
 
   g_weak_ref_clear (&self->ui_entry);
@@ -543,7 +548,7 @@ bz_entry_group_new_for_single_entry (BzEntry *entry)
   const char   *eol                = NULL;
   guint64       installed_size     = 0;
   const char   *donation_url       = NULL;
-  GListModel   *entry_categories   = NULL;
+  const guint  *entry_categories   = NULL;
   DexFuture    *future             = NULL;
 
   g_return_val_if_fail (BZ_IS_ENTRY (entry), NULL);
@@ -566,7 +571,7 @@ bz_entry_group_new_for_single_entry (BzEntry *entry)
   eol                = bz_entry_get_eol (entry);
   installed_size     = bz_entry_get_installed_size (entry);
   donation_url       = bz_entry_get_donation_url (entry);
-  entry_categories   = bz_entry_get_categories (entry);
+  entry_categories   = bz_entry_get_category_ids (entry);
 
   if (id != NULL)
     group->id = g_strdup (id);
@@ -595,7 +600,10 @@ bz_entry_group_new_for_single_entry (BzEntry *entry)
   if (donation_url != NULL)
     group->donation_url = g_strdup (donation_url);
   if (entry_categories != NULL)
-    group->categories = g_object_ref (entry_categories);
+    {
+      group->category_ids = bz_vocabulary_ids_dup (entry_categories);
+      group->categories   = bz_vocabulary_dup_model (bz_vocabulary_get_categories (), group->category_ids);
+    }
 
   if (unique_id != NULL)
     gtk_string_list_append (group->unique_ids, unique_id);
@@ -747,6 +755,14 @@ bz_entry_group_get_categories (BzEntryGroup *self)
   return self->categories;
 }
 
+gboolean
+bz_entry_group_has_category (BzEntryGroup *self,
+                             guint         category_id)
+{
+  g_return_val_if_fail (BZ_IS_ENTRY_GROUP (self), FALSE);
+  return bz_vocabulary_ids_contain (self->category_ids, category_id);
+}
+
 guint64
 bz_entry_group_get_user_data_size (BzEntryGroup *self)
 {
@@ -755,6 +771,26 @@ bz_entry_group_get_user_data_size (BzEntryGroup *self)
   return self->user_data_size;
 }
 
+void
+bz_entry_group_set_user_data_size (BzEntryGroup *self,
+                                   guint64       size)
+{
+  guint64 old_size = 0;
+
+  g_return_if_fail (BZ_IS_ENTRY_GROUP (self));
+
+  if (self->reap_user_data_future != NULL)
+    return;
+  dex_clear (&self->user_data_size_future);
+
+  old_size                   = self->user_data_size;
+  self->user_data_size       = size;
+  self->user_data_size_known = TRUE;
+
+  if (old_size != size)
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_USER_DATA_SIZE]);
+}
+
 BzResult *
 bz_entry_group_dup_ui_entry (BzEntryGroup *self)
 {
@@ -881,7 +917,7 @@ bz_entry_group_add (BzEntryGroup *self,
   GListModel   *addons             = NULL;
   int           n_addons           = 0;
   const char   *donation_url       = NULL;
-  GListModel   *entry_categories   = NULL;
+  const guint  *entry_categories   = NULL;
   guint         existing           = 0;
   gboolean      is_searchable      = FALSE;
 
@@ -928,7 +964,7 @@ bz_entry_group_add (BzEntryGroup *self,
   is_verified        = bz_entry_is_verified (entry);
   installed_size     = bz_entry_get_installed_size (entry);
   donation_url       = bz_entry_get_donation_url (entry);
-  entry_categories   = bz_entry_get_categories (entry);
+  entry_categories   = bz_entry_get_category_ids (entry);
 
   addons        = bz_entry_get_addons (entry);
   is_searchable = bz_entry_is_searchable (entry);
@@ -1028,10 +1064,12 @@ bz_entry_group_add (BzEntryGroup *self,
           g_object_notify_by_pspec (G_OBJECT (self), props[PROP_DONATION_URL]);
         }
 
-      if (entry_categories != NULL && g_list_model_get_n_items (entry_categories) > 0)
+      if (entry_categories != NULL)
         {
+          g_clear_pointer (&self->category_ids, g_free);
           g_clear_object (&self->categories);
-          self->categories = g_object_ref (entry_categories);
+          self->category_ids = bz_vocabulary_ids_dup (entry_categories);
+          self->categories   = bz_vocabulary_dup_model (bz_vocabulary_get_categories (), self->category_ids);
           g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CATEGORIES]);
         }
 
@@ -1266,7 +1304,8 @@ installed_changed (BzEntryGroup *self,
     }
 
   dex_clear (&self->user_data_size_future);
-  self->user_data_size = 0;
+  self->user_data_size       = 0;
+  self->user_data_size_known = FALSE;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_USER_DATA_SIZE]);
 }
 
@@ -1366,8 +1405,9 @@ reap_user_data_then (DexFuture *future,
   bz_weak_get_or_return_reject (self, wr);
   dex_clear (&self->reap_user_data_future);
 
-  old_size             = self->user_data_size;
-  self->user_data_size = 0;
+  old_size                   = self->user_data_size;
+  self->user_data_size       = 0;
+  self->user_data_size_known = TRUE;
 
   if (old_size != 0)
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_USER_DATA_SIZE]);
@@ -1407,8 +1447,9 @@ user_data_size_then (DexFuture *future,
   if (error != NULL)
     size = 0;
 
-  old_size             = self->user_data_size;
-  self->user_data_size = size;
+  old_size                   = self->user_data_size;
+  self->user_data_size       = size;
+  self->user_data_size_known = TRUE;
 
   if (old_size != size)
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_USER_DATA_SIZE]);
@@ -1421,7 +1462,8 @@ check_user_data_size (BzEntryGroup *self)
 {
   g_autoptr (DexFuture) future = NULL;
 
-  if (self->user_data_size_future != NULL ||
+  if (self->user_data_size_known ||
+      self->user_data_size_future != NULL ||
       self->id == NULL)
     return;
 
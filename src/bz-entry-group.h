@@ -97,6 +97,10 @@ bz_entry_group_get_donation_url (BzEntryGroup *self);
 GListModel *
 bz_entry_group_get_categories (BzEntryGroup *self);
 
+gboolean
+bz_entry_group_has_category (BzEntryGroup *self,
+                             guint         category_id);
+
 BzResult *
 bz_entry_group_dup_ui_entry (BzEntryGroup *self);
 
@@ -127,6 +131,12 @@ bz_entry_group_is_searchable (BzEntryGroup *self);
 guint64
 bz_entry_group_get_user_data_size (BzEntryGroup *self);
 
+/* Primes the user data size with a value measured elsewhere, so it isn't
+   walked again until the installation state changes */
+void
+bz_entry_group_set_user_data_size (BzEntryGroup *self,
+                                   guint64       size);
+
 void
 bz_entry_group_reap_user_data (BzEntryGroup *self);
 
@@ -37,9 +37,11 @@
 #include "bz-release.h"
 #include "bz-repository.h"
 #include "bz-serializable.h"
+#include "bz-text-dictionary.h"
 #include "bz-url.h"
 #include "bz-util.h"
 #include "bz-verification-status.h"
+#include "bz-vocabulary.h"
 
 G_DEFINE_FLAGS_TYPE (
     BzEntryKind,
@@ -85,6 +87,7 @@ typedef struct
   char             *eol;
   char             *description;
   char             *long_description;
+  GBytes           *long_description_z;
   char             *remote_repo_name;
   char             *url;
   guint64           size;
@@ -110,6 +113,7 @@ typedef struct
   double            average_rating;
   char             *ratings_summary;
   GListModel       *version_history;
+  GBytes           *version_history_z;
   char             *light_accent_color;
   char             *dark_accent_color;
   gboolean          is_mobile_friendly;
@@ -119,7 +123,9 @@ typedef struct
   gint              min_display_length;
   gint              max_display_length;
   AsContentRating  *content_rating;
+  guint            *keyword_ids;
   GListModel       *keywords;
+  guint            *category_ids;
   GListModel       *categories;
   BzAppPermissions *permissions;
 
@@ -272,6 +278,17 @@ load_mini_icon_sync (const char *unique_id_checksum,
 static void
 clear_entry (BzEntry *self);
 
+static const char *
+ensure_long_description (BzEntryPrivate *priv);
+
+static GListModel *
+ensure_version_history (BzEntryPrivate *priv);
+
+static GListModel *
+ensure_vocabulary_model (GListModel  **model_ptr,
+                         BzVocabulary *vocabulary,
+                         const guint  *ids);
+
 static void
 bz_entry_dispose (GObject *object)
 {
@@ -330,7 +347,7 @@ bz_entry_get_property (GObject    *object,
       g_value_set_string (value, priv->description);
       break;
     case PROP_LONG_DESCRIPTION:
-      g_value_set_string (value, priv->long_description);
+      g_value_set_string (value, ensure_long_description (priv));
       break;
     case PROP_REMOTE_REPO_NAME:
       g_value_set_string (value, priv->remote_repo_name);
@@ -407,7 +424,7 @@ bz_entry_get_property (GObject    *object,
       g_value_set_string (value, priv->ratings_summary);
       break;
     case PROP_VERSION_HISTORY:
-      g_value_set_object (value, priv->version_history);
+      g_value_set_object (value, ensure_version_history (priv));
       break;
     case PROP_LIGHT_ACCENT_COLOR:
       g_value_set_string (value, priv->light_accent_color);
@@ -437,10 +454,10 @@ bz_entry_get_property (GObject    *object,
       g_value_set_object (value, priv->content_rating);
       break;
     case PROP_KEYWORDS:
-      g_value_set_object (value, priv->keywords);
+      g_value_set_object (value, ensure_vocabulary_model (&priv->keywords, bz_vocabulary_get_keywords (), priv->keyword_ids));
       break;
     case PROP_CATEGORIES:
-      g_value_set_object (value, priv->categories);
+      g_value_set_object (value, ensure_vocabulary_model (&priv->categories, bz_vocabulary_get_categories (), priv->category_ids));
       break;
     case PROP_PERMISSIONS:
       g_value_set_object (value, priv->permissions);
@@ -531,6 +548,7 @@ bz_entry_set_property (GObject      *object,
       break;
     case PROP_LONG_DESCRIPTION:
       g_clear_pointer (&priv->long_description, g_free);
+      g_clear_pointer (&priv->long_description_z, g_bytes_unref);
       priv->long_description = g_value_dup_string (value);
       break;
     case PROP_REMOTE_REPO_NAME:
@@ -629,6 +647,7 @@ bz_entry_set_property (GObject      *object,
       break;
     case PROP_VERSION_HISTORY:
       g_clear_object (&priv->version_history);
+      g_clear_pointer (&priv->version_history_z, g_bytes_unref);
       priv->version_history = g_value_dup_object (value);
       break;
     case PROP_LIGHT_ACCENT_COLOR:
@@ -662,12 +681,14 @@ bz_entry_set_property (GObject      *object,
       priv->content_rating = g_value_dup_object (value);
       break;
     case PROP_KEYWORDS:
+      g_clear_pointer (&priv->keyword_ids, g_free);
       g_clear_object (&priv->keywords);
-      priv->keywords = g_value_dup_object (value);
+      priv->keyword_ids = bz_vocabulary_intern_model (bz_vocabulary_get_keywords (), g_value_get_object (value));
       break;
     case PROP_CATEGORIES:
+      g_clear_pointer (&priv->category_ids, g_free);
       g_clear_object (&priv->categories);
-      priv->categories = g_value_dup_object (value);
+      priv->category_ids = bz_vocabulary_intern_model (bz_vocabulary_get_categories (), g_value_get_object (value));
       break;
     case PROP_PERMISSIONS:
       g_clear_object (&priv->permissions);
@@ -1178,8 +1199,22 @@ bz_entry_real_serialize (BzSerializable  *serializable,
     g_variant_builder_add (builder, "{sv}", "eol", g_variant_new_string (priv->eol));
   if (priv->description != NULL)
     g_variant_builder_add (builder, "{sv}", "description", g_variant_new_string (priv->description));
-  if (priv->long_description != NULL)
-    g_variant_builder_add (builder, "{sv}", "long-description", g_variant_new_string (priv->long_description));
+  /* Long text is passed through compressed as it was read, unless it has
+     been replaced since */
+  if (priv->long_description_z != NULL)
+    g_variant_builder_add (builder, "{sv}", "long-description-z",
+                           g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, priv->long_description_z, TRUE));
+  else if (priv->long_description != NULL)
+    {
+      g_autoptr (GBytes) compressed = NULL;
+
+      compressed = bz_text_dictionary_compress (priv->long_description, strlen (priv->long_description) + 1);
+      if (compressed != NULL)
+        g_variant_builder_add (builder, "{sv}", "long-description-z",
+                               g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, compressed, TRUE));
+      else
+        g_variant_builder_add (builder, "{sv}", "long-description", g_variant_new_string (priv->long_description));
+    }
   if (priv->remote_repo_name != NULL)
     g_variant_builder_add (builder, "{sv}", "remote-repo-name", g_variant_new_string (priv->remote_repo_name));
   if (priv->url != NULL)
@@ -1289,7 +1324,10 @@ bz_entry_real_serialize (BzSerializable  *serializable,
     g_variant_builder_add (builder, "{sv}", "donation-url", g_variant_new_string (priv->donation_url));
   if (priv->forge_url != NULL)
     g_variant_builder_add (builder, "{sv}", "forge-url", g_variant_new_string (priv->forge_url));
-  if (priv->version_history != NULL)
+  if (priv->version_history_z != NULL)
+    g_variant_builder_add (builder, "{sv}", "version-history-z",
+                           g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, priv->version_history_z, TRUE));
+  else if (priv->version_history != NULL)
     {
       guint n_items = 0;
 
@@ -1297,32 +1335,29 @@ bz_entry_real_serialize (BzSerializable  *serializable,
       if (n_items > 0)
         {
           g_autoptr (GVariantBuilder) sub_builder = NULL;
+          g_autoptr (GVariant) history            = NULL;
+          g_autoptr (GBytes) compressed           = NULL;
 
-          sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("a(mstmsms)"));
+          sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("a" BZ_RELEASE_VARIANT_FORMAT));
           for (guint i = 0; i < n_items; i++)
             {
               g_autoptr (BzRelease) release = NULL;
-              guint64     timestamp         = 0;
-              const char *url               = NULL;
-              const char *version           = NULL;
-              const char *description       = NULL;
-
-              release     = g_list_model_get_item (priv->version_history, i);
-              timestamp   = bz_release_get_timestamp (release);
-              url         = bz_release_get_url (release);
-              version     = bz_release_get_version (release);
-              description = bz_release_get_description (release);
-
-              g_variant_builder_add (
-                  sub_builder,
-                  "(mstmsms)",
-                  description,
-                  timestamp,
-                  url,
-                  version);
-            }
 
-          g_variant_builder_add (builder, "{sv}", "version-history", g_variant_builder_end (sub_builder));
+              release = g_list_model_get_item (priv->version_history, i);
+              g_variant_builder_add_value (sub_builder, bz_release_to_variant (release));
+            }
+          history = g_variant_ref_sink (g_variant_builder_end (sub_builder));
+
+          /* Release notes are mostly boilerplate, so the whole serialized
+             list compresses well against the dictionary */
+          compressed = bz_text_dictionary_compress (
+              g_variant_get_data (history),
+              g_variant_get_size (history));
+          if (compressed != NULL)
+            g_variant_builder_add (builder, "{sv}", "version-history-z",
+                                   g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, compressed, TRUE));
+          else
+            g_variant_builder_add (builder, "{sv}", "version-history", history);
         }
     }
   if (priv->light_accent_color != NULL)
@@ -1361,51 +1396,30 @@ bz_entry_real_serialize (BzSerializable  *serializable,
       g_variant_builder_add (builder, "{sv}", "content-rating-kind", g_variant_new_string (kind ? kind : "oars-1.1"));
       g_variant_builder_add (builder, "{sv}", "content-rating-values", g_variant_builder_end (sub_builder));
     }
-  if (priv->keywords != NULL)
+  /* The vocabularies are per process, so the cache keeps the strings
+     rather than the IDs */
+  if (priv->keyword_ids != NULL)
     {
-      guint n_items = 0;
-
-      n_items = g_list_model_get_n_items (priv->keywords);
-      if (n_items > 0)
-        {
-          g_autoptr (GVariantBuilder) sub_builder = NULL;
-
-          sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("as"));
-          for (guint i = 0; i < n_items; i++)
-            {
-              g_autoptr (GtkStringObject) string = NULL;
+      BzVocabulary *vocabulary                = bz_vocabulary_get_keywords ();
+      g_autoptr (GVariantBuilder) sub_builder = NULL;
 
-              string = g_list_model_get_item (priv->keywords, i);
-              g_variant_builder_add (sub_builder, "s", gtk_string_object_get_string (string));
-            }
+      sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("as"));
+      for (const guint *id = priv->keyword_ids; *id != 0; id++)
+        g_variant_builder_add (sub_builder, "s", bz_vocabulary_get_string (vocabulary, *id));
 
-          g_variant_builder_add (builder, "{sv}", "keywords", g_variant_builder_end (sub_builder));
-        }
+      g_variant_builder_add (builder, "{sv}", "keywords", g_variant_builder_end (sub_builder));
     }
 
-  if (priv->categories != NULL)
+  if (priv->category_ids != NULL)
     {
-      guint n_items = 0;
-
-      n_items = g_list_model_get_n_items (priv->categories);
-      if (n_items > 0)
-        {
-          g_autoptr (GVariantBuilder) sub_builder = NULL;
-
-          sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("as"));
-          for (guint i = 0; i < n_items; i++)
-            {
-              g_autoptr (BzFlathubCategory) category = NULL;
-              const char *category_name              = NULL;
+      BzVocabulary *vocabulary                = bz_vocabulary_get_categories ();
+      g_autoptr (GVariantBuilder) sub_builder = NULL;
 
-              category      = g_list_model_get_item (priv->categories, i);
-              category_name = bz_flathub_category_get_name (category);
-              if (category_name != NULL)
-                g_variant_builder_add (sub_builder, "s", category_name);
-            }
+      sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("as"));
+      for (const guint *id = priv->category_ids; *id != 0; id++)
+        g_variant_builder_add (sub_builder, "s", bz_vocabulary_get_string (vocabulary, *id));
 
-          g_variant_builder_add (builder, "{sv}", "categories", g_variant_builder_end (sub_builder));
-        }
+      g_variant_builder_add (builder, "{sv}", "categories", g_variant_builder_end (sub_builder));
     }
 
   if (priv->verification_status != NULL)
@@ -1462,20 +1476,13 @@ bz_entry_real_serialize (BzSerializable  *serializable,
                 {
                   g_autoptr (GVariantBuilder) sub_builder = NULL;
 
-                  sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("a(ddms)"));
+                  sub_builder = g_variant_builder_new (G_VARIANT_TYPE ("a" BZ_DATA_POINT_VARIANT_FORMAT));
                   for (guint i = 0; i < n_items; i++)
                     {
                       g_autoptr (BzDataPoint) point = NULL;
-                      double      independent       = 0.0;
-                      double      dependent         = 0.0;
-                      const char *label             = NULL;
 
-                      point       = g_list_model_get_item (priv->download_stats, i);
-                      independent = bz_data_point_get_independent (point);
-                      dependent   = bz_data_point_get_dependent (point);
-                      label       = bz_data_point_get_label (point);
-
-                      g_variant_builder_add (sub_builder, "(ddms)", independent, dependent, label);
+                      point = g_list_model_get_item (priv->download_stats, i);
+                      g_variant_builder_add_value (sub_builder, bz_data_point_to_variant (point));
                     }
                   g_variant_builder_add (builder, "{sv}", "download-stats", g_variant_builder_end (sub_builder));
                 }
@@ -1488,6 +1495,33 @@ bz_entry_real_serialize (BzSerializable  *serializable,
     }
 }
 
+static guint *
+intern_strv_variant (BzVocabulary *vocabulary,
+                     GVariant     *value)
+{
+  gsize        n_strings = 0;
+  const char **strings   = NULL;
+  guint       *ids       = NULL;
+  guint        n_ids     = 0;
+
+  strings = g_variant_get_strv (value, &n_strings);
+  if (n_strings > 0)
+    {
+      ids = g_new0 (guint, n_strings + 1);
+      for (gsize i = 0; i < n_strings; i++)
+        {
+          guint id = 0;
+
+          id = bz_vocabulary_intern (vocabulary, strings[i]);
+          if (!bz_vocabulary_ids_contain (ids, id))
+            ids[n_ids++] = id;
+        }
+    }
+  g_free (strings);
+
+  return ids;
+}
+
 static gboolean
 bz_entry_real_deserialize (BzSerializable *serializable,
                            GVariant       *import,
@@ -1551,6 +1585,12 @@ bz_entry_real_deserialize (BzSerializable *serializable,
         priv->description = g_variant_dup_string (value, NULL);
       else if (g_strcmp0 (key, "long-description") == 0)
         priv->long_description = g_variant_dup_string (value, NULL);
+      /* Copied so the rest of the cache file isn't kept alive. These are
+         only decompressed once something reads them */
+      else if (g_strcmp0 (key, "long-description-z") == 0)
+        priv->long_description_z = g_bytes_new (g_variant_get_data (value), g_variant_get_size (value));
+      else if (g_strcmp0 (key, "version-history-z") == 0)
+        priv->version_history_z = g_bytes_new (g_variant_get_data (value), g_variant_get_size (value));
       else if (g_strcmp0 (key, "remote-repo-name") == 0)
         priv->remote_repo_name = g_variant_dup_string (value, NULL);
       else if (g_strcmp0 (key, "url") == 0)
@@ -1662,20 +1702,14 @@ bz_entry_real_deserialize (BzSerializable *serializable,
           version_iter = g_variant_iter_new (value);
           for (;;)
             {
-              guint64          timestamp    = 0;
-              g_autofree char *url          = NULL;
-              g_autofree char *description  = NULL;
-              g_autofree char *version      = NULL;
-              g_autoptr (BzRelease) release = NULL;
+              g_autoptr (GVariant) release_variant = NULL;
+              g_autoptr (BzRelease) release        = NULL;
 
-              if (!g_variant_iter_next (version_iter, "(mstmsms)", &description, &timestamp, &url, &version))
+              release_variant = g_variant_iter_next_value (version_iter);
+              if (release_variant == NULL)
                 break;
 
-              release = bz_release_new ();
-              bz_release_set_timestamp (release, timestamp);
-              bz_release_set_url (release, url);
-              bz_release_set_version (release, version);
-              bz_release_set_description (release, description);
+              release = bz_release_new_from_variant (release_variant);
               g_list_store_append (store, release);
             }
 
@@ -1731,49 +1765,9 @@ bz_entry_real_deserialize (BzSerializable *serializable,
             }
         }
       else if (g_strcmp0 (key, "keywords") == 0)
-        {
-          g_autoptr (GListStore) store           = NULL;
-          g_autoptr (GVariantIter) keywords_iter = NULL;
-
-          store = g_list_store_new (GTK_TYPE_STRING_OBJECT);
-
-          keywords_iter = g_variant_iter_new (value);
-          for (;;)
-            {
-              g_autofree char *keyword           = NULL;
-              g_autoptr (GtkStringObject) string = NULL;
-
-              if (!g_variant_iter_next (keywords_iter, "s", &keyword))
-                break;
-              string = gtk_string_object_new (keyword);
-              g_list_store_append (store, string);
-            }
-
-          priv->keywords = G_LIST_MODEL (g_steal_pointer (&store));
-        }
+        priv->keyword_ids = intern_strv_variant (bz_vocabulary_get_keywords (), value);
       else if (g_strcmp0 (key, "categories") == 0)
-        {
-          g_autoptr (GListStore) store             = NULL;
-          g_autoptr (GVariantIter) categories_iter = NULL;
-
-          store = g_list_store_new (BZ_TYPE_FLATHUB_CATEGORY);
-
-          categories_iter = g_variant_iter_new (value);
-          for (;;)
-            {
-              g_autofree char *category_name         = NULL;
-              g_autoptr (BzFlathubCategory) category = NULL;
-
-              if (!g_variant_iter_next (categories_iter, "s", &category_name))
-                break;
-
-              category = bz_flathub_category_new ();
-              bz_flathub_category_set_name (category, category_name);
-              g_list_store_append (store, category);
-            }
-
-          priv->categories = G_LIST_MODEL (g_steal_pointer (&store));
-        }
+        priv->category_ids = intern_strv_variant (bz_vocabulary_get_categories (), value);
       else if (g_strcmp0 (key, "verification-verified") == 0)
         {
           if (priv->verification_status == NULL)
@@ -2075,7 +2069,7 @@ bz_entry_get_long_description (BzEntry *self)
   g_return_val_if_fail (BZ_IS_ENTRY (self), NULL);
   priv = bz_entry_get_instance_private (self);
 
-  return priv->long_description;
+  return ensure_long_description (priv);
 }
 
 const char *
@@ -2388,15 +2382,26 @@ bz_entry_get_content_rating (BzEntry *self)
   return priv->content_rating;
 }
 
-GListModel *
-bz_entry_get_categories (BzEntry *self)
+const guint *
+bz_entry_get_category_ids (BzEntry *self)
+{
+  BzEntryPrivate *priv = NULL;
+
+  g_return_val_if_fail (BZ_IS_ENTRY (self), NULL);
+
+  priv = bz_entry_get_instance_private (self);
+  return priv->category_ids;
+}
+
+const guint *
+bz_entry_get_keyword_ids (BzEntry *self)
 {
   BzEntryPrivate *priv = NULL;
 
   g_return_val_if_fail (BZ_IS_ENTRY (self), NULL);
 
   priv = bz_entry_get_instance_private (self);
-  return priv->categories;
+  return priv->keyword_ids;
 }
 
 gboolean
@@ -2453,7 +2458,7 @@ bz_entry_calc_usefulness (BzEntry *self)
 
   score += priv->title != NULL ? 5 : 0;
   score += priv->description != NULL ? 1 : 0;
-  score += priv->long_description != NULL ? 5 : 0;
+  score += priv->long_description != NULL || priv->long_description_z != NULL ? 5 : 0;
   score += priv->url != NULL ? 1 : 0;
   score += priv->size > 0 ? 1 : 0;
   score += priv->icon_paintable != NULL ? 15 : 0;
@@ -2976,6 +2981,104 @@ load_mini_icon_notify (LoadMiniIconData *data)
   return dex_future_new_true ();
 }
 
+/* Entries are read from several threads, so whichever decompresses first
+   publishes its result and the others throw theirs away */
+static const char *
+ensure_long_description (BzEntryPrivate *priv)
+{
+  g_autoptr (GError) local_error = NULL;
+  g_autoptr (GBytes) bytes       = NULL;
+  const char *data               = NULL;
+  gsize       size               = 0;
+  char       *text               = NULL;
+
+  text = g_atomic_pointer_get (&priv->long_description);
+  if (text != NULL || priv->long_description_z == NULL)
+    return text;
+
+  bytes = bz_text_dictionary_decompress (priv->long_description_z, &local_error);
+  if (bytes == NULL)
+    {
+      g_warning ("Failed to decompress cached long description: %s", local_error->message);
+      return NULL;
+    }
+
+  data = g_bytes_get_data (bytes, &size);
+  if (size == 0 || data[size - 1] != '\0')
+    {
+      g_warning ("Cached long description is not a valid string");
+      return NULL;
+    }
+
+  text = g_strdup (data);
+  if (!g_atomic_pointer_compare_and_exchange (&priv->long_description, NULL, text))
+    g_free (text);
+
+  return g_atomic_pointer_get (&priv->long_description);
+}
+
+static GListModel *
+ensure_version_history (BzEntryPrivate *priv)
+{
+  g_autoptr (GError) local_error = NULL;
+  g_autoptr (GBytes) bytes       = NULL;
+  g_autoptr (GVariant) history   = NULL;
+  g_autoptr (GListStore) store   = NULL;
+  g_autoptr (GVariantIter) iter  = NULL;
+  GListModel *model              = NULL;
+
+  model = g_atomic_pointer_get (&priv->version_history);
+  if (model != NULL || priv->version_history_z == NULL)
+    return model;
+
+  bytes = bz_text_dictionary_decompress (priv->version_history_z, &local_error);
+  if (bytes == NULL)
+    {
+      g_warning ("Failed to decompress cached version history: %s", local_error->message);
+      return NULL;
+    }
+
+  history = g_variant_ref_sink (g_variant_new_from_bytes (
+      G_VARIANT_TYPE ("a" BZ_RELEASE_VARIANT_FORMAT), bytes, FALSE));
+  store   = g_list_store_new (BZ_TYPE_RELEASE);
+
+  iter = g_variant_iter_new (history);
+  for (;;)
+    {
+      g_autoptr (GVariant) release_variant = NULL;
+      g_autoptr (BzRelease) release        = NULL;
+
+      release_variant = g_variant_iter_next_value (iter);
+      if (release_variant == NULL)
+        break;
+
+      release = bz_release_new_from_variant (release_variant);
+      g_list_store_append (store, release);
+    }
+
+  if (g_atomic_pointer_compare_and_exchange (&priv->version_history, NULL, store))
+    g_steal_pointer (&store);
+
+  return g_atomic_pointer_get (&priv->version_history);
+}
+
+static GListModel *
+ensure_vocabulary_model (GListModel  **model_ptr,
+                         BzVocabulary *vocabulary,
+                         const guint  *ids)
+{
+  g_autoptr (GListModel) model = NULL;
+
+  if (g_atomic_pointer_get (model_ptr) != NULL)
+    return g_atomic_pointer_get (model_ptr);
+
+  model = bz_vocabulary_dup_model (vocabulary, ids);
+  if (g_atomic_pointer_compare_and_exchange (model_ptr, NULL, model))
+    g_steal_pointer (&model);
+
+  return g_atomic_pointer_get (model_ptr);
+}
+
 static void
 clear_entry (BzEntry *self)
 {
@@ -2992,6 +3095,7 @@ clear_entry (BzEntry *self)
   g_clear_pointer (&priv->eol, g_free);
   g_clear_pointer (&priv->description, g_free);
   g_clear_pointer (&priv->long_description, g_free);
+  g_clear_pointer (&priv->long_description_z, g_bytes_unref);
   g_clear_pointer (&priv->remote_repo_name, g_free);
   g_clear_pointer (&priv->url, g_free);
   g_clear_object (&priv->icon_paintable);
@@ -3013,13 +3117,16 @@ clear_entry (BzEntry *self)
   g_clear_object (&priv->reviews);
   g_clear_pointer (&priv->ratings_summary, g_free);
   g_clear_object (&priv->version_history);
+  g_clear_pointer (&priv->version_history_z, g_bytes_unref);
   g_clear_pointer (&priv->light_accent_color, g_free);
   g_clear_pointer (&priv->dark_accent_color, g_free);
   g_clear_object (&priv->verification_status);
   g_clear_object (&priv->download_stats);
   g_clear_object (&priv->download_stats_per_country);
   g_clear_object (&priv->content_rating);
+  g_clear_pointer (&priv->keyword_ids, g_free);
   g_clear_object (&priv->keywords);
+  g_clear_pointer (&priv->category_ids, g_free);
   g_clear_object (&priv->categories);
   g_clear_object (&priv->permissions);
 }
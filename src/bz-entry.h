@@ -222,8 +222,13 @@ bz_entry_get_age_rating (BzEntry *self);
 AsContentRating *
 bz_entry_get_content_rating (BzEntry *self);
 
-GListModel *
-bz_entry_get_categories (BzEntry *self);
+/* Zero terminated IDs from bz_vocabulary_get_categories (), or NULL */
+const guint *
+bz_entry_get_category_ids (BzEntry *self);
+
+/* Zero terminated IDs from bz_vocabulary_get_keywords (), or NULL */
+const guint *
+bz_entry_get_keyword_ids (BzEntry *self);
 
 DexFuture *
 bz_entry_load_mini_icon (BzEntry *self);
@@ -19,11 +19,17 @@
  */
 
 #include <glib/gi18n.h>
+#include <libdex.h>
 
 #include "appstream.h"
+#include "bz-env.h"
 #include "bz-flathub-category.h"
 #include "bz-flathub-sub-category.h"
+#include "bz-global-net.h"
+#include "bz-io.h"
+#include "bz-json-extract.h"
 #include "bz-serializable.h"
+#include "bz-util.h"
 
 struct _BzFlathubCategory
 {
@@ -36,6 +42,17 @@ struct _BzFlathubCategory
   int                      total_entries;
   gboolean                 is_spotlight;
   GListModel              *subcategories;
+
+  /* Paging state for categories backed by a flathub collection route,
+     where `applications` only holds the pages fetched so far */
+  char       *page_route;
+  guint       page_size;
+  guint       next_page;
+  gboolean    exhausted;
+  GHashTable *seen;
+  DexFuture  *fetching;
+  GStrv       prefetched;
+  gboolean    want_page;
 };
 
 static void
@@ -69,6 +86,9 @@ static GParamSpec *props[LAST_PROP] = { 0 };
 static void
 clear (BzFlathubCategory *self);
 
+static void
+reset_paging (BzFlathubCategory *self);
+
 typedef struct
 {
   const char *id;
@@ -386,6 +406,13 @@ bz_flathub_category_real_serialize (BzSerializable  *serializable,
     }
   g_variant_builder_add (builder, "{sv}", "total-entries", g_variant_new_int32 (self->total_entries));
   g_variant_builder_add (builder, "{sv}", "is-spotlight", g_variant_new_boolean (self->is_spotlight));
+  if (self->page_route != NULL)
+    {
+      g_variant_builder_add (builder, "{sv}", "page-route", g_variant_new_string (self->page_route));
+      g_variant_builder_add (builder, "{sv}", "page-size", g_variant_new_uint32 (self->page_size));
+      g_variant_builder_add (builder, "{sv}", "next-page", g_variant_new_uint32 (self->next_page));
+      g_variant_builder_add (builder, "{sv}", "exhausted", g_variant_new_boolean (self->exhausted));
+    }
 }
 
 static gboolean
@@ -452,8 +479,19 @@ bz_flathub_category_real_deserialize (BzSerializable *serializable,
         self->total_entries = g_variant_get_int32 (value);
       else if (g_strcmp0 (key, "is-spotlight") == 0)
         self->is_spotlight = g_variant_get_boolean (value);
+      else if (g_strcmp0 (key, "page-route") == 0)
+        self->page_route = g_variant_dup_string (value, NULL);
+      else if (g_strcmp0 (key, "page-size") == 0)
+        self->page_size = g_variant_get_uint32 (value);
+      else if (g_strcmp0 (key, "next-page") == 0)
+        self->next_page = g_variant_get_uint32 (value);
+      else if (g_strcmp0 (key, "exhausted") == 0)
+        self->exhausted = g_variant_get_boolean (value);
     }
 
+  if (self->page_size == 0 || self->next_page == 0)
+    g_clear_pointer (&self->page_route, g_free);
+
   return TRUE;
 }
 
@@ -579,6 +617,10 @@ bz_flathub_category_set_applications (BzFlathubCategory *self,
   if (applications != NULL)
     self->applications = g_object_ref (applications);
 
+  /* Pages already fetched belonged to the old list */
+  reset_paging (self);
+  g_clear_pointer (&self->page_route, g_free);
+
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_APPLICATIONS]);
 }
 
@@ -682,6 +724,259 @@ clear (BzFlathubCategory *self)
   g_clear_pointer (&self->applications, g_object_unref);
   g_clear_pointer (&self->quality_applications, g_object_unref);
   g_clear_object (&self->subcategories);
+  g_clear_pointer (&self->page_route, g_free);
+  reset_paging (self);
+}
+
+static void
+reset_paging (BzFlathubCategory *self)
+{
+  dex_clear (&self->fetching);
+  g_clear_pointer (&self->seen, g_hash_table_unref);
+  g_clear_pointer (&self->prefetched, g_strfreev);
+  self->exhausted = FALSE;
+  self->want_page = FALSE;
+}
+
+static DexFuture *
+fetch_page_fiber (char *request)
+{
+  g_autoptr (GError) local_error   = NULL;
+  g_autoptr (GBytes) bytes         = NULL;
+  g_auto (BzJsonField) apps        = BZ_JSON_FIELD_INIT ("hits[].app_id");
+  g_autoptr (GStrvBuilder) builder = NULL;
+
+  bytes = dex_await_boxed (
+      bz_query_flathub_v2_bytes_take (g_strdup (request)),
+      &local_error);
+  if (bytes == NULL)
+    return dex_future_new_for_error (g_steal_pointer (&local_error));
+
+  if (!bz_json_extract (bytes, &local_error, &apps, NULL))
+    return dex_future_new_for_error (g_steal_pointer (&local_error));
+
+  builder = g_strv_builder_new ();
+  for (guint i = 0; apps.strings != NULL && i < apps.strings->len; i++)
+    g_strv_builder_add (builder, g_ptr_array_index (apps.strings, i));
+
+  return dex_future_new_take_boxed (G_TYPE_STRV, g_strv_builder_end (builder));
+}
+
+static gboolean
+is_fetching (BzFlathubCategory *self)
+{
+  return self->fetching != NULL && dex_future_is_pending (self->fetching);
+}
+
+static void
+append_page (BzFlathubCategory *self,
+             GStrv              ids)
+{
+  g_autoptr (GStrvBuilder) builder = NULL;
+  g_auto (GStrv) fresh             = NULL;
+  guint n_items                    = 0;
+
+  n_items = g_list_model_get_n_items (self->applications);
+
+  if (self->seen == NULL)
+    {
+      self->seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      for (guint i = 0; i < n_items; i++)
+        {
+          g_autoptr (GtkStringObject) string = NULL;
+
+          string = g_list_model_get_item (self->applications, i);
+          g_hash_table_add (self->seen, g_strdup (gtk_string_object_get_string (string)));
+        }
+    }
+
+  /* Collections are ranked live, so entries can shift across page
+     boundaries between requests */
+  builder = g_strv_builder_new ();
+  for (guint i = 0; ids[i] != NULL; i++)
+    {
+      if (g_hash_table_add (self->seen, g_strdup (ids[i])))
+        g_strv_builder_add (builder, ids[i]);
+    }
+  fresh = g_strv_builder_end (builder);
+
+  self->next_page++;
+  if (g_strv_length (ids) < self->page_size)
+    self->exhausted = TRUE;
+
+  if (fresh[0] != NULL)
+    gtk_string_list_splice (
+        GTK_STRING_LIST (self->applications),
+        n_items, 0, (const char *const *) fresh);
+}
+
+static void
+start_fetch (BzFlathubCategory *self);
+
+static void
+advance (BzFlathubCategory *self)
+{
+  g_auto (GStrv) ids = NULL;
+
+  ids             = g_steal_pointer (&self->prefetched);
+  self->want_page = FALSE;
+
+  append_page (self, ids);
+
+  /* Stay one page ahead of what is shown */
+  if (bz_flathub_category_get_has_more (self))
+    start_fetch (self);
+}
+
+static DexFuture *
+fetch_page_finally (DexFuture *future,
+                    GWeakRef  *wr)
+{
+  g_autoptr (BzFlathubCategory) self = NULL;
+  g_autoptr (GError) local_error     = NULL;
+  const GValue *value                = NULL;
+
+  bz_weak_get_or_return_reject (self, wr);
+
+  value = dex_future_get_value (future, &local_error);
+  if (value == NULL)
+    {
+      if (!g_error_matches (local_error, DEX_ERROR, DEX_ERROR_FIBER_CANCELLED))
+        g_warning ("Failed to fetch page %u of %s: %s",
+                   self->next_page, self->page_route, local_error->message);
+      self->want_page = FALSE;
+      return dex_ref (future);
+    }
+
+  g_clear_pointer (&self->prefetched, g_strfreev);
+  self->prefetched = g_value_dup_boxed (value);
+
+  if (self->want_page)
+    advance (self);
+
+  return dex_future_new_true ();
+}
+
+static void
+start_fetch (BzFlathubCategory *self)
+{
+  g_autofree char *request     = NULL;
+  g_autoptr (DexFuture) future = NULL;
+
+  request = g_strdup_printf (
+      "%s?page=%u&per_page=%u",
+      self->page_route, self->next_page, self->page_size);
+
+  future = dex_scheduler_spawn (
+      bz_get_io_scheduler (),
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) fetch_page_fiber,
+      g_steal_pointer (&request),
+      g_free);
+  future = dex_future_finally (
+      future,
+      (DexFutureCallback) fetch_page_finally,
+      bz_track_weak (self),
+      bz_weak_release);
+
+  dex_clear (&self->fetching);
+  self->fetching = g_steal_pointer (&future);
+}
+
+void
+bz_flathub_category_set_page_route (BzFlathubCategory *self,
+                                    const char        *route,
+                                    guint              page_size,
+                                    guint              next_page)
+{
+  g_return_if_fail (BZ_IS_FLATHUB_CATEGORY (self));
+  g_return_if_fail (route == NULL || page_size > 0);
+
+  reset_paging (self);
+  g_clear_pointer (&self->page_route, g_free);
+
+  if (route != NULL)
+    {
+      self->page_route = g_strdup (route);
+      self->page_size  = page_size;
+      self->next_page  = next_page;
+    }
+}
+
+const char *
+bz_flathub_category_get_page_route (BzFlathubCategory *self)
+{
+  g_return_val_if_fail (BZ_IS_FLATHUB_CATEGORY (self), NULL);
+  return self->page_route;
+}
+
+gboolean
+bz_flathub_category_get_has_more (BzFlathubCategory *self)
+{
+  g_return_val_if_fail (BZ_IS_FLATHUB_CATEGORY (self), FALSE);
+
+  if (self->page_route == NULL ||
+      self->exhausted ||
+      !GTK_IS_STRING_LIST (self->applications))
+    return FALSE;
+
+  return self->total_entries <= 0 ||
+         g_list_model_get_n_items (self->applications) < (guint) self->total_entries;
+}
+
+void
+bz_flathub_category_prefetch (BzFlathubCategory *self)
+{
+  g_return_if_fail (BZ_IS_FLATHUB_CATEGORY (self));
+
+  if (!bz_flathub_category_get_has_more (self) ||
+      self->prefetched != NULL ||
+      is_fetching (self))
+    return;
+
+  start_fetch (self);
+}
+
+void
+bz_flathub_category_load_more (BzFlathubCategory *self)
+{
+  g_return_if_fail (BZ_IS_FLATHUB_CATEGORY (self));
+
+  if (!bz_flathub_category_get_has_more (self))
+    return;
+
+  if (self->prefetched != NULL)
+    advance (self);
+  else
+    {
+      /* The page is appended as soon as it arrives */
+      self->want_page = TRUE;
+      if (!is_fetching (self))
+        start_fetch (self);
+    }
+}
+
+void
+bz_flathub_category_trim_pages (BzFlathubCategory *self)
+{
+  guint n_items = 0;
+
+  g_return_if_fail (BZ_IS_FLATHUB_CATEGORY (self));
+
+  if (self->page_route == NULL ||
+      !GTK_IS_STRING_LIST (self->applications))
+    return;
+
+  n_items = g_list_model_get_n_items (self->applications);
+  if (n_items <= self->page_size)
+    return;
+
+  reset_paging (self);
+  self->next_page = 2;
+
+  gtk_string_list_splice (
+      GTK_STRING_LIST (self->applications),
+      self->page_size, n_items - self->page_size, NULL);
 }
 
 static const char *
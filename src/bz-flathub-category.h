@@ -89,6 +89,29 @@ bz_flathub_category_set_is_spotlight (BzFlathubCategory *self,
 GListModel *
 bz_flathub_category_get_subcategories (BzFlathubCategory *self);
 
+void
+bz_flathub_category_set_page_route (BzFlathubCategory *self,
+                                    const char        *route,
+                                    guint              page_size,
+                                    guint              next_page);
+
+const char *
+bz_flathub_category_get_page_route (BzFlathubCategory *self);
+
+gboolean
+bz_flathub_category_get_has_more (BzFlathubCategory *self);
+
+void
+bz_flathub_category_prefetch (BzFlathubCategory *self);
+
+void
+bz_flathub_category_load_more (BzFlathubCategory *self);
+
+/* Drops every page past the first, they are fetched again as the category
+   is browsed */
+void
+bz_flathub_category_trim_pages (BzFlathubCategory *self);
+
 GListModel *
 bz_flathub_category_list_from_appstream (GPtrArray *as_categories);
 
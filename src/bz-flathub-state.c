@@ -19,20 +19,21 @@
  */
 
 #define G_LOG_DOMAIN                 "BAZAAR::FLATHUB"
-#define COLLECTION_FETCH_SIZE        192
+#define COLLECTION_FETCH_SIZE        48
 #define CATEGORY_FETCH_SIZE          48
 #define QUALITY_MODERATION_PAGE_SIZE 300
 #define KEYWORD_SEARCH_PAGE_SIZE     48
 #define ADWAITA_URL                  "https://arewelibadwaitayet.com"
 
-#include <json-glib/json-glib.h>
 #include <libdex.h>
 
+#include "bz-cache-registry.h"
 #include "bz-env.h"
 #include "bz-flathub-category.h"
 #include "bz-flathub-state.h"
 #include "bz-global-net.h"
 #include "bz-io.h"
+#include "bz-json-extract.h"
 #include "bz-serializable.h"
 #include "bz-util.h"
 
@@ -48,6 +49,7 @@ struct _BzFlathubState
   gboolean                 has_connection_error;
 
   DexFuture *initializing;
+  guint      shed_id;
 };
 
 typedef enum
@@ -97,11 +99,15 @@ notify_all (BzFlathubState *self);
 static void
 clear (BzFlathubState *self);
 
+static void
+shed_cb (GWeakRef *wr);
+
 static void
 bz_flathub_state_dispose (GObject *object)
 {
   BzFlathubState *self = BZ_FLATHUB_STATE (object);
 
+  g_clear_handle_id (&self->shed_id, bz_cache_registry_remove);
   dex_clear (&self->initializing);
   g_clear_pointer (&self->map_factory, g_object_unref);
   clear (self);
@@ -243,6 +249,11 @@ bz_flathub_state_class_init (BzFlathubStateClass *klass)
 static void
 bz_flathub_state_init (BzFlathubState *self)
 {
+  self->shed_id = bz_cache_registry_add (
+      BZ_CACHE_PRIORITY_COLLECTIONS,
+      (BzCacheShedFunc) shed_cb,
+      bz_track_weak (self),
+      bz_weak_release);
 }
 
 static void
@@ -588,20 +599,21 @@ is_kde_plasma (void)
   return g_str_equal (desktop, "KDE") || g_strstr_len (desktop, -1, "KDE") != NULL;
 }
 
-static void
+static gboolean
 add_category (BzFlathubState *self,
               const char     *name,
-              JsonNode       *node,
+              const char     *page_route,
+              guint           page_size,
+              GBytes         *bytes,
               GHashTable     *quality_set,
               gboolean        is_json_object,
               QualityMode     quality_mode,
-              gboolean        is_spotlight)
+              gboolean        is_spotlight,
+              GError        **error)
 {
-  JsonObject    *object                   = NULL;
-  JsonObjectIter iter                     = { 0 };
-  JsonArray     *hits_array               = NULL;
-  const char    *key                      = NULL;
-  const char    *app                      = NULL;
+  g_auto (BzJsonField) apps_field         = BZ_JSON_FIELD_INIT (is_json_object ? "*" : "hits[].app_id");
+  g_auto (BzJsonField) total_field        = BZ_JSON_FIELD_INIT ("totalHits");
+  const char *app                         = NULL;
   g_autoptr (BzFlathubCategory) category  = NULL;
   g_autoptr (GtkStringList) store         = NULL;
   g_autoptr (GtkStringList) quality_store = NULL;
@@ -612,6 +624,11 @@ add_category (BzFlathubState *self,
   guint i                                 = 0;
   int   total_entries                     = 0;
 
+  /* Only the ids are needed, so pull them straight out of the response
+     instead of building a tree of every hit's metadata */
+  if (!bz_json_extract (bytes, error, &apps_field, &total_field, NULL))
+    return FALSE;
+
   category      = bz_flathub_category_new ();
   store         = gtk_string_list_new (NULL);
   quality_store = gtk_string_list_new (NULL);
@@ -620,57 +637,33 @@ add_category (BzFlathubState *self,
   bz_flathub_category_set_is_spotlight (category, is_spotlight);
   bz_flathub_category_set_applications (category, G_LIST_MODEL (store));
 
-  object = json_node_get_object (node);
+  if (quality_mode == QUALITY_MODE_RANDOM)
+    quality_apps = g_ptr_array_new_with_free_func (g_free);
 
-  if (is_json_object)
-    {
-      if (quality_mode == QUALITY_MODE_RANDOM)
-        quality_apps = g_ptr_array_new_with_free_func (g_free);
-
-      json_object_iter_init (&iter, object);
-      while (json_object_iter_next (&iter, &key, NULL))
-        {
-          gtk_string_list_append (store, key);
+  if (apps_field.strings != NULL)
+    app_count = apps_field.strings->len;
 
-          if (g_hash_table_contains (quality_set, key))
-            {
-              if (quality_mode == QUALITY_MODE_RANDOM)
-                g_ptr_array_add (quality_apps, g_strdup (key));
-              else if (quality_mode == QUALITY_MODE_FIRST)
-                gtk_string_list_append (quality_store, key);
-            }
-          app_count++;
-        }
-      total_entries = json_object_get_size (object);
-    }
-  else
+  for (i = 0; i < app_count; i++)
     {
-      if (quality_mode == QUALITY_MODE_RANDOM)
-        quality_apps = g_ptr_array_new_with_free_func (g_free);
+      const char *app_id = NULL;
 
-      hits_array = json_object_get_array_member (object, "hits");
-      app_count  = json_array_get_length (hits_array);
+      app_id = g_ptr_array_index (apps_field.strings, i);
+      gtk_string_list_append (store, app_id);
 
-      for (i = 0; i < app_count; i++)
+      if (g_hash_table_contains (quality_set, app_id))
         {
-          JsonObject *element = NULL;
-          const char *app_id  = NULL;
-
-          element = json_array_get_object_element (hits_array, i);
-          app_id  = json_object_get_string_member (element, "app_id");
-          gtk_string_list_append (store, app_id);
-
-          if (g_hash_table_contains (quality_set, app_id))
-            {
-              if (quality_mode == QUALITY_MODE_RANDOM)
-                g_ptr_array_add (quality_apps, g_strdup (app_id));
-              else if (quality_mode == QUALITY_MODE_FIRST)
-                gtk_string_list_append (quality_store, app_id);
-            }
+          if (quality_mode == QUALITY_MODE_RANDOM)
+            g_ptr_array_add (quality_apps, g_strdup (app_id));
+          else if (quality_mode == QUALITY_MODE_FIRST)
+            gtk_string_list_append (quality_store, app_id);
         }
-      total_entries = json_object_get_int_member (object, "totalHits");
     }
 
+  if (is_json_object)
+    total_entries = app_count;
+  else
+    total_entries = total_field.number;
+
   if (quality_mode == QUALITY_MODE_RANDOM && quality_apps != NULL)
     {
       quality_count = MIN (7, quality_apps->len);
@@ -685,7 +678,15 @@ add_category (BzFlathubState *self,
 
   bz_flathub_category_set_total_entries (category, total_entries);
   bz_flathub_category_set_quality_applications (category, G_LIST_MODEL (quality_store));
+
+  /* Only the first page is fetched up front, the rest is loaded as the
+     category is browsed */
+  if (page_route != NULL)
+    bz_flathub_category_set_page_route (category, page_route, page_size, 2);
+
   g_list_store_append (self->categories, category);
+
+  return TRUE;
 }
 
 static DexFuture *
@@ -719,7 +720,7 @@ initialize_fiber (GWeakRef *wr)
     g_autofree char *_request = NULL;                                                  \
                                                                                        \
     _request = g_strdup_printf (__VA_ARGS__);                                          \
-    (_var)   = bz_query_flathub_v2_json_take (g_steal_pointer (&_request));            \
+    (_var)   = bz_query_flathub_v2_bytes_take (g_steal_pointer (&_request));           \
     if (!dex_await (dex_ref ((_var)), &local_error))                                   \
       {                                                                                \
         g_warning ("Failed to complete request to flathub: %s", local_error->message); \
@@ -732,7 +733,7 @@ initialize_fiber (GWeakRef *wr)
     ADD_REQUEST (toolkit_f, "/collection/developer/kde?locale=en");
   else
     {
-      adwaita_f = bz_https_query_json (ADWAITA_URL "/api/apps");
+      adwaita_f = bz_https_query_bytes (ADWAITA_URL "/api/apps");
       if (!dex_await (dex_ref (adwaita_f), &local_error))
         {
           g_warning ("Failed to complete request to arewelibadwaitayet: %s", local_error->message);
@@ -745,72 +746,74 @@ initialize_fiber (GWeakRef *wr)
   ADD_REQUEST (aotd_f, "/app-picks/app-of-the-day/%s", self->for_day);
   ADD_REQUEST (aotw_f, "/app-picks/apps-of-the-week/%s", self->for_day);
   ADD_REQUEST (categories_f, "/collection/category");
-  ADD_REQUEST (updated_f, "/collection/recently-updated?page=0&per_page=%d", COLLECTION_FETCH_SIZE);
-  ADD_REQUEST (added_f, "/collection/recently-added?page=0&per_page=%d", COLLECTION_FETCH_SIZE);
-  ADD_REQUEST (popular_f, "/collection/popular?page=0&per_page=%d", COLLECTION_FETCH_SIZE);
-  ADD_REQUEST (trending_f, "/collection/trending?page=0&per_page=%d", COLLECTION_FETCH_SIZE);
-  ADD_REQUEST (mobile_f, "/collection/mobile?page=0&per_page=%d", COLLECTION_FETCH_SIZE);
+  ADD_REQUEST (updated_f, "/collection/recently-updated?page=1&per_page=%d", COLLECTION_FETCH_SIZE);
+  ADD_REQUEST (added_f, "/collection/recently-added?page=1&per_page=%d", COLLECTION_FETCH_SIZE);
+  ADD_REQUEST (popular_f, "/collection/popular?page=1&per_page=%d", COLLECTION_FETCH_SIZE);
+  ADD_REQUEST (trending_f, "/collection/trending?page=1&per_page=%d", COLLECTION_FETCH_SIZE);
+  ADD_REQUEST (mobile_f, "/collection/mobile?page=1&per_page=%d", COLLECTION_FETCH_SIZE);
 
 #undef ADD_REQUEST
 
 #define GET_BOXED(_future) g_value_get_boxed (dex_future_get_value ((_future), NULL))
 
-  {
-    JsonObject *object = NULL;
-    JsonArray  *array  = NULL;
-    guint       length = 0;
+#define EXTRACT_OR_RETURN(_future, ...)                                           \
+  G_STMT_START                                                                    \
+  {                                                                               \
+    if (!bz_json_extract (GET_BOXED (_future), &local_error, __VA_ARGS__, NULL))  \
+      {                                                                           \
+        g_warning ("Failed to parse flathub response: %s", local_error->message); \
+        return dex_future_new_for_error (g_steal_pointer (&local_error));         \
+      }                                                                           \
+  }                                                                               \
+  G_STMT_END
 
-    object = json_node_get_object (GET_BOXED (passing_f));
-    array  = json_object_get_array_member (object, "apps");
-    length = json_array_get_length (array);
+#define ADD_CATEGORY_OR_RETURN(...)                                               \
+  G_STMT_START                                                                    \
+  {                                                                               \
+    if (!add_category (self, __VA_ARGS__, &local_error))                          \
+      {                                                                           \
+        g_warning ("Failed to parse flathub response: %s", local_error->message); \
+        return dex_future_new_for_error (g_steal_pointer (&local_error));         \
+      }                                                                           \
+  }                                                                               \
+  G_STMT_END
 
-    for (guint i = 0; i < length; i++)
-      {
-        const char *app_id = NULL;
+  {
+    g_auto (BzJsonField) apps = BZ_JSON_FIELD_INIT ("apps[]");
 
-        app_id = json_array_get_string_element (array, i);
-        g_hash_table_replace (quality_set, g_strdup (app_id), NULL);
-      }
+    EXTRACT_OR_RETURN (passing_f, &apps);
+    for (guint i = 0; apps.strings != NULL && i < apps.strings->len; i++)
+      g_hash_table_replace (quality_set, g_strdup (g_ptr_array_index (apps.strings, i)), NULL);
   }
   {
-    JsonObject *object = NULL;
+    g_auto (BzJsonField) app_id = BZ_JSON_FIELD_INIT ("app_id");
 
-    object               = json_node_get_object (GET_BOXED (aotd_f));
-    self->app_of_the_day = g_strdup (json_object_get_string_member (object, "app_id"));
+    EXTRACT_OR_RETURN (aotd_f, &app_id);
+    if (app_id.strings != NULL)
+      self->app_of_the_day = g_strdup (g_ptr_array_index (app_id.strings, 0));
   }
   {
-    JsonObject *object = NULL;
-    JsonArray  *array  = NULL;
-    guint       length = 0;
+    g_auto (BzJsonField) apps = BZ_JSON_FIELD_INIT ("apps[].app_id");
 
-    object = json_node_get_object (GET_BOXED (aotw_f));
-    array  = json_object_get_array_member (object, "apps");
-    length = json_array_get_length (array);
-
-    for (guint i = 0; i < length; i++)
-      {
-        JsonObject *element = NULL;
-
-        element = json_array_get_object_element (array, i);
-        gtk_string_list_append (
-            self->apps_of_the_week,
-            json_object_get_string_member (element, "app_id"));
-      }
+    EXTRACT_OR_RETURN (aotw_f, &apps);
+    for (guint i = 0; apps.strings != NULL && i < apps.strings->len; i++)
+      gtk_string_list_append (self->apps_of_the_week, g_ptr_array_index (apps.strings, i));
   }
 
-  add_category (self, "trending", GET_BOXED (trending_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
-  add_category (self, "popular", GET_BOXED (popular_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
-  add_category (self, "recently-added", GET_BOXED (added_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
-  add_category (self, "recently-updated", GET_BOXED (updated_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
-  add_category (self, "mobile", GET_BOXED (mobile_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
+  ADD_CATEGORY_OR_RETURN ("trending", "/collection/trending", COLLECTION_FETCH_SIZE, GET_BOXED (trending_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
+  ADD_CATEGORY_OR_RETURN ("popular", "/collection/popular", COLLECTION_FETCH_SIZE, GET_BOXED (popular_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
+  ADD_CATEGORY_OR_RETURN ("recently-added", "/collection/recently-added", COLLECTION_FETCH_SIZE, GET_BOXED (added_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
+  ADD_CATEGORY_OR_RETURN ("recently-updated", "/collection/recently-updated", COLLECTION_FETCH_SIZE, GET_BOXED (updated_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
+  ADD_CATEGORY_OR_RETURN ("mobile", "/collection/mobile", COLLECTION_FETCH_SIZE, GET_BOXED (mobile_f), quality_set, FALSE, QUALITY_MODE_NONE, TRUE);
 
   {
-    JsonArray *array                       = NULL;
-    guint      length                      = 0;
+    g_auto (BzJsonField) names             = BZ_JSON_FIELD_INIT ("[]");
+    guint length                           = 0;
     g_autoptr (GPtrArray) category_futures = NULL;
 
-    array  = json_node_get_array (GET_BOXED (categories_f));
-    length = json_array_get_length (array);
+    EXTRACT_OR_RETURN (categories_f, &names);
+    if (names.strings != NULL)
+      length = names.strings->len;
 
     category_futures = g_ptr_array_new_with_free_func (dex_unref);
 
@@ -820,12 +823,12 @@ initialize_fiber (GWeakRef *wr)
         g_autofree char *request     = NULL;
         g_autoptr (DexFuture) future = NULL;
 
-        category = json_array_get_string_element (array, i);
+        category = g_ptr_array_index (names.strings, i);
         request  = g_strdup_printf (
-            "/collection/category/%s?page=0&per_page=%d",
+            "/collection/category/%s?page=1&per_page=%d",
             category, CATEGORY_FETCH_SIZE);
 
-        future = bz_query_flathub_v2_json_take (g_steal_pointer (&request));
+        future = bz_query_flathub_v2_bytes_take (g_steal_pointer (&request));
         result = dex_await (dex_ref (future), &local_error);
         if (!result)
           {
@@ -837,22 +840,26 @@ initialize_fiber (GWeakRef *wr)
 
     for (guint i = 0; i < length; i++)
       {
-        DexFuture  *future = NULL;
-        JsonNode   *node   = NULL;
-        const char *name   = NULL;
+        DexFuture       *future = NULL;
+        const char      *name   = NULL;
+        g_autofree char *route  = NULL;
 
         future = g_ptr_array_index (category_futures, i);
-        node   = GET_BOXED (future);
-        name   = json_array_get_string_element (array, i);
+        name   = g_ptr_array_index (names.strings, i);
+        route  = g_strdup_printf ("/collection/category/%s", name);
 
-        add_category (self, name, node, quality_set, FALSE, QUALITY_MODE_FIRST, FALSE);
+        ADD_CATEGORY_OR_RETURN (name, route, CATEGORY_FETCH_SIZE, GET_BOXED (future), quality_set, FALSE, QUALITY_MODE_FIRST, FALSE);
       }
   }
 
   if (is_kde)
-    add_category (self, "kde", GET_BOXED (toolkit_f), quality_set, FALSE, QUALITY_MODE_RANDOM, FALSE);
+    ADD_CATEGORY_OR_RETURN ("kde", NULL, 0, GET_BOXED (toolkit_f), quality_set, FALSE, QUALITY_MODE_RANDOM, FALSE);
   else if (adwaita_f != NULL)
-    add_category (self, "adwaita", GET_BOXED (adwaita_f), quality_set, TRUE, QUALITY_MODE_RANDOM, FALSE);
+    ADD_CATEGORY_OR_RETURN ("adwaita", NULL, 0, GET_BOXED (adwaita_f), quality_set, TRUE, QUALITY_MODE_RANDOM, FALSE);
+
+#undef ADD_CATEGORY_OR_RETURN
+#undef EXTRACT_OR_RETURN
+#undef GET_BOXED
 
   return dex_future_new_true ();
 }
@@ -892,37 +899,27 @@ search_collection_fiber (char *route)
 {
   g_autoptr (GError) local_error    = NULL;
   g_autoptr (GtkStringList) results = NULL;
-  g_autoptr (JsonNode) node         = NULL;
+  g_autoptr (GBytes) bytes          = NULL;
   g_autofree char *request          = NULL;
-  JsonObject      *object           = NULL;
-  JsonArray       *array            = NULL;
-  guint            length           = 0;
+  g_auto (BzJsonField) apps         = BZ_JSON_FIELD_INIT ("hits[].app_id");
 
   request = g_strdup_printf ("%s&page=1&per_page=%d&locale=en",
                              route, KEYWORD_SEARCH_PAGE_SIZE);
 
-  node = dex_await_boxed (
-      bz_query_flathub_v2_json_take (
+  bytes = dex_await_boxed (
+      bz_query_flathub_v2_bytes_take (
           g_steal_pointer (&request)),
       &local_error);
-  if (node == NULL)
+  if (bytes == NULL)
     return dex_future_new_for_error (g_steal_pointer (&local_error));
 
-  results = gtk_string_list_new (NULL);
-
-  object = json_node_get_object (node);
-  array  = json_object_get_array_member (object, "hits");
-  length = json_array_get_length (array);
+  if (!bz_json_extract (bytes, &local_error, &apps, NULL))
+    return dex_future_new_for_error (g_steal_pointer (&local_error));
 
-  for (guint i = 0; i < length; i++)
-    {
-      JsonObject *element = NULL;
-      const char *app_id  = NULL;
+  results = gtk_string_list_new (NULL);
+  for (guint i = 0; apps.strings != NULL && i < apps.strings->len; i++)
+    gtk_string_list_append (results, g_ptr_array_index (apps.strings, i));
 
-      element = json_array_get_object_element (array, i);
-      app_id  = json_object_get_string_member (element, "app_id");
-      gtk_string_list_append (results, app_id);
-    }
   return dex_future_new_take_object (g_steal_pointer (&results));
 }
 
@@ -994,4 +991,24 @@ clear (BzFlathubState *self)
   self->has_connection_error = FALSE;
 }
 
+static void
+shed_cb (GWeakRef *wr)
+{
+  g_autoptr (BzFlathubState) self = NULL;
+  guint n_categories              = 0;
+
+  self = g_weak_ref_get (wr);
+  if (self == NULL || self->categories == NULL)
+    return;
+
+  n_categories = g_list_model_get_n_items (G_LIST_MODEL (self->categories));
+  for (guint i = 0; i < n_categories; i++)
+    {
+      g_autoptr (BzFlathubCategory) category = NULL;
+
+      category = g_list_model_get_item (G_LIST_MODEL (self->categories), i);
+      bz_flathub_category_trim_pages (category);
+    }
+}
+
 /* End of bz-flathub-state.c */
@@ -46,6 +46,7 @@ struct _BzFlatpakEntry
   char     *flatpak_name;
   char     *flatpak_id;
   char     *flatpak_version;
+  char     *commit;
   char     *application_name;
   char     *application_runtime;
   char     *application_command;
@@ -272,6 +273,8 @@ bz_flatpak_entry_real_serialize (BzSerializable  *serializable,
     g_variant_builder_add (builder, "{sv}", "flatpak-id", g_variant_new_string (self->flatpak_id));
   if (self->flatpak_version != NULL)
     g_variant_builder_add (builder, "{sv}", "flatpak-version", g_variant_new_string (self->flatpak_version));
+  if (self->commit != NULL)
+    g_variant_builder_add (builder, "{sv}", "commit", g_variant_new_string (self->commit));
   if (self->application_name != NULL)
     g_variant_builder_add (builder, "{sv}", "application-name", g_variant_new_string (self->application_name));
   if (self->application_runtime != NULL)
@@ -315,6 +318,8 @@ bz_flatpak_entry_real_deserialize (BzSerializable *serializable,
         self->flatpak_id = g_variant_dup_string (value, NULL);
       else if (g_strcmp0 (key, "flatpak-version") == 0)
         self->flatpak_version = g_variant_dup_string (value, NULL);
+      else if (g_strcmp0 (key, "commit") == 0)
+        self->commit = g_variant_dup_string (value, NULL);
       else if (g_strcmp0 (key, "application-name") == 0)
         self->application_name = g_variant_dup_string (value, NULL);
       else if (g_strcmp0 (key, "application-runtime") == 0)
@@ -488,6 +493,7 @@ bz_flatpak_entry_new_for_ref (FlatpakRef    *ref,
   self->flatpak_name    = g_strdup (flatpak_ref_get_name (ref));
   self->flatpak_id      = flatpak_ref_format_ref (ref);
   self->flatpak_version = g_strdup (flatpak_ref_get_branch (ref));
+  self->commit          = g_strdup (flatpak_ref_get_commit (ref));
 
   id                 = flatpak_ref_get_name (ref);
   unique_id          = bz_flatpak_ref_format_unique (ref, user);
@@ -726,6 +732,13 @@ bz_flatpak_entry_get_flatpak_version (BzFlatpakEntry *self)
   return self->flatpak_version;
 }
 
+const char *
+bz_flatpak_entry_get_commit (BzFlatpakEntry *self)
+{
+  g_return_val_if_fail (BZ_IS_FLATPAK_ENTRY (self), NULL);
+  return self->commit;
+}
+
 const char *
 bz_flatpak_entry_get_application_name (BzFlatpakEntry *self)
 {
@@ -819,6 +832,7 @@ clear_entry (BzFlatpakEntry *self)
   g_clear_pointer (&self->flatpak_name, g_free);
   g_clear_pointer (&self->flatpak_id, g_free);
   g_clear_pointer (&self->flatpak_version, g_free);
+  g_clear_pointer (&self->commit, g_free);
   g_clear_pointer (&self->application_name, g_free);
   g_clear_pointer (&self->application_runtime, g_free);
   g_clear_pointer (&self->application_command, g_free);
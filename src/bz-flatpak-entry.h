@@ -45,6 +45,10 @@ bz_flatpak_entry_get_flatpak_id (BzFlatpakEntry *self);
 const char *
 bz_flatpak_entry_get_flatpak_version (BzFlatpakEntry *self);
 
+/* May be NULL for entries cached before commits were recorded */
+const char *
+bz_flatpak_entry_get_commit (BzFlatpakEntry *self);
+
 const char *
 bz_flatpak_entry_get_application_name (BzFlatpakEntry *self);
 
@@ -21,6 +21,11 @@
 #define G_LOG_DOMAIN  "BAZAAR::FLATPAK"
 #define BAZAAR_MODULE "flatpak"
 
+/* How long a remote which failed to synchronize is left alone, doubling with
+   each consecutive failure */
+#define REMOTE_BACKOFF_BASE (G_TIME_SPAN_MINUTE * 1)
+#define REMOTE_BACKOFF_MAX  (G_TIME_SPAN_HOUR * 6)
+
 #include <malloc.h>
 #include <xmlb.h>
 
@@ -28,11 +33,12 @@
 
 #include "bz-backend-notification.h"
 #include "bz-backend-transaction-op-payload.h"
-#include "bz-backend-transaction-op-progress-payload.h"
+#include "bz-backend-transaction-progress-ring.h"
 #include "bz-backend.h"
 #include "bz-env.h"
 #include "bz-flatpak-private.h"
 #include "bz-global-net.h"
+#include "bz-install-plan.h"
 #include "bz-io.h"
 #include "bz-repository.h"
 #include "bz-util.h"
@@ -64,6 +70,14 @@ struct _BzFlatpakInstance
   GMutex transactions_mutex;
   /* BzEntry* -> GPtrArray* -> GCancellable* */
   GHashTable *ongoing_cancellables;
+
+  GMutex appdata_mutex;
+  /* char* -> CachedAppdataData* */
+  GHashTable *appdata_cache;
+
+  GMutex freshness_mutex;
+  /* char* -> RemoteFreshnessData* */
+  GHashTable *remote_freshness;
 };
 
 static void
@@ -130,9 +144,11 @@ BZ_DEFINE_DATA (
       GWeakRef     *self;
       GCancellable *cancellable;
       guint         total;
+      GHashTable   *appdata_seen;
     },
     BZ_RELEASE_DATA (self, bz_weak_release);
-    BZ_RELEASE_DATA (cancellable, g_object_unref));
+    BZ_RELEASE_DATA (cancellable, g_object_unref);
+    BZ_RELEASE_DATA (appdata_seen, g_hash_table_unref));
 static DexFuture *
 retrieve_remote_refs_fiber (GatherRefsData *data);
 static DexFuture *
@@ -153,6 +169,18 @@ BZ_DEFINE_DATA (
 static DexFuture *
 list_repositories_fiber (ListReposData *data);
 
+BZ_DEFINE_DATA (
+    remote_freshness,
+    RemoteFreshness,
+    {
+      char  *summary_checksum;
+      char  *appstream_checksum;
+      guint  n_failures;
+      gint64 retry_after;
+    },
+    BZ_RELEASE_DATA (summary_checksum, g_free);
+    BZ_RELEASE_DATA (appstream_checksum, g_free));
+
 BZ_DEFINE_DATA (
     retrieve_refs_for_remote,
     RetrieveRefsForRemote,
@@ -160,13 +188,40 @@ BZ_DEFINE_DATA (
       GatherRefsData      *parent;
       FlatpakInstallation *installation;
       FlatpakRemote       *remote;
+      RemoteFreshnessData *freshness;
+      gboolean             unchanged;
     },
     BZ_RELEASE_DATA (parent, gather_refs_data_unref);
     BZ_RELEASE_DATA (installation, g_object_unref);
-    BZ_RELEASE_DATA (remote, g_object_unref));
+    BZ_RELEASE_DATA (remote, g_object_unref);
+    BZ_RELEASE_DATA (freshness, remote_freshness_data_unref));
 static DexFuture *
 retrieve_refs_for_remote_fiber (RetrieveRefsForRemoteData *data);
 
+BZ_DEFINE_DATA (
+    cached_appdata,
+    CachedAppdata,
+    {
+      char        *commit;
+      AsComponent *component;
+    },
+    BZ_RELEASE_DATA (commit, g_free);
+    BZ_RELEASE_DATA (component, g_object_unref));
+
+BZ_DEFINE_DATA (
+    load_installed_appdata,
+    LoadInstalledAppdata,
+    {
+      RetrieveRefsForRemoteData *parent;
+      FlatpakInstalledRef       *iref;
+      BzFlatpakEntry            *entry;
+    },
+    BZ_RELEASE_DATA (parent, retrieve_refs_for_remote_data_unref);
+    BZ_RELEASE_DATA (iref, g_object_unref);
+    BZ_RELEASE_DATA (entry, g_object_unref));
+static DexFuture *
+load_installed_appdata_fiber (LoadInstalledAppdataData *data);
+
 static void
 gather_refs_update_progress (const char     *status,
                              guint           progress,
@@ -188,6 +243,9 @@ BZ_DEFINE_DATA (
       GHashTable   *ref_to_entry_hash;
       GHashTable   *op_to_progress_hash;
       guint         unidentified_op_cnt;
+      guint         next_op_id;
+
+      BzBackendTransactionProgressRing *progress_ring;
     },
     BZ_RELEASE_DATA (self, bz_weak_release);
     g_mutex_clear (&self->mutex);
@@ -198,7 +256,8 @@ BZ_DEFINE_DATA (
     BZ_RELEASE_DATA (channel, dex_unref);
     BZ_RELEASE_DATA (send_futures, g_ptr_array_unref);
     BZ_RELEASE_DATA (ref_to_entry_hash, g_hash_table_unref);
-    BZ_RELEASE_DATA (op_to_progress_hash, g_hash_table_unref));
+    BZ_RELEASE_DATA (op_to_progress_hash, g_hash_table_unref);
+    BZ_RELEASE_DATA (progress_ring, g_object_unref));
 static DexFuture *
 transaction_fiber (TransactionData *data);
 
@@ -214,6 +273,50 @@ BZ_DEFINE_DATA (
 static DexFuture *
 transaction_job_fiber (TransactionJobData *data);
 
+BZ_DEFINE_DATA (
+    stage_updates,
+    StageUpdates,
+    {
+      GWeakRef     *self;
+      GCancellable *cancellable;
+      GPtrArray    *updates;
+      guint64       byte_budget;
+      guint64       n_bytes;
+    },
+    BZ_RELEASE_DATA (self, bz_weak_release);
+    BZ_RELEASE_DATA (cancellable, g_object_unref);
+    BZ_RELEASE_DATA (updates, g_ptr_array_unref));
+static DexFuture *
+stage_updates_fiber (StageUpdatesData *data);
+
+static gboolean
+stage_updates_ready (FlatpakTransaction *object,
+                     StageUpdatesData   *data);
+
+BZ_DEFINE_DATA (
+    plan_installs,
+    PlanInstalls,
+    {
+      GWeakRef      *self;
+      GCancellable  *cancellable;
+      GPtrArray     *installs;
+      GHashTable    *requested;
+      GHashTable    *seen;
+      BzInstallPlan *plan;
+    },
+    BZ_RELEASE_DATA (self, bz_weak_release);
+    BZ_RELEASE_DATA (cancellable, g_object_unref);
+    BZ_RELEASE_DATA (installs, g_ptr_array_unref);
+    BZ_RELEASE_DATA (requested, g_hash_table_unref);
+    BZ_RELEASE_DATA (seen, g_hash_table_unref);
+    BZ_RELEASE_DATA (plan, g_object_unref));
+static DexFuture *
+plan_installs_fiber (PlanInstallsData *data);
+
+static gboolean
+plan_installs_ready (FlatpakTransaction *object,
+                     PlanInstallsData   *data);
+
 static void
 transaction_new_operation (FlatpakTransaction          *object,
                            FlatpakTransactionOperation *operation,
@@ -246,6 +349,7 @@ BZ_DEFINE_DATA (
       TransactionData               *parent;
       BzFlatpakEntry                *entry;
       BzBackendTransactionOpPayload *op;
+      guint                          op_id;
     },
     BZ_RELEASE_DATA (parent, transaction_data_unref);
     BZ_RELEASE_DATA (entry, g_object_unref);
@@ -330,6 +434,14 @@ static AsComponent *
 extract_first_component_for_silo (XbSilo  *silo,
                                   GError **error);
 
+static AsComponent *
+load_component_for_installed_ref (FlatpakInstalledRef *iref,
+                                  GCancellable        *cancellable,
+                                  GError             **error);
+
+static char *
+checksum_remote_refs (GPtrArray *refs);
+
 static void
 bz_flatpak_instance_dispose (GObject *object)
 {
@@ -351,6 +463,12 @@ bz_flatpak_instance_dispose (GObject *object)
   g_clear_pointer (&self->ongoing_cancellables, g_hash_table_unref);
   g_mutex_clear (&self->transactions_mutex);
 
+  g_clear_pointer (&self->appdata_cache, g_hash_table_unref);
+  g_mutex_clear (&self->appdata_mutex);
+
+  g_clear_pointer (&self->remote_freshness, g_hash_table_unref);
+  g_mutex_clear (&self->freshness_mutex);
+
   G_OBJECT_CLASS (bz_flatpak_instance_parent_class)->dispose (object);
 }
 
@@ -377,6 +495,14 @@ bz_flatpak_instance_init (BzFlatpakInstance *self)
   self->ongoing_cancellables = g_hash_table_new_full (
       g_direct_hash, g_direct_equal, g_object_unref, (GDestroyNotify) g_ptr_array_unref);
   g_mutex_init (&self->transactions_mutex);
+
+  self->appdata_cache = g_hash_table_new_full (
+      g_str_hash, g_str_equal, g_free, cached_appdata_data_unref);
+  g_mutex_init (&self->appdata_mutex);
+
+  self->remote_freshness = g_hash_table_new_full (
+      g_str_hash, g_str_equal, g_free, remote_freshness_data_unref);
+  g_mutex_init (&self->freshness_mutex);
 }
 
 static DexChannel *
@@ -545,6 +671,7 @@ bz_flatpak_instance_schedule_transaction (BzBackend    *backend,
   data->send_futures        = g_ptr_array_new_with_free_func (dex_unref);
   data->ref_to_entry_hash   = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
   data->op_to_progress_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+  data->progress_ring       = channel != NULL ? bz_backend_transaction_progress_ring_new () : NULL;
   g_mutex_init (&data->mutex);
 
   return dex_scheduler_spawn (
@@ -580,6 +707,67 @@ bz_flatpak_instance_cancel_task_for_entry (BzBackend *backend,
   return TRUE;
 }
 
+static DexFuture *
+bz_flatpak_instance_stage_updates (BzBackend    *backend,
+                                   BzEntry     **updates,
+                                   guint         n_updates,
+                                   guint64       byte_budget,
+                                   GCancellable *cancellable)
+{
+  BzFlatpakInstance *self           = BZ_FLATPAK_INSTANCE (backend);
+  g_autoptr (StageUpdatesData) data = NULL;
+
+  for (guint i = 0; i < n_updates; i++)
+    dex_return_error_if_fail (BZ_IS_FLATPAK_ENTRY (updates[i]));
+
+  data              = stage_updates_data_new ();
+  data->self        = bz_track_weak (self);
+  data->cancellable = bz_object_maybe_ref (cancellable);
+  data->updates     = g_ptr_array_new_with_free_func (g_object_unref);
+  data->byte_budget = byte_budget;
+
+  for (guint i = 0; i < n_updates; i++)
+    g_ptr_array_add (data->updates, g_object_ref (updates[i]));
+
+  return dex_scheduler_spawn (
+      self->scheduler,
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) stage_updates_fiber,
+      stage_updates_data_ref (data),
+      stage_updates_data_unref);
+}
+
+static DexFuture *
+bz_flatpak_instance_plan_installs (BzBackend    *backend,
+                                   BzEntry     **installs,
+                                   guint         n_installs,
+                                   GCancellable *cancellable)
+{
+  BzFlatpakInstance *self           = BZ_FLATPAK_INSTANCE (backend);
+  g_autoptr (PlanInstallsData) data = NULL;
+
+  for (guint i = 0; i < n_installs; i++)
+    dex_return_error_if_fail (BZ_IS_FLATPAK_ENTRY (installs[i]));
+
+  data              = plan_installs_data_new ();
+  data->self        = bz_track_weak (self);
+  data->cancellable = bz_object_maybe_ref (cancellable);
+  data->installs    = g_ptr_array_new_with_free_func (g_object_unref);
+  data->requested   = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  data->seen        = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  data->plan        = bz_install_plan_new ();
+
+  for (guint i = 0; i < n_installs; i++)
+    g_ptr_array_add (data->installs, g_object_ref (installs[i]));
+
+  return dex_scheduler_spawn (
+      self->scheduler,
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) plan_installs_fiber,
+      plan_installs_data_ref (data),
+      plan_installs_data_unref);
+}
+
 static void
 backend_iface_init (BzBackendInterface *iface)
 {
@@ -591,6 +779,8 @@ backend_iface_init (BzBackendInterface *iface)
   iface->list_repositories           = bz_flatpak_instance_list_repositories;
   iface->schedule_transaction        = bz_flatpak_instance_schedule_transaction;
   iface->cancel_task_for_entry       = bz_flatpak_instance_cancel_task_for_entry;
+  iface->stage_updates               = bz_flatpak_instance_stage_updates;
+  iface->plan_installs               = bz_flatpak_instance_plan_installs;
 }
 
 FlatpakInstallation *
@@ -642,6 +832,24 @@ bz_flatpak_instance_has_flathub (BzFlatpakInstance *self,
       check_has_flathub_data_ref (data), check_has_flathub_data_unref);
 }
 
+void
+bz_flatpak_instance_reset_backoff (BzFlatpakInstance *self)
+{
+  GHashTableIter       iter      = { 0 };
+  RemoteFreshnessData *freshness = NULL;
+
+  g_return_if_fail (BZ_IS_FLATPAK_INSTANCE (self));
+
+  g_mutex_lock (&self->freshness_mutex);
+  g_hash_table_iter_init (&iter, self->remote_freshness);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &freshness))
+    {
+      freshness->n_failures  = 0;
+      freshness->retry_after = 0;
+    }
+  g_mutex_unlock (&self->freshness_mutex);
+}
+
 DexFuture *
 bz_flatpak_instance_ensure_has_flathub (BzFlatpakInstance *self,
                                         GCancellable      *cancellable)
@@ -1049,9 +1257,11 @@ retrieve_remote_refs_fiber (GatherRefsData *data)
   g_autoptr (GHashTable) blocked_names_hash = NULL;
   g_autoptr (GPtrArray) jobs                = NULL;
   g_autoptr (GPtrArray) job_names           = NULL;
+  g_autoptr (GPtrArray) job_datas           = NULL;
   g_autoptr (DexFuture) future              = NULL;
   gboolean result                           = FALSE;
   g_autoptr (GString) error_string          = NULL;
+  gboolean any_unchanged                    = FALSE;
 
   bz_weak_get_or_return_reject (self, data->self);
 
@@ -1086,12 +1296,18 @@ retrieve_remote_refs_fiber (GatherRefsData *data)
 
   jobs      = g_ptr_array_new_with_free_func (dex_unref);
   job_names = g_ptr_array_new_with_free_func (g_free);
+  job_datas = g_ptr_array_new_with_free_func (retrieve_refs_for_remote_data_unref);
+
+  /* Guarded by appdata_mutex */
+  data->appdata_seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
   for (guint i = 0; i < n_system_remotes + n_user_remotes; i++)
     {
       FlatpakInstallation *installation              = NULL;
       FlatpakRemote       *remote                    = NULL;
       const char          *name                      = NULL;
+      g_autofree char     *freshness_key             = NULL;
+      RemoteFreshnessData *freshness                 = NULL;
       g_autoptr (RetrieveRefsForRemoteData) job_data = NULL;
       g_autoptr (DexFuture) job_future               = NULL;
 
@@ -1106,12 +1322,25 @@ retrieve_remote_refs_fiber (GatherRefsData *data)
           remote       = g_ptr_array_index (user_remotes, i - n_system_remotes);
         }
 
-      name = flatpak_remote_get_name (remote);
+      name          = flatpak_remote_get_name (remote);
+      freshness_key = g_strdup_printf (
+          "%s:%s", installation == self->user ? "user" : "system", name);
+
+      g_mutex_lock (&self->freshness_mutex);
+      freshness = g_hash_table_lookup (self->remote_freshness, freshness_key);
+      if (freshness == NULL)
+        {
+          freshness = remote_freshness_data_new ();
+          g_hash_table_replace (self->remote_freshness, g_strdup (freshness_key), freshness);
+        }
+      freshness = remote_freshness_data_ref (freshness);
+      g_mutex_unlock (&self->freshness_mutex);
 
       job_data               = retrieve_refs_for_remote_data_new ();
       job_data->parent       = gather_refs_data_ref (data);
       job_data->installation = g_object_ref (installation);
       job_data->remote       = g_object_ref (remote);
+      job_data->freshness    = freshness;
 
       job_future = dex_scheduler_spawn (
           self->scheduler,
@@ -1122,6 +1351,7 @@ retrieve_remote_refs_fiber (GatherRefsData *data)
 
       g_ptr_array_add (jobs, g_steal_pointer (&job_future));
       g_ptr_array_add (job_names, g_strdup (name));
+      g_ptr_array_add (job_datas, g_steal_pointer (&job_data));
     }
 
   if (jobs->len == 0)
@@ -1133,14 +1363,35 @@ retrieve_remote_refs_fiber (GatherRefsData *data)
                       NULL);
   if (!result)
     error_string = g_string_new ("No remotes could be synchronized:\n\n");
+  else
+    {
+      GHashTableIter iter = { 0 };
+      const char    *key  = NULL;
+
+      /* Only a complete gather knows every installed ref, otherwise
+       * appdata for refs which weren't reached would be thrown away */
+      g_mutex_lock (&self->appdata_mutex);
+      g_hash_table_iter_init (&iter, self->appdata_cache);
+      while (g_hash_table_iter_next (&iter, (gpointer *) &key, NULL))
+        {
+          if (!g_hash_table_contains (data->appdata_seen, key))
+            g_hash_table_iter_remove (&iter);
+        }
+      g_mutex_unlock (&self->appdata_mutex);
+    }
 
   for (guint i = 0; i < jobs->len; i++)
     {
-      DexFuture *job_future = NULL;
-      char      *name       = NULL;
+      DexFuture                 *job_future = NULL;
+      char                      *name       = NULL;
+      RetrieveRefsForRemoteData *job_data   = NULL;
 
       job_future = g_ptr_array_index (jobs, i);
       name       = g_ptr_array_index (job_names, i);
+      job_data   = g_ptr_array_index (job_datas, i);
+
+      if (job_data->unchanged)
+        any_unchanged = TRUE;
 
       dex_future_get_value (job_future, &local_error);
       if (local_error != NULL)
@@ -1152,6 +1403,17 @@ retrieve_remote_refs_fiber (GatherRefsData *data)
       g_clear_pointer (&local_error, g_error_free);
     }
 
+  if (any_unchanged)
+    {
+      g_autoptr (BzBackendNotification) notif = NULL;
+
+      /* Entries from remotes which were skipped are still current, but their
+       * installed state may not be, so have the receiver diff it */
+      notif = bz_backend_notification_new ();
+      bz_backend_notification_set_kind (notif, BZ_BACKEND_NOTIFICATION_KIND_EXTERNAL_CHANGE);
+      send_notif_all (self, notif, TRUE);
+    }
+
   if (result)
     {
       if (error_string != NULL)
@@ -1195,6 +1457,10 @@ retrieve_refs_for_enumerable_remote (RetrieveRefsForRemoteData *data,
   g_autoptr (GPtrArray) children        = NULL;
   g_autoptr (GHashTable) component_hash = NULL;
   g_autoptr (GPtrArray) refs            = NULL;
+  g_autoptr (GBytes) appstream_bytes    = NULL;
+  g_autofree char *appstream_checksum   = NULL;
+  g_autofree char *summary_checksum     = NULL;
+  gboolean         unchanged            = FALSE;
 
   bz_weak_get_or_return_reject (self, data->parent->self);
 
@@ -1252,6 +1518,43 @@ retrieve_refs_for_enumerable_remote (RetrieveRefsForRemoteData *data,
 
   appstream_xml = g_file_new_for_path (appstream_xml_path);
 
+  appstream_bytes = g_file_load_bytes (appstream_xml, cancellable, NULL, &local_error);
+  if (appstream_bytes == NULL)
+    SEND_AND_RETURN_ERROR (
+        self, TRUE,
+        BZ_FLATPAK_ERROR_IO_MISBEHAVIOR,
+        "Failed to read appstream bundle download at path %s for remote '%s': %s",
+        appstream_xml_path,
+        remote_name,
+        local_error->message);
+  appstream_checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, appstream_bytes);
+  g_clear_pointer (&appstream_bytes, g_bytes_unref);
+
+  refs = flatpak_installation_list_remote_refs_sync (
+      installation, remote_name, cancellable, &local_error);
+  if (refs == NULL)
+    SEND_AND_RETURN_ERROR (
+        self, TRUE,
+        BZ_FLATPAK_ERROR_REMOTE_SYNCHRONIZATION_FAILURE,
+        "Failed to enumerate refs for remote '%s': %s",
+        remote_name,
+        local_error->message);
+  summary_checksum = checksum_remote_refs (refs);
+
+  g_mutex_lock (&self->freshness_mutex);
+  unchanged = g_strcmp0 (data->freshness->summary_checksum, summary_checksum) == 0 &&
+              g_strcmp0 (data->freshness->appstream_checksum, appstream_checksum) == 0;
+  g_mutex_unlock (&self->freshness_mutex);
+
+  if (unchanged)
+    {
+      g_debug ("Remote '%s' is unchanged since the last synchronization, "
+               "skipping ingestion of %u refs",
+               remote_name, refs->len);
+      data->unchanged = TRUE;
+      return dex_future_new_true ();
+    }
+
   source = xb_builder_source_new ();
   result = xb_builder_source_load_file (
       source,
@@ -1321,16 +1624,6 @@ retrieve_refs_for_enumerable_remote (RetrieveRefsForRemoteData *data,
       g_hash_table_replace (component_hash, (gpointer) id, component);
     }
 
-  refs = flatpak_installation_list_remote_refs_sync (
-      installation, remote_name, cancellable, &local_error);
-  if (refs == NULL)
-    SEND_AND_RETURN_ERROR (
-        self, TRUE,
-        BZ_FLATPAK_ERROR_REMOTE_SYNCHRONIZATION_FAILURE,
-        "Failed to enumerate refs for remote '%s': %s",
-        remote_name,
-        local_error->message);
-
   {
     g_autoptr (BzBackendNotification) notif = NULL;
 
@@ -1395,6 +1688,13 @@ retrieve_refs_for_enumerable_remote (RetrieveRefsForRemoteData *data,
         }
     }
 
+  g_mutex_lock (&self->freshness_mutex);
+  g_clear_pointer (&data->freshness->summary_checksum, g_free);
+  data->freshness->summary_checksum = g_steal_pointer (&summary_checksum);
+  g_clear_pointer (&data->freshness->appstream_checksum, g_free);
+  data->freshness->appstream_checksum = g_steal_pointer (&appstream_checksum);
+  g_mutex_unlock (&self->freshness_mutex);
+
   return dex_future_new_true ();
 }
 
@@ -1408,7 +1708,8 @@ retrieve_refs_for_noenumerable_remote (RetrieveRefsForRemoteData *data,
   GCancellable *cancellable            = data->parent->cancellable;
   g_autoptr (GError) local_error       = NULL;
   g_autoptr (GPtrArray) installed_apps = NULL;
-  guint matched                        = 0;
+  g_autoptr (GPtrArray) jobs           = NULL;
+  g_autoptr (GPtrArray) job_datas      = NULL;
 
   bz_weak_get_or_return_reject (self, data->parent->self);
 
@@ -1429,13 +1730,17 @@ retrieve_refs_for_noenumerable_remote (RetrieveRefsForRemoteData *data,
   g_debug ("Found %u total installed apps, filtering for remote '%s'",
            installed_apps->len, remote_name);
 
+  jobs      = g_ptr_array_new_with_free_func (dex_unref);
+  job_datas = g_ptr_array_new_with_free_func (load_installed_appdata_data_unref);
+
+  /* Loading appdata means decompressing and compiling a silo for every single
+   * app, so spread the work across the thread pool */
   for (guint i = 0; i < installed_apps->len; i++)
     {
-      FlatpakInstalledRef *iref         = NULL;
-      const char          *ref_origin   = NULL;
-      g_autoptr (AsComponent) component = NULL;
-      g_autoptr (BzFlatpakEntry) entry  = NULL;
-      g_autoptr (GBytes) appstream_gz   = NULL;
+      FlatpakInstalledRef *iref                     = NULL;
+      const char          *ref_origin               = NULL;
+      g_autoptr (LoadInstalledAppdataData) job_data = NULL;
+      g_autoptr (DexFuture) job_future              = NULL;
 
       iref       = g_ptr_array_index (installed_apps, i);
       ref_origin = flatpak_installed_ref_get_origin (iref);
@@ -1443,79 +1748,52 @@ retrieve_refs_for_noenumerable_remote (RetrieveRefsForRemoteData *data,
       if (g_strcmp0 (ref_origin, remote_name) != 0)
         continue;
 
-      matched++;
+      job_data         = load_installed_appdata_data_new ();
+      job_data->parent = retrieve_refs_for_remote_data_ref (data);
+      job_data->iref   = g_object_ref (iref);
 
-      appstream_gz = flatpak_installed_ref_load_appdata (iref, cancellable, NULL);
-      if (appstream_gz != NULL)
-        {
-          g_autoptr (GBytes) appstream       = NULL;
-          g_autoptr (XbBuilderSource) source = NULL;
-          g_autoptr (XbSilo) silo            = NULL;
-          g_autoptr (GError) appstream_error = NULL;
-
-          appstream = decompress_appstream_gz (appstream_gz, cancellable, &appstream_error);
-          if (appstream == NULL)
-            {
-              g_info ("Could not decompress appstream for installed ref: %s",
-                      appstream_error ? appstream_error->message : "unknown error");
-              goto create_entry;
-            }
+      job_future = dex_scheduler_spawn (
+          self->scheduler,
+          bz_get_dex_stack_size (),
+          (DexFiberFunc) load_installed_appdata_fiber,
+          load_installed_appdata_data_ref (job_data),
+          load_installed_appdata_data_unref);
 
-          source = xb_builder_source_new ();
-          if (!xb_builder_source_load_bytes (source, appstream,
-                                             XB_BUILDER_SOURCE_FLAG_LITERAL_TEXT,
-                                             &appstream_error))
-            {
-              g_info ("Could not load appstream bytes: %s",
-                      appstream_error ? appstream_error->message : "unknown error");
-              goto create_entry;
-            }
+      g_ptr_array_add (jobs, g_steal_pointer (&job_future));
+      g_ptr_array_add (job_datas, g_steal_pointer (&job_data));
+    }
 
-          silo = build_silo (source, cancellable, &appstream_error);
-          if (silo == NULL)
-            {
-              g_info ("Could not build silo from appstream: %s",
-                      appstream_error ? appstream_error->message : "unknown error");
-              goto create_entry;
-            }
+  g_debug ("Found %u installed apps from non-enumerable remote '%s'", jobs->len, remote_name);
 
-          component = extract_first_component_for_silo (silo, &appstream_error);
-          if (component == NULL)
-            {
-              g_info ("Could not parse appstream component: %s",
-                      appstream_error ? appstream_error->message : "unknown error");
-            }
-        }
+  if (jobs->len > 0)
+    dex_await (dex_future_allv (
+                   (DexFuture *const *) jobs->pdata,
+                   jobs->len),
+               NULL);
 
-    create_entry:
-      entry = bz_flatpak_entry_new_for_ref (
-          FLATPAK_REF (iref),
-          remote,
-          installation == self->user,
-          component,
-          NULL,
-          NULL);
+  for (guint i = 0; i < job_datas->len; i++)
+    {
+      LoadInstalledAppdataData *job_data = NULL;
 
-      if (entry != NULL)
+      job_data = g_ptr_array_index (job_datas, i);
+      if (job_data->entry != NULL)
         {
           g_autoptr (BzBackendNotification) notif = NULL;
 
           notif = bz_backend_notification_new ();
           bz_backend_notification_set_kind (notif, BZ_BACKEND_NOTIFICATION_KIND_REPLACE_ENTRY);
-          bz_backend_notification_set_entry (notif, BZ_ENTRY (entry));
+          bz_backend_notification_set_entry (notif, BZ_ENTRY (job_data->entry));
 
           send_notif_all (self, notif, TRUE);
         }
     }
 
-  g_debug ("Found %u installed apps from non-enumerable remote '%s'", matched, remote_name);
-
   {
     g_autoptr (BzBackendNotification) notif = NULL;
 
     notif = bz_backend_notification_new ();
     bz_backend_notification_set_kind (notif, BZ_BACKEND_NOTIFICATION_KIND_TELL_INCOMING);
-    bz_backend_notification_set_n_incoming (notif, matched);
+    bz_backend_notification_set_n_incoming (notif, jobs->len);
 
     send_notif_all (self, notif, TRUE);
   }
@@ -1523,14 +1801,91 @@ retrieve_refs_for_noenumerable_remote (RetrieveRefsForRemoteData *data,
   return dex_future_new_true ();
 }
 
+static DexFuture *
+load_installed_appdata_fiber (LoadInstalledAppdataData *data)
+{
+  g_autoptr (BzFlatpakInstance) self = NULL;
+  GCancellable        *cancellable   = data->parent->parent->cancellable;
+  FlatpakInstallation *installation  = data->parent->installation;
+  FlatpakInstalledRef *iref          = data->iref;
+  gboolean             user          = FALSE;
+  g_autofree char     *key           = NULL;
+  const char          *commit        = NULL;
+  CachedAppdataData   *cached        = NULL;
+  g_autoptr (AsComponent) component  = NULL;
+
+  bz_weak_get_or_return_reject (self, data->parent->parent->self);
+
+  user   = installation == self->user;
+  key    = bz_flatpak_ref_format_unique (FLATPAK_REF (iref), user);
+  commit = flatpak_ref_get_commit (FLATPAK_REF (iref));
+
+  g_mutex_lock (&self->appdata_mutex);
+  g_hash_table_add (data->parent->parent->appdata_seen, g_strdup (key));
+  cached = g_hash_table_lookup (self->appdata_cache, key);
+  if (cached != NULL && g_strcmp0 (cached->commit, commit) == 0)
+    cached = cached_appdata_data_ref (cached);
+  else
+    cached = NULL;
+  g_mutex_unlock (&self->appdata_mutex);
+
+  if (cached != NULL)
+    {
+      component = bz_object_maybe_ref (cached->component);
+      cached_appdata_data_unref (cached);
+    }
+  else
+    {
+      g_autoptr (GError) local_error           = NULL;
+      g_autoptr (CachedAppdataData) new_cached = NULL;
+
+      component = load_component_for_installed_ref (iref, cancellable, &local_error);
+      if (local_error != NULL)
+        {
+          /* Might work next time, so leave the cache alone */
+          if (!g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_info ("Could not load appdata for %s: %s", key, local_error->message);
+          goto done;
+        }
+
+      /* Cache definite misses too, so apps without appdata are not retried
+       * until their deployed commit changes */
+      new_cached            = cached_appdata_data_new ();
+      new_cached->commit    = g_strdup (commit);
+      new_cached->component = bz_object_maybe_ref (component);
+
+      g_mutex_lock (&self->appdata_mutex);
+      g_hash_table_replace (
+          self->appdata_cache,
+          g_strdup (key),
+          g_steal_pointer (&new_cached));
+      g_mutex_unlock (&self->appdata_mutex);
+    }
+
+done:
+  data->entry = bz_flatpak_entry_new_for_ref (
+      FLATPAK_REF (iref),
+      data->parent->remote,
+      user,
+      component,
+      NULL,
+      NULL);
+
+  return dex_future_new_true ();
+}
+
 static DexFuture *
 retrieve_refs_for_remote_fiber (RetrieveRefsForRemoteData *data)
 {
   FlatpakInstallation *installation   = data->installation;
   FlatpakRemote       *remote         = data->remote;
+  RemoteFreshnessData *freshness      = data->freshness;
   const char          *remote_name    = NULL;
   gboolean             is_noenumerate = FALSE;
   g_autoptr (BzFlatpakInstance) self  = NULL;
+  gint64                now           = 0;
+  gint64                retry_after   = 0;
+  g_autoptr (DexFuture) future        = NULL;
 
   bz_weak_get_or_return_reject (self, data->parent->self);
 
@@ -1547,8 +1902,49 @@ retrieve_refs_for_remote_fiber (RetrieveRefsForRemoteData *data)
   if (is_noenumerate)
 #endif
     return retrieve_refs_for_noenumerable_remote (data, remote_name, installation, remote);
+
+  now = g_get_monotonic_time ();
+  g_mutex_lock (&self->freshness_mutex);
+  retry_after = freshness->retry_after;
+  g_mutex_unlock (&self->freshness_mutex);
+
+  if (now < retry_after)
+    {
+      g_info ("Remote '%s' failed to synchronize recently, "
+              "not trying again for another %" G_GINT64_FORMAT " seconds",
+              remote_name, (retry_after - now) / G_TIME_SPAN_SECOND);
+      data->unchanged = TRUE;
+      return dex_future_new_true ();
+    }
+
+  future = retrieve_refs_for_enumerable_remote (data, remote_name, installation, remote);
+
+  g_mutex_lock (&self->freshness_mutex);
+  if (dex_future_is_rejected (future))
+    {
+      g_autoptr (GError) local_error = NULL;
+      GTimeSpan backoff              = REMOTE_BACKOFF_MAX;
+
+      /* Being cancelled says nothing about the remote */
+      dex_future_get_value (future, &local_error);
+      if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        goto done;
+
+      freshness->n_failures++;
+      if (freshness->n_failures < 16)
+        backoff = MIN (REMOTE_BACKOFF_BASE << (freshness->n_failures - 1), REMOTE_BACKOFF_MAX);
+      freshness->retry_after = now + backoff;
+    }
   else
-    return retrieve_refs_for_enumerable_remote (data, remote_name, installation, remote);
+    {
+      freshness->n_failures  = 0;
+      freshness->retry_after = 0;
+    }
+
+done:
+  g_mutex_unlock (&self->freshness_mutex);
+
+  return g_steal_pointer (&future);
 }
 
 static DexFuture *
@@ -2216,6 +2612,7 @@ transaction_new_operation (FlatpakTransaction          *transaction,
   BzFlatpakEntry                 *entry               = NULL;
   g_autoptr (BzBackendTransactionOpPayload) payload   = NULL;
   g_autoptr (TransactionOperationData) operation_data = NULL;
+  guint op_id                                         = 0;
 
   bz_weak_get_or_return (self, data->self);
 
@@ -2251,6 +2648,10 @@ transaction_new_operation (FlatpakTransaction          *transaction,
       payload, flatpak_transaction_operation_get_installed_size (operation));
 
   g_mutex_lock (&data->mutex);
+  /* Progress ticks refer back to this payload by ID, see
+     transaction_progress_changed () */
+  op_id = ++data->next_op_id;
+  bz_backend_transaction_op_payload_set_op_id (payload, op_id);
   g_ptr_array_add (
       data->send_futures,
       dex_channel_send (
@@ -2268,6 +2669,7 @@ transaction_new_operation (FlatpakTransaction          *transaction,
   operation_data->parent = transaction_data_ref (data);
   operation_data->entry  = bz_object_maybe_ref (entry);
   operation_data->op     = g_object_ref (payload);
+  operation_data->op_id  = op_id;
 
   g_signal_connect_data (
       progress, "changed",
@@ -2438,6 +2840,318 @@ transaction_ready (FlatpakTransaction *object,
   return TRUE;
 }
 
+static DexFuture *
+stage_updates_fiber (StageUpdatesData *data)
+{
+  g_autoptr (BzFlatpakInstance) self              = NULL;
+  GCancellable *cancellable                       = data->cancellable;
+  GPtrArray    *updates                           = data->updates;
+  g_autoptr (GError) local_error                  = NULL;
+  g_autoptr (FlatpakTransaction) user_transaction = NULL;
+  g_autoptr (FlatpakTransaction) sys_transaction  = NULL;
+  FlatpakTransaction *transactions[2]             = { 0 };
+
+  bz_weak_get_or_return_reject (self, data->self);
+
+  for (guint i = 0; i < updates->len; i++)
+    {
+      BzFlatpakEntry      *entry        = NULL;
+      gboolean             is_user      = FALSE;
+      FlatpakInstallation *installation = NULL;
+      FlatpakTransaction **transaction  = NULL;
+      g_autofree char     *ref_fmt      = NULL;
+      gboolean             result       = FALSE;
+
+      entry        = g_ptr_array_index (updates, i);
+      is_user      = bz_flatpak_entry_is_user (entry);
+      installation = is_user ? self->user : self->system;
+      transaction  = is_user ? &user_transaction : &sys_transaction;
+      ref_fmt      = flatpak_ref_format_ref (bz_flatpak_entry_get_ref (entry));
+
+      if (installation == NULL)
+        continue;
+
+      if (*transaction == NULL)
+        {
+          *transaction = flatpak_transaction_new_for_installation (
+              installation, cancellable, &local_error);
+          if (*transaction == NULL)
+            return dex_future_new_reject (
+                BZ_FLATPAK_ERROR,
+                BZ_FLATPAK_ERROR_TRANSACTION_FAILURE,
+                "Failed to initialize staging transaction for installation: %s",
+                local_error->message);
+
+          /* Only pull the new commits into the local repo. Deploying is left
+             to the regular update transaction, which will then find
+             everything it needs already present. */
+          flatpak_transaction_set_no_deploy (*transaction, TRUE);
+          g_signal_connect (*transaction, "ready", G_CALLBACK (stage_updates_ready), data);
+        }
+
+      result = flatpak_transaction_add_update (
+          *transaction, ref_fmt, NULL, NULL, &local_error);
+      if (!result)
+        {
+          g_warning ("Failed to append the staging of %s to transaction: %s",
+                     ref_fmt, local_error->message);
+          g_clear_error (&local_error);
+        }
+    }
+
+  transactions[0] = user_transaction;
+  transactions[1] = sys_transaction;
+  for (guint i = 0; i < G_N_ELEMENTS (transactions); i++)
+    {
+      gboolean result = FALSE;
+
+      if (transactions[i] == NULL)
+        continue;
+
+      result = flatpak_transaction_run (transactions[i], cancellable, &local_error);
+      if (!result)
+        {
+          if (g_error_matches (local_error, FLATPAK_ERROR, FLATPAK_ERROR_ABORTED))
+            {
+              /* stage_updates_ready refused to go over the budget */
+              g_clear_error (&local_error);
+              continue;
+            }
+          if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            return dex_future_new_for_error (g_steal_pointer (&local_error));
+
+          return dex_future_new_reject (
+              BZ_FLATPAK_ERROR,
+              BZ_FLATPAK_ERROR_TRANSACTION_FAILURE,
+              "Failed to stage updates on installation: %s",
+              local_error->message);
+        }
+    }
+
+  return dex_future_new_for_uint64 (data->n_bytes);
+}
+
+static gboolean
+stage_updates_ready (FlatpakTransaction *object,
+                     StageUpdatesData   *data)
+{
+  g_autolist (GObject) operations = NULL;
+  guint64 n_bytes                 = 0;
+
+  operations = flatpak_transaction_get_operations (object);
+  for (GList *l = operations; l != NULL; l = l->next)
+    n_bytes += flatpak_transaction_operation_get_download_size (l->data);
+
+  if (data->byte_budget > 0 &&
+      data->n_bytes + n_bytes > data->byte_budget)
+    {
+      g_debug ("Not staging %u operations: %" G_GUINT64_FORMAT " bytes "
+               "would exceed the remaining budget of %" G_GUINT64_FORMAT " bytes",
+               g_list_length (operations), n_bytes,
+               data->byte_budget - data->n_bytes);
+      return FALSE;
+    }
+
+  data->n_bytes += n_bytes;
+  return TRUE;
+}
+
+static DexFuture *
+plan_installs_fiber (PlanInstallsData *data)
+{
+  g_autoptr (BzFlatpakInstance) self              = NULL;
+  GCancellable *cancellable                       = data->cancellable;
+  GPtrArray    *installs                          = data->installs;
+  g_autoptr (GError) local_error                  = NULL;
+  g_autoptr (FlatpakTransaction) user_transaction = NULL;
+  g_autoptr (FlatpakTransaction) sys_transaction  = NULL;
+  FlatpakTransaction *transactions[2]             = { 0 };
+
+  bz_weak_get_or_return_reject (self, data->self);
+
+  for (guint i = 0; i < installs->len; i++)
+    {
+      BzFlatpakEntry      *entry        = NULL;
+      gboolean             is_user      = FALSE;
+      FlatpakInstallation *installation = NULL;
+      FlatpakTransaction **transaction  = NULL;
+      g_autofree char     *ref_fmt      = NULL;
+      gboolean             result       = FALSE;
+
+      entry        = g_ptr_array_index (installs, i);
+      is_user      = bz_flatpak_entry_is_user (entry);
+      installation = is_user ? self->user : self->system;
+      transaction  = is_user ? &user_transaction : &sys_transaction;
+      ref_fmt      = flatpak_ref_format_ref (bz_flatpak_entry_get_ref (entry));
+
+      if (installation == NULL)
+        continue;
+
+      if (*transaction == NULL)
+        {
+          *transaction = flatpak_transaction_new_for_installation (
+              installation, cancellable, &local_error);
+          if (*transaction == NULL)
+            return dex_future_new_reject (
+                BZ_FLATPAK_ERROR,
+                BZ_FLATPAK_ERROR_TRANSACTION_FAILURE,
+                "Failed to initialize planning transaction for installation: %s",
+                local_error->message);
+
+          /* plan_installs_ready always aborts, so this is a dry run which
+             only resolves dependencies and fetches metadata */
+          g_signal_connect (*transaction, "ready", G_CALLBACK (plan_installs_ready), data);
+        }
+
+      result = flatpak_transaction_add_install (
+          *transaction,
+          bz_entry_get_remote_repo_name (BZ_ENTRY (entry)),
+          ref_fmt,
+          NULL,
+          &local_error);
+      if (!result)
+        {
+          g_warning ("Failed to append the install of %s to planning transaction: %s",
+                     ref_fmt, local_error->message);
+          g_clear_error (&local_error);
+          continue;
+        }
+
+      g_hash_table_add (data->requested, g_steal_pointer (&ref_fmt));
+    }
+
+  transactions[0] = user_transaction;
+  transactions[1] = sys_transaction;
+  for (guint i = 0; i < G_N_ELEMENTS (transactions); i++)
+    {
+      gboolean result = FALSE;
+
+      if (transactions[i] == NULL)
+        continue;
+
+      result = flatpak_transaction_run (transactions[i], cancellable, &local_error);
+      if (!result)
+        {
+          if (g_error_matches (local_error, FLATPAK_ERROR, FLATPAK_ERROR_ABORTED))
+            {
+              /* Expected, see above */
+              g_clear_error (&local_error);
+              continue;
+            }
+          if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            return dex_future_new_for_error (g_steal_pointer (&local_error));
+
+          return dex_future_new_reject (
+              BZ_FLATPAK_ERROR,
+              BZ_FLATPAK_ERROR_TRANSACTION_FAILURE,
+              "Failed to plan installs on installation: %s",
+              local_error->message);
+        }
+    }
+
+  return dex_future_new_for_object (data->plan);
+}
+
+static gboolean
+operation_provides_runtime_for (FlatpakTransactionOperation *related_op,
+                                const char                  *ref_fmt)
+{
+  GKeyFile *metadata = NULL;
+
+  if (!g_str_has_prefix (ref_fmt, "runtime/"))
+    return FALSE;
+
+  metadata = flatpak_transaction_operation_get_metadata (related_op);
+  if (metadata == NULL)
+    return FALSE;
+
+  /* The metadata names the runtime and sdk without the kind prefix */
+  for (guint i = 0; i < 2; i++)
+    {
+      const char      *key   = i == 0 ? "runtime" : "sdk";
+      g_autofree char *value = NULL;
+
+      value = g_key_file_get_string (metadata, "Application", key, NULL);
+      if (value == NULL)
+        value = g_key_file_get_string (metadata, "Runtime", key, NULL);
+      if (g_strcmp0 (value, ref_fmt + strlen ("runtime/")) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+plan_installs_ready (FlatpakTransaction *object,
+                     PlanInstallsData   *data)
+{
+  g_autolist (GObject) operations = NULL;
+  guint   n_apps                  = 0;
+  guint   n_runtimes              = 0;
+  guint   n_addons                = 0;
+  guint64 download_size           = 0;
+  guint64 installed_size          = 0;
+
+  n_apps         = bz_install_plan_get_n_apps (data->plan);
+  n_runtimes     = bz_install_plan_get_n_runtimes (data->plan);
+  n_addons       = bz_install_plan_get_n_addons (data->plan);
+  download_size  = bz_install_plan_get_download_size (data->plan);
+  installed_size = bz_install_plan_get_installed_size (data->plan);
+
+  operations = flatpak_transaction_get_operations (object);
+  for (GList *l = operations; l != NULL; l = l->next)
+    {
+      FlatpakTransactionOperation *operation = l->data;
+      const char                  *ref_fmt   = NULL;
+      GPtrArray                   *related   = NULL;
+
+      if (flatpak_transaction_operation_get_operation_type (operation) ==
+          FLATPAK_TRANSACTION_OPERATION_UNINSTALL)
+        continue;
+
+      download_size += flatpak_transaction_operation_get_download_size (operation);
+      installed_size += flatpak_transaction_operation_get_installed_size (operation);
+
+      /* The same runtime may be pulled into both installations, which
+         costs twice the space but is still a single runtime to the user */
+      ref_fmt = flatpak_transaction_operation_get_ref (operation);
+      if (!g_hash_table_add (data->seen, g_strdup (ref_fmt)))
+        continue;
+
+      /* Flatpak lists an app as related to its runtime as well as to its
+         extensions, so only the ref kind and the app metadata tell them
+         apart */
+      related = flatpak_transaction_operation_get_related_to_ops (operation);
+      if (g_hash_table_contains (data->requested, ref_fmt) ||
+          g_str_has_prefix (ref_fmt, "app/"))
+        n_apps++;
+      else if (related == NULL || related->len == 0)
+        n_runtimes++;
+      else
+        {
+          gboolean is_runtime = FALSE;
+
+          for (guint i = 0; i < related->len && !is_runtime; i++)
+            is_runtime = operation_provides_runtime_for (
+                g_ptr_array_index (related, i), ref_fmt);
+
+          if (is_runtime)
+            n_runtimes++;
+          else
+            n_addons++;
+        }
+    }
+
+  bz_install_plan_set_n_apps (data->plan, n_apps);
+  bz_install_plan_set_n_runtimes (data->plan, n_runtimes);
+  bz_install_plan_set_n_addons (data->plan, n_addons);
+  bz_install_plan_set_download_size (data->plan, download_size);
+  bz_install_plan_set_installed_size (data->plan, installed_size);
+
+  /* Never deploy anything */
+  return FALSE;
+}
+
 static BzFlatpakEntry *
 find_entry_from_operation (TransactionData             *data,
                            FlatpakTransactionOperation *operation)
@@ -2473,19 +3187,17 @@ static void
 transaction_progress_changed (FlatpakTransactionProgress *progress,
                               TransactionOperationData   *data)
 {
-  TransactionData *parent                                   = data->parent;
-  g_autoptr (BzBackendTransactionOpProgressPayload) payload = NULL;
-  int            int_progress                               = 0;
-  double         double_progress                            = 0.0;
-  GHashTableIter iter                                       = { 0 };
-  int            progress_sum                               = 0;
-  guint          n_ops                                      = 0;
-  double         total_progress                             = 0.0;
+  TransactionData             *parent       = data->parent;
+  g_autofree char             *status       = NULL;
+  BzBackendTransactionProgress tick         = { 0 };
+  int                          int_progress = 0;
+  GHashTableIter               iter         = { 0 };
+  int                          progress_sum = 0;
+  guint                        n_ops        = 0;
 
   g_mutex_lock (&parent->mutex);
 
-  int_progress    = flatpak_transaction_progress_get_progress (progress);
-  double_progress = (double) flatpak_transaction_progress_get_progress (progress) / 100.0;
+  int_progress = flatpak_transaction_progress_get_progress (progress);
 
   g_hash_table_replace (
       parent->op_to_progress_hash,
@@ -2504,31 +3216,28 @@ transaction_progress_changed (FlatpakTransactionProgress *progress,
       progress_sum += GPOINTER_TO_INT (val);
       n_ops++;
     }
-  total_progress = MIN ((double) progress_sum /
-                            (double) ((n_ops + parent->unidentified_op_cnt) * 100),
-                        1.0);
-
-  payload = bz_backend_transaction_op_progress_payload_new ();
-  bz_backend_transaction_op_progress_payload_set_op (
-      payload, data->op);
-  bz_backend_transaction_op_progress_payload_set_status (
-      payload, flatpak_transaction_progress_get_status (progress));
-  bz_backend_transaction_op_progress_payload_set_is_estimating (
-      payload, flatpak_transaction_progress_get_is_estimating (progress));
-  bz_backend_transaction_op_progress_payload_set_progress (
-      payload, double_progress);
-  bz_backend_transaction_op_progress_payload_set_total_progress (
-      payload, total_progress);
-  bz_backend_transaction_op_progress_payload_set_bytes_transferred (
-      payload, flatpak_transaction_progress_get_bytes_transferred (progress));
-  bz_backend_transaction_op_progress_payload_set_start_time (
-      payload, flatpak_transaction_progress_get_start_time (progress));
 
-  g_ptr_array_add (
-      data->parent->send_futures,
-      dex_channel_send (
-          data->parent->channel,
-          dex_future_new_for_object (payload)));
+  status = flatpak_transaction_progress_get_status (progress);
+
+  tick.op_id             = data->op_id;
+  tick.is_estimating     = flatpak_transaction_progress_get_is_estimating (progress);
+  tick.progress          = (double) int_progress / 100.0;
+  tick.bytes_transferred = flatpak_transaction_progress_get_bytes_transferred (progress);
+  tick.start_time        = flatpak_transaction_progress_get_start_time (progress);
+  tick.total_progress    = MIN ((double) progress_sum /
+                                    (double) ((n_ops + parent->unidentified_op_cnt) * 100),
+                                1.0);
+  if (status != NULL)
+    g_strlcpy (tick.status, status, sizeof (tick.status));
+
+  /* Ticks are written into a ring the main loop drains, so only the first
+     tick since the last drain has to go through the channel */
+  if (bz_backend_transaction_progress_ring_push (parent->progress_ring, &tick))
+    g_ptr_array_add (
+        parent->send_futures,
+        dex_channel_send (
+            parent->channel,
+            dex_future_new_for_object (parent->progress_ring)));
 
   g_mutex_unlock (&parent->mutex);
 }
@@ -2788,3 +3497,100 @@ extract_first_component_for_silo (XbSilo  *silo,
       g_ptr_array_index (children, 0),
       error);
 }
+
+/* Returns NULL without setting `error` if the ref definitely has no usable
+   appdata. `error` is only set for failures worth retrying */
+static AsComponent *
+load_component_for_installed_ref (FlatpakInstalledRef *iref,
+                                  GCancellable        *cancellable,
+                                  GError             **error)
+{
+  g_autoptr (GError) local_error     = NULL;
+  g_autoptr (GBytes) appstream_gz    = NULL;
+  g_autoptr (GBytes) appstream       = NULL;
+  g_autoptr (XbBuilderSource) source = NULL;
+  g_autoptr (XbSilo) silo            = NULL;
+  g_autoptr (AsComponent) component  = NULL;
+
+  appstream_gz = flatpak_installed_ref_load_appdata (iref, cancellable, &local_error);
+  if (appstream_gz == NULL)
+    {
+      if (!g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        g_propagate_error (error, g_steal_pointer (&local_error));
+      return NULL;
+    }
+
+  appstream = decompress_appstream_gz (appstream_gz, cancellable, &local_error);
+  if (appstream == NULL)
+    {
+      if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_propagate_error (error, g_steal_pointer (&local_error));
+          return NULL;
+        }
+      g_info ("Could not decompress appstream for installed ref: %s",
+              local_error ? local_error->message : "unknown error");
+      return NULL;
+    }
+
+  source = xb_builder_source_new ();
+  if (!xb_builder_source_load_bytes (source, appstream,
+                                     XB_BUILDER_SOURCE_FLAG_LITERAL_TEXT,
+                                     &local_error))
+    {
+      g_info ("Could not load appstream bytes: %s",
+              local_error ? local_error->message : "unknown error");
+      return NULL;
+    }
+
+  silo = build_silo (source, cancellable, &local_error);
+  if (silo == NULL)
+    {
+      if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_propagate_error (error, g_steal_pointer (&local_error));
+          return NULL;
+        }
+      g_info ("Could not build silo from appstream: %s",
+              local_error ? local_error->message : "unknown error");
+      return NULL;
+    }
+
+  component = extract_first_component_for_silo (silo, &local_error);
+  if (component == NULL)
+    {
+      g_info ("Could not parse appstream component: %s",
+              local_error ? local_error->message : "unknown error");
+      return NULL;
+    }
+
+  return g_steal_pointer (&component);
+}
+
+static char *
+checksum_remote_refs (GPtrArray *refs)
+{
+  g_autoptr (GPtrArray) lines  = NULL;
+  g_autoptr (GChecksum) result = NULL;
+
+  lines = g_ptr_array_new_with_free_func (g_free);
+  for (guint i = 0; i < refs->len; i++)
+    {
+      FlatpakRef *ref = NULL;
+
+      ref = g_ptr_array_index (refs, i);
+      g_ptr_array_add (
+          lines,
+          g_strdup_printf (
+              "%s\t%s\n",
+              flatpak_ref_format_ref_cached (ref),
+              flatpak_ref_get_commit (ref)));
+    }
+  g_ptr_array_sort_values (lines, (GCompareFunc) g_strcmp0);
+
+  result = g_checksum_new (G_CHECKSUM_SHA256);
+  for (guint i = 0; i < lines->len; i++)
+    g_checksum_update (result, (const guchar *) g_ptr_array_index (lines, i), -1);
+
+  return g_strdup (g_checksum_get_string (result));
+}
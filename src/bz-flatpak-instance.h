@@ -52,4 +52,9 @@ DexFuture *
 bz_flatpak_instance_ensure_has_flathub (BzFlatpakInstance *self,
                                         GCancellable      *cancellable);
 
+/* Lets remotes which failed to synchronize recently be tried again right
+   away, for instance when the user asks for it */
+void
+bz_flatpak_instance_reset_backoff (BzFlatpakInstance *self);
+
 G_END_DECLS
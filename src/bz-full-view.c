@@ -38,6 +38,7 @@
 #include "bz-flatpak-entry.h"
 #include "bz-full-view.h"
 #include "bz-hardware-support-dialog.h"
+#include "bz-install-preflight.h"
 #include "bz-license-dialog.h"
 #include "bz-releases-list.h"
 #include "bz-safety-calculator.h"
@@ -63,6 +64,8 @@ struct _BzFullView
   DexFuture            *ui_future;
   BzResult             *ui_entry;
   BzResult             *runtime;
+  BzResult             *install_plan;
+  GCancellable         *install_plan_cancellable;
   BzResult             *group_model;
   gboolean              show_sidebar;
 
@@ -89,6 +92,7 @@ enum
   PROP_STATE,
   PROP_ENTRY_GROUP,
   PROP_UI_ENTRY,
+  PROP_INSTALL_PLAN,
   PROP_MAIN_MENU,
 
   LAST_PROP
@@ -120,11 +124,15 @@ bz_full_view_dispose (GObject *object)
   BzFullView *self = BZ_FULL_VIEW (object);
 
   dex_clear (&self->ui_future);
+  if (self->install_plan_cancellable != NULL)
+    g_cancellable_cancel (self->install_plan_cancellable);
+  g_clear_object (&self->install_plan_cancellable);
   g_clear_object (&self->state);
   g_clear_object (&self->transactions);
   g_clear_object (&self->group);
   g_clear_object (&self->ui_entry);
   g_clear_object (&self->runtime);
+  g_clear_object (&self->install_plan);
   g_clear_object (&self->group_model);
   g_clear_object (&self->main_menu);
 
@@ -150,6 +158,9 @@ bz_full_view_get_property (GObject    *object,
     case PROP_UI_ENTRY:
       g_value_set_object (value, self->ui_entry);
       break;
+    case PROP_INSTALL_PLAN:
+      g_value_set_object (value, self->install_plan);
+      break;
     case PROP_MAIN_MENU:
       g_value_set_object (value, self->main_menu);
       break;
@@ -180,6 +191,7 @@ bz_full_view_set_property (GObject      *object,
       self->main_menu = g_value_dup_object (value);
       break;
     case PROP_UI_ENTRY:
+    case PROP_INSTALL_PLAN:
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -283,11 +295,26 @@ format_size (gpointer object, guint64 value)
 }
 
 static char *
-get_size_label (gpointer object,
-                gboolean is_installable,
-                gboolean runtime_installed,
-                guint64  runtime_size)
-{
+get_size_label (gpointer       object,
+                gboolean       is_installable,
+                gboolean       runtime_installed,
+                guint64        runtime_size,
+                BzInstallPlan *plan)
+{
+  /* The planned size already covers the runtime */
+  if (is_installable && plan != NULL)
+    {
+      guint n_shared = 0;
+
+      n_shared = bz_install_plan_get_n_runtimes (plan) + bz_install_plan_get_n_addons (plan);
+      if (n_shared > 0)
+        return g_strdup_printf (ngettext ("Incl. %u dependency",
+                                          "Incl. %u dependencies",
+                                          n_shared),
+                                n_shared);
+      return g_strdup (_ ("Download"));
+    }
+
   if (is_installable && !runtime_installed && runtime_size > 0)
     {
       g_autofree char *size_str = g_format_size (runtime_size);
@@ -298,14 +325,26 @@ get_size_label (gpointer object,
 }
 
 static guint64
-get_size_type (gpointer object,
-               BzEntry *entry,
-               gboolean is_installable)
+get_download_size (gpointer       object,
+                   BzEntry       *entry,
+                   BzInstallPlan *plan)
+{
+  if (plan != NULL && bz_install_plan_get_download_size (plan) > 0)
+    return bz_install_plan_get_download_size (plan);
+
+  return entry != NULL ? bz_entry_get_size (entry) : 0;
+}
+
+static guint64
+get_size_type (gpointer       object,
+               BzEntry       *entry,
+               gboolean       is_installable,
+               BzInstallPlan *plan)
 {
   if (entry == NULL)
     return 0;
 
-  return is_installable ? bz_entry_get_size (entry) : bz_entry_get_installed_size (entry);
+  return is_installable ? get_download_size (object, entry, plan) : bz_entry_get_installed_size (entry);
 }
 
 static char *
@@ -890,6 +929,7 @@ size_cb (BzFullView *self,
     return;
 
   size_dialog = bz_app_size_dialog_new (self->group);
+  g_object_set (size_dialog, "install-plan", self->install_plan, NULL);
   adw_dialog_present (size_dialog, GTK_WIDGET (self));
 }
 
@@ -1099,6 +1139,13 @@ bz_full_view_class_init (BzFullViewClass *klass)
           BZ_TYPE_RESULT,
           G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
+  props[PROP_INSTALL_PLAN] =
+      g_param_spec_object (
+          "install-plan",
+          NULL, NULL,
+          BZ_TYPE_RESULT,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
   props[PROP_MAIN_MENU] =
       g_param_spec_object (
           "main-menu",
@@ -1175,6 +1222,7 @@ bz_full_view_class_init (BzFullViewClass *klass)
   g_type_ensure (BZ_TYPE_FAVORITE_BUTTON);
   g_type_ensure (BZ_TYPE_FLATPAK_ENTRY);
   g_type_ensure (BZ_TYPE_HARDWARE_SUPPORT_DIALOG);
+  g_type_ensure (BZ_TYPE_INSTALL_PLAN);
   g_type_ensure (BZ_TYPE_SECTION_VIEW);
   g_type_ensure (BZ_TYPE_RELEASES_LIST);
   g_type_ensure (BZ_TYPE_SCREENSHOTS_CAROUSEL);
@@ -1200,6 +1248,7 @@ bz_full_view_class_init (BzFullViewClass *klass)
   gtk_widget_class_bind_template_callback (widget_class, format_size);
   gtk_widget_class_bind_template_callback (widget_class, get_size_label);
   gtk_widget_class_bind_template_callback (widget_class, format_size_tooltip);
+  gtk_widget_class_bind_template_callback (widget_class, get_download_size);
   gtk_widget_class_bind_template_callback (widget_class, age_rating_cb);
   gtk_widget_class_bind_template_callback (widget_class, format_age_rating);
   gtk_widget_class_bind_template_callback (widget_class, get_age_rating_label);
@@ -1274,6 +1323,19 @@ on_ui_entry_resolved (DexFuture *future,
 
       if (BZ_IS_FLATPAK_ENTRY (ui_entry))
         self->runtime = bz_flatpak_entry_dup_runtime_result (BZ_FLATPAK_ENTRY (ui_entry));
+
+      /* Resolves right away if this was planned before */
+      if (BZ_IS_FLATPAK_ENTRY (ui_entry) && !bz_entry_is_installed (ui_entry))
+        {
+          g_autoptr (DexFuture) plan_future = NULL;
+
+          /* Cancelled once the view moves on, which drops the dry run */
+          self->install_plan_cancellable = g_cancellable_new ();
+          plan_future                    = bz_install_preflight_query (
+              ui_entry, self->install_plan_cancellable);
+          self->install_plan = bz_result_new (plan_future);
+          g_object_notify_by_pspec (G_OBJECT (self), props[PROP_INSTALL_PLAN]);
+        }
     }
 
   return dex_future_new_for_boolean (TRUE);
@@ -1291,9 +1353,13 @@ bz_full_view_set_entry_group (BzFullView   *self,
     return;
 
   dex_clear (&self->ui_future);
+  if (self->install_plan_cancellable != NULL)
+    g_cancellable_cancel (self->install_plan_cancellable);
+  g_clear_object (&self->install_plan_cancellable);
   g_clear_object (&self->group);
   g_clear_object (&self->ui_entry);
   g_clear_object (&self->runtime);
+  g_clear_object (&self->install_plan);
   g_clear_object (&self->group_model);
   gtk_toggle_button_set_active (self->description_toggle, FALSE);
 
@@ -1354,6 +1420,7 @@ bz_full_view_set_entry_group (BzFullView   *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_ENTRY_GROUP]);
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_UI_ENTRY]);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_INSTALL_PLAN]);
 }
 
 BzEntryGroup *
@@ -0,0 +1,527 @@
+/* bz-fuzzy-index.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::FUZZY-INDEX"
+
+/* Words outside of these bounds are not indexed */
+#define MIN_WORD_CHARS 3
+#define MAX_WORD_CHARS 32
+
+/* Query words shorter than this are too ambiguous to match approximately */
+#define MIN_QUERY_CHARS 4
+
+/* Pads a word so its first and last characters get trigrams of their own */
+#define PAD_CHAR ((gunichar) ' ')
+
+#include "bz-fuzzy-index.h"
+
+typedef struct
+{
+  char       *text;
+  gunichar    chars[MAX_WORD_CHARS];
+  guint       len;
+  GHashTable *items;
+} Word;
+
+struct _BzFuzzyIndex
+{
+  gatomicrefcount rc;
+  GRWLock         lock;
+
+  /* GObject -> GPtrArray of Word */
+  GHashTable *docs;
+  /* char * -> Word */
+  GHashTable *words;
+  /* trigram -> GPtrArray of Word */
+  GHashTable *trigrams;
+};
+
+static void
+word_free (Word *word)
+{
+  g_free (word->text);
+  g_hash_table_unref (word->items);
+  g_free (word);
+}
+
+static inline guint
+trigram_key (gunichar a,
+             gunichar b,
+             gunichar c)
+{
+  /* Collisions only produce extra candidates, which are verified later */
+  return (a * 0x9e3779b1u) ^ (b * 0x85ebca77u) ^ (c * 0xc2b2ae3du);
+}
+
+static guint
+word_trigrams (const gunichar *chars,
+               guint           len,
+               guint          *out)
+{
+  gunichar padded[MAX_WORD_CHARS + 3] = { 0 };
+  guint    n_out                      = 0;
+
+  padded[0] = PAD_CHAR;
+  padded[1] = PAD_CHAR;
+  for (guint i = 0; i < len; i++)
+    padded[i + 2] = chars[i];
+  padded[len + 2] = PAD_CHAR;
+
+  for (guint i = 0; i + 2 < len + 3; i++)
+    {
+      guint    key       = 0;
+      gboolean duplicate = FALSE;
+
+      key = trigram_key (padded[i], padded[i + 1], padded[i + 2]);
+      for (guint j = 0; j < n_out; j++)
+        {
+          if (out[j] == key)
+            {
+              duplicate = TRUE;
+              break;
+            }
+        }
+      if (!duplicate)
+        out[n_out++] = key;
+    }
+
+  return n_out;
+}
+
+/* Optimal string alignment distance, giving up as soon as it is certain
+   to exceed `bound` */
+static guint
+bounded_damerau_levenshtein (const gunichar *a,
+                             guint           a_len,
+                             const gunichar *b,
+                             guint           b_len,
+                             guint           bound)
+{
+  guint  rows[3][MAX_WORD_CHARS + 1] = { 0 };
+  guint *prev2                       = rows[0];
+  guint *prev                        = rows[1];
+  guint *cur                         = rows[2];
+
+  if ((a_len > b_len ? a_len - b_len : b_len - a_len) > bound)
+    return bound + 1;
+
+  for (guint j = 0; j <= b_len; j++)
+    prev[j] = j;
+
+  for (guint i = 1; i <= a_len; i++)
+    {
+      guint  row_min = 0;
+      guint *tmp     = NULL;
+
+      cur[0]  = i;
+      row_min = i;
+
+      for (guint j = 1; j <= b_len; j++)
+        {
+          guint cost  = a[i - 1] == b[j - 1] ? 0 : 1;
+          guint value = 0;
+
+          value = MIN (prev[j] + 1, cur[j - 1] + 1);
+          value = MIN (value, prev[j - 1] + cost);
+          if (i > 1 && j > 1 &&
+              a[i - 1] == b[j - 2] &&
+              a[i - 2] == b[j - 1])
+            value = MIN (value, prev2[j - 2] + 1);
+
+          cur[j]  = value;
+          row_min = MIN (row_min, value);
+        }
+
+      if (row_min > bound)
+        return bound + 1;
+
+      tmp   = prev2;
+      prev2 = prev;
+      prev  = cur;
+      cur   = tmp;
+    }
+
+  return MIN (prev[b_len], bound + 1);
+}
+
+/* Splits `s` into lower case alphanumeric words, so that "org.mozilla.firefox"
+   and "Mozilla Firefox" share the words "mozilla" and "firefox" */
+static void
+split_words (const char *s,
+             guint       min_chars,
+             GPtrArray  *out)
+{
+  g_autofree char *folded  = NULL;
+  g_autoptr (GString) word = NULL;
+  guint n_chars            = 0;
+
+  folded = g_utf8_casefold (s, -1);
+  word   = g_string_new (NULL);
+
+  for (const char *p = folded;; p = g_utf8_next_char (p))
+    {
+      gunichar ch = g_utf8_get_char (p);
+
+      if (ch != 0 && g_unichar_isalnum (ch))
+        {
+          g_string_append_unichar (word, ch);
+          n_chars++;
+          continue;
+        }
+
+      if (n_chars >= min_chars && n_chars <= MAX_WORD_CHARS)
+        g_ptr_array_add (out, g_strndup (word->str, word->len));
+      g_string_truncate (word, 0);
+      n_chars = 0;
+
+      if (ch == 0)
+        break;
+    }
+}
+
+static guint
+utf8_to_chars (const char *s,
+               gunichar   *out)
+{
+  guint len = 0;
+
+  for (const char *p = s; *p != '\0' && len < MAX_WORD_CHARS; p = g_utf8_next_char (p))
+    out[len++] = g_utf8_get_char (p);
+  return len;
+}
+
+static void
+unlink_word (BzFuzzyIndex *self,
+             Word         *word)
+{
+  guint keys[MAX_WORD_CHARS + 1] = { 0 };
+  guint n_keys                   = 0;
+
+  n_keys = word_trigrams (word->chars, word->len, keys);
+  for (guint i = 0; i < n_keys; i++)
+    {
+      GPtrArray *posting = NULL;
+
+      posting = g_hash_table_lookup (self->trigrams, GUINT_TO_POINTER (keys[i]));
+      if (posting == NULL)
+        continue;
+
+      g_ptr_array_remove_fast (posting, word);
+      if (posting->len == 0)
+        g_hash_table_remove (self->trigrams, GUINT_TO_POINTER (keys[i]));
+    }
+
+  g_hash_table_remove (self->words, word->text);
+}
+
+static void
+remove_locked (BzFuzzyIndex *self,
+               GObject      *item)
+{
+  GPtrArray *doc_words = NULL;
+
+  doc_words = g_hash_table_lookup (self->docs, item);
+  if (doc_words == NULL)
+    return;
+
+  for (guint i = 0; i < doc_words->len; i++)
+    {
+      Word *word = NULL;
+
+      word = g_ptr_array_index (doc_words, i);
+      g_hash_table_remove (word->items, item);
+      if (g_hash_table_size (word->items) == 0)
+        unlink_word (self, word);
+    }
+
+  g_hash_table_remove (self->docs, item);
+}
+
+BzFuzzyIndex *
+bz_fuzzy_index_new (void)
+{
+  BzFuzzyIndex *self = NULL;
+
+  self = g_new0 (BzFuzzyIndex, 1);
+  g_atomic_ref_count_init (&self->rc);
+  g_rw_lock_init (&self->lock);
+
+  self->docs = g_hash_table_new_full (
+      g_direct_hash, g_direct_equal,
+      g_object_unref, (GDestroyNotify) g_ptr_array_unref);
+  self->words = g_hash_table_new_full (
+      g_str_hash, g_str_equal,
+      NULL, (GDestroyNotify) word_free);
+  self->trigrams = g_hash_table_new_full (
+      g_direct_hash, g_direct_equal,
+      NULL, (GDestroyNotify) g_ptr_array_unref);
+
+  return self;
+}
+
+BzFuzzyIndex *
+bz_fuzzy_index_ref (BzFuzzyIndex *self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  g_atomic_ref_count_inc (&self->rc);
+  return self;
+}
+
+void
+bz_fuzzy_index_unref (BzFuzzyIndex *self)
+{
+  g_return_if_fail (self != NULL);
+
+  if (!g_atomic_ref_count_dec (&self->rc))
+    return;
+
+  /* Docs reference words, and words reference postings, so tear down
+     in that order */
+  g_hash_table_unref (self->docs);
+  g_hash_table_unref (self->trigrams);
+  g_hash_table_unref (self->words);
+  g_rw_lock_clear (&self->lock);
+  g_free (self);
+}
+
+void
+bz_fuzzy_index_add (BzFuzzyIndex      *self,
+                    GObject           *item,
+                    const char *const *fields)
+{
+  g_autoptr (GPtrArray) texts     = NULL;
+  g_autoptr (GPtrArray) doc_words = NULL;
+
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (G_IS_OBJECT (item));
+  g_return_if_fail (fields != NULL);
+
+  /* Split outside of the lock since it is the expensive part */
+  texts = g_ptr_array_new_with_free_func (g_free);
+  for (guint i = 0; fields[i] != NULL; i++)
+    split_words (fields[i], MIN_WORD_CHARS, texts);
+
+  g_rw_lock_writer_lock (&self->lock);
+
+  remove_locked (self, item);
+
+  doc_words = g_ptr_array_new ();
+  for (guint i = 0; i < texts->len; i++)
+    {
+      const char *text = NULL;
+      Word       *word = NULL;
+
+      text = g_ptr_array_index (texts, i);
+      word = g_hash_table_lookup (self->words, text);
+
+      if (word == NULL)
+        {
+          guint keys[MAX_WORD_CHARS + 1] = { 0 };
+          guint n_keys                   = 0;
+
+          word        = g_new0 (Word, 1);
+          word->text  = g_strdup (text);
+          word->len   = utf8_to_chars (text, word->chars);
+          word->items = g_hash_table_new (g_direct_hash, g_direct_equal);
+          g_hash_table_replace (self->words, word->text, word);
+
+          n_keys = word_trigrams (word->chars, word->len, keys);
+          for (guint j = 0; j < n_keys; j++)
+            {
+              GPtrArray *posting = NULL;
+
+              posting = g_hash_table_lookup (self->trigrams, GUINT_TO_POINTER (keys[j]));
+              if (posting == NULL)
+                {
+                  posting = g_ptr_array_new ();
+                  g_hash_table_replace (self->trigrams, GUINT_TO_POINTER (keys[j]), posting);
+                }
+              g_ptr_array_add (posting, word);
+            }
+        }
+
+      /* A word may show up in several fields */
+      if (g_hash_table_add (word->items, item))
+        g_ptr_array_add (doc_words, word);
+    }
+
+  g_hash_table_replace (self->docs, g_object_ref (item), g_steal_pointer (&doc_words));
+
+  g_rw_lock_writer_unlock (&self->lock);
+}
+
+void
+bz_fuzzy_index_remove (BzFuzzyIndex *self,
+                       GObject      *item)
+{
+  g_return_if_fail (self != NULL);
+  g_return_if_fail (G_IS_OBJECT (item));
+
+  g_rw_lock_writer_lock (&self->lock);
+  remove_locked (self, item);
+  g_rw_lock_writer_unlock (&self->lock);
+}
+
+static GHashTable *
+query_word_locked (BzFuzzyIndex *self,
+                   const char   *text)
+{
+  gunichar chars[MAX_WORD_CHARS]   = { 0 };
+  guint    len                      = 0;
+  guint    bound                    = 0;
+  guint    keys[MAX_WORD_CHARS + 1] = { 0 };
+  guint    n_keys                   = 0;
+  guint    min_shared               = 0;
+  g_autoptr (GHashTable) shared     = NULL;
+  g_autoptr (GHashTable) scores     = NULL;
+  GHashTableIter iter               = { 0 };
+  gpointer       key                = NULL;
+  gpointer       value              = NULL;
+
+  len   = utf8_to_chars (text, chars);
+  bound = len <= 5 ? 1 : 2;
+
+  /* A substitution, insertion or deletion touches at most three trigrams,
+     but the distance counts swapping two adjacent characters as one edit
+     and that touches the four trigrams overlapping either of them. So any
+     word within `bound` edits shares at least this many with the query */
+  n_keys     = word_trigrams (chars, len, keys);
+  min_shared = n_keys > 4 * bound ? n_keys - 4 * bound : 1;
+
+  shared = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (guint i = 0; i < n_keys; i++)
+    {
+      GPtrArray *posting = NULL;
+
+      posting = g_hash_table_lookup (self->trigrams, GUINT_TO_POINTER (keys[i]));
+      if (posting == NULL)
+        continue;
+
+      for (guint j = 0; j < posting->len; j++)
+        {
+          Word *word = g_ptr_array_index (posting, j);
+          guint n    = 0;
+
+          n = GPOINTER_TO_UINT (g_hash_table_lookup (shared, word));
+          g_hash_table_replace (shared, word, GUINT_TO_POINTER (n + 1));
+        }
+    }
+
+  scores = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+  g_hash_table_iter_init (&iter, shared);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      Word          *word      = key;
+      guint          distance  = 0;
+      double         score     = 0.0;
+      GHashTableIter item_iter = { 0 };
+      gpointer       item      = NULL;
+
+      if (GPOINTER_TO_UINT (value) < min_shared)
+        continue;
+
+      distance = bounded_damerau_levenshtein (chars, len, word->chars, word->len, bound);
+      if (distance > bound)
+        continue;
+
+      /* Mirrors the weighting of exact matches in the search engine,
+         penalized by how much had to change */
+      score = (double) ((len - distance) * (len - distance)) / (double) word->len;
+
+      g_hash_table_iter_init (&item_iter, word->items);
+      while (g_hash_table_iter_next (&item_iter, &item, NULL))
+        {
+          double *best = NULL;
+
+          best = g_hash_table_lookup (scores, item);
+          if (best == NULL)
+            {
+              best  = g_new (double, 1);
+              *best = score;
+              g_hash_table_replace (scores, item, best);
+            }
+          else if (score > *best)
+            *best = score;
+        }
+    }
+
+  return g_steal_pointer (&scores);
+}
+
+GHashTable *
+bz_fuzzy_index_query (BzFuzzyIndex      *self,
+                      const char *const *terms)
+{
+  g_autoptr (GPtrArray) query_words = NULL;
+  g_autoptr (GHashTable) result     = NULL;
+
+  g_return_val_if_fail (self != NULL, NULL);
+  g_return_val_if_fail (terms != NULL, NULL);
+
+  query_words = g_ptr_array_new_with_free_func (g_free);
+  for (guint i = 0; terms[i] != NULL; i++)
+    split_words (terms[i], 1, query_words);
+
+  if (query_words->len == 0)
+    return NULL;
+  for (guint i = 0; i < query_words->len; i++)
+    {
+      if (g_utf8_strlen (g_ptr_array_index (query_words, i), -1) < MIN_QUERY_CHARS)
+        return NULL;
+    }
+
+  g_rw_lock_reader_lock (&self->lock);
+
+  for (guint i = 0; i < query_words->len; i++)
+    {
+      g_autoptr (GHashTable) scores = NULL;
+      GHashTableIter iter           = { 0 };
+      gpointer       item           = NULL;
+      gpointer       value          = NULL;
+
+      scores = query_word_locked (self, g_ptr_array_index (query_words, i));
+      if (result == NULL)
+        {
+          result = g_steal_pointer (&scores);
+          continue;
+        }
+
+      /* Every word has to match */
+      g_hash_table_iter_init (&iter, result);
+      while (g_hash_table_iter_next (&iter, &item, &value))
+        {
+          double *other = NULL;
+
+          other = g_hash_table_lookup (scores, item);
+          if (other != NULL)
+            *(double *) value += *other;
+          else
+            g_hash_table_iter_remove (&iter);
+        }
+    }
+
+  g_rw_lock_reader_unlock (&self->lock);
+
+  return g_steal_pointer (&result);
+}
+
+/* End of bz-fuzzy-index.c */
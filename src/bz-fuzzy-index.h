@@ -0,0 +1,59 @@
+/* bz-fuzzy-index.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/* A trigram index over the words of a set of objects. Writes happen on
+   one thread while queries can run concurrently from any other thread */
+typedef struct _BzFuzzyIndex BzFuzzyIndex;
+
+BzFuzzyIndex *
+bz_fuzzy_index_new (void);
+
+BzFuzzyIndex *
+bz_fuzzy_index_ref (BzFuzzyIndex *self);
+
+void
+bz_fuzzy_index_unref (BzFuzzyIndex *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (BzFuzzyIndex, bz_fuzzy_index_unref)
+
+void
+bz_fuzzy_index_add (BzFuzzyIndex      *self,
+                    GObject           *item,
+                    const char *const *fields);
+
+void
+bz_fuzzy_index_remove (BzFuzzyIndex *self,
+                       GObject      *item);
+
+/* Returns a table of item -> score (as a pointer to a double) for every
+   item where each word of `terms` is within a small edit distance of one
+   of its indexed words, or NULL if `terms` has words too short to match
+   approximately */
+GHashTable *
+bz_fuzzy_index_query (BzFuzzyIndex      *self,
+                      const char *const *terms);
+
+G_END_DECLS
@@ -20,6 +20,13 @@
 
 #define G_LOG_DOMAIN "BAZAAR::GLOBAL-NET"
 
+/* Almost everything goes to a few Flathub hosts, which speak HTTP/2, so
+   requests to each are multiplexed over one connection. The limits only
+   matter when a proxy or server falls back to HTTP/1.1 */
+#define MAX_CONNS            24
+#define MAX_CONNS_PER_HOST   6
+#define IDLE_TIMEOUT_SECONDS 90
+
 #include "config.h"
 
 #include <json-glib/json-glib.h>
@@ -40,6 +47,42 @@ BZ_DEFINE_DATA (
     BZ_RELEASE_DATA (message, g_object_unref);
     BZ_RELEASE_DATA (splice_into, g_object_unref));
 
+typedef struct
+{
+  guint64     requests;
+  guint64     reused;
+  GHashTable *connections;
+} HostStats;
+
+static const char *const prewarm_hosts[] = {
+  "flathub.org",
+  "dl.flathub.org",
+  "imgproxy.flathub.org",
+};
+
+static GMutex      stats_mutex = { 0 };
+static GHashTable *host_stats  = NULL;
+
+static SoupSession *
+ensure_session (void);
+
+static void
+record_connection (const char *host,
+                   guint64     connection_id,
+                   gboolean    is_request);
+
+static void
+message_finished (SoupMessage *message,
+                  gpointer     user_data);
+
+static DexFuture *
+prewarm_fiber (gpointer user_data);
+
+static void
+preconnect_finish (GObject      *object,
+                   GAsyncResult *result,
+                   gpointer      user_data);
+
 static DexFuture *
 http_send_fiber (HttpRequestData *data);
 
@@ -49,8 +92,12 @@ http_send_and_splice_finish (GObject      *object,
                              gpointer      user_data);
 
 static DexFuture *
-query_json_source_then (DexFuture     *future,
-                        GOutputStream *output_stream);
+query_bytes_source_then (DexFuture     *future,
+                         GOutputStream *output_stream);
+
+static DexFuture *
+query_json_source_then (DexFuture *future,
+                        gpointer   user_data);
 
 static DexFuture *
 send (SoupMessage   *message,
@@ -58,9 +105,9 @@ send (SoupMessage   *message,
       gboolean       close_output);
 
 static DexFuture *
-query_flathub_v2_json_with_method (const char *request,
-                                   const char *method,
-                                   const char *token);
+query_flathub_v2_bytes_with_method (const char *request,
+                                    const char *method,
+                                    const char *token);
 
 GProxyResolver *
 bz_get_default_proxy_resolver (void)
@@ -107,9 +154,43 @@ bz_send_with_global_http_session_then_splice_into (SoupMessage   *message,
 }
 
 DexFuture *
-bz_https_query_json (const char *uri)
+bz_prewarm_global_http_session (void)
+{
+  return dex_scheduler_spawn (
+      dex_scheduler_get_default (),
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) prewarm_fiber,
+      NULL, NULL);
+}
+
+gboolean
+bz_get_global_http_host_stats (const char *host,
+                               guint64    *requests,
+                               guint64    *connections,
+                               guint64    *reused)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+  HostStats *stats                = NULL;
+
+  g_return_val_if_fail (host != NULL, FALSE);
+
+  locker = g_mutex_locker_new (&stats_mutex);
+  if (host_stats != NULL)
+    stats = g_hash_table_lookup (host_stats, host);
+
+  if (requests != NULL)
+    *requests = stats != NULL ? stats->requests : 0;
+  if (connections != NULL)
+    *connections = stats != NULL ? g_hash_table_size (stats->connections) : 0;
+  if (reused != NULL)
+    *reused = stats != NULL ? stats->reused : 0;
+
+  return stats != NULL;
+}
+
+DexFuture *
+bz_https_query_bytes (const char *uri)
 {
-  g_autoptr (GError) local_error   = NULL;
   g_autoptr (SoupMessage) message  = NULL;
   SoupMessageHeaders *headers      = NULL;
   g_autoptr (GOutputStream) output = NULL;
@@ -126,16 +207,42 @@ bz_https_query_json (const char *uri)
   future = send (message, output, TRUE);
   future = dex_future_then (
       future,
-      (DexFutureCallback) query_json_source_then,
+      (DexFutureCallback) query_bytes_source_then,
       g_object_ref (output), g_object_unref);
   return g_steal_pointer (&future);
 }
 
+DexFuture *
+bz_https_query_json (const char *uri)
+{
+  dex_return_error_if_fail (uri != NULL);
+  return dex_future_then (
+      bz_https_query_bytes (uri),
+      (DexFutureCallback) query_json_source_then,
+      NULL, NULL);
+}
+
+DexFuture *
+bz_query_flathub_v2_bytes_take (char *request)
+{
+  DexFuture *future = NULL;
+
+  dex_return_error_if_fail (request != NULL);
+
+  future = query_flathub_v2_bytes_with_method (request, SOUP_METHOD_GET, NULL);
+  g_free (request);
+
+  return future;
+}
+
 DexFuture *
 bz_query_flathub_v2_json (const char *request)
 {
   dex_return_error_if_fail (request != NULL);
-  return query_flathub_v2_json_with_method (request, SOUP_METHOD_GET, NULL);
+  return dex_future_then (
+      query_flathub_v2_bytes_with_method (request, SOUP_METHOD_GET, NULL),
+      (DexFutureCallback) query_json_source_then,
+      NULL, NULL);
 }
 
 DexFuture *
@@ -156,7 +263,10 @@ bz_query_flathub_v2_json_authenticated (const char *request,
                                         const char *token)
 {
   dex_return_error_if_fail (request != NULL);
-  return query_flathub_v2_json_with_method (request, SOUP_METHOD_GET, token);
+  return dex_future_then (
+      query_flathub_v2_bytes_with_method (request, SOUP_METHOD_GET, token),
+      (DexFutureCallback) query_json_source_then,
+      NULL, NULL);
 }
 
 DexFuture *
@@ -164,7 +274,10 @@ bz_query_flathub_v2_json_authenticated_post (const char *request,
                                              const char *token)
 {
   dex_return_error_if_fail (request != NULL);
-  return query_flathub_v2_json_with_method (request, SOUP_METHOD_POST, token);
+  return dex_future_then (
+      query_flathub_v2_bytes_with_method (request, SOUP_METHOD_POST, token),
+      (DexFutureCallback) query_json_source_then,
+      NULL, NULL);
 }
 
 DexFuture *
@@ -172,13 +285,16 @@ bz_query_flathub_v2_json_authenticated_delete (const char *request,
                                                const char *token)
 {
   dex_return_error_if_fail (request != NULL);
-  return query_flathub_v2_json_with_method (request, SOUP_METHOD_DELETE, token);
+  return dex_future_then (
+      query_flathub_v2_bytes_with_method (request, SOUP_METHOD_DELETE, token),
+      (DexFutureCallback) query_json_source_then,
+      NULL, NULL);
 }
 
 static DexFuture *
-query_flathub_v2_json_with_method (const char *request,
-                                   const char *method,
-                                   const char *token)
+query_flathub_v2_bytes_with_method (const char *request,
+                                    const char *method,
+                                    const char *token)
 {
   g_autofree char *uri             = NULL;
   g_autoptr (SoupMessage) message  = NULL;
@@ -205,31 +321,171 @@ query_flathub_v2_json_with_method (const char *request,
   future = send (message, output, TRUE);
   future = dex_future_then (
       future,
-      (DexFutureCallback) query_json_source_then,
+      (DexFutureCallback) query_bytes_source_then,
       g_object_ref (output), g_object_unref);
   return g_steal_pointer (&future);
 }
 
-static DexFuture *
-http_send_fiber (HttpRequestData *data)
+static SoupSession *
+ensure_session (void)
 {
-  static SoupSession      *session      = NULL;
-  SoupMessage             *message      = data->message;
-  GOutputStream           *splice_into  = data->splice_into;
-  gboolean                 close_output = data->close_output;
-  GOutputStreamSpliceFlags splice_flags = G_OUTPUT_STREAM_SPLICE_NONE;
-  g_autoptr (DexPromise) promise        = NULL;
+  static SoupSession *session = NULL;
 
   if (g_once_init_enter_pointer (&session))
     {
       g_autoptr (SoupSession) session_instance = NULL;
 
-      session_instance = soup_session_new ();
-      soup_session_set_proxy_resolver (session_instance, bz_get_default_proxy_resolver ());
+      /* The connection limits are construct-only */
+      session_instance = soup_session_new_with_options (
+          "max-conns", MAX_CONNS,
+          "max-conns-per-host", MAX_CONNS_PER_HOST,
+          "idle-timeout", IDLE_TIMEOUT_SECONDS,
+          "proxy-resolver", bz_get_default_proxy_resolver (),
+          NULL);
 
       g_once_init_leave_pointer (&session, g_steal_pointer (&session_instance));
     }
 
+  return session;
+}
+
+static void
+record_connection (const char *host,
+                   guint64     connection_id,
+                   gboolean    is_request)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+  HostStats *stats                = NULL;
+  gboolean   reused               = FALSE;
+
+  if (host == NULL || connection_id == 0)
+    return;
+
+  locker = g_mutex_locker_new (&stats_mutex);
+  if (host_stats == NULL)
+    host_stats = g_hash_table_new (g_str_hash, g_str_equal);
+
+  stats = g_hash_table_lookup (host_stats, host);
+  if (stats == NULL)
+    {
+      /* There are only ever a handful of hosts, so these are never freed */
+      stats              = g_new0 (HostStats, 1);
+      stats->connections = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+      g_hash_table_replace (host_stats, g_strdup (host), stats);
+    }
+
+  reused = g_hash_table_contains (stats->connections, &connection_id);
+  if (!reused)
+    g_hash_table_add (stats->connections, g_memdup2 (&connection_id, sizeof (connection_id)));
+
+  if (is_request)
+    {
+      stats->requests++;
+      if (reused)
+        stats->reused++;
+
+      g_debug ("Request to %s %s connection %" G_GUINT64_FORMAT ", "
+               "%" G_GUINT64_FORMAT " of %" G_GUINT64_FORMAT " requests reused a connection",
+               host, reused ? "reused" : "opened", connection_id,
+               stats->reused, stats->requests);
+    }
+}
+
+static void
+message_finished (SoupMessage *message,
+                  gpointer     user_data)
+{
+  record_connection (
+      g_uri_get_host (soup_message_get_uri (message)),
+      soup_message_get_connection_id (message),
+      TRUE);
+}
+
+static DexFuture *
+prewarm_fiber (gpointer user_data)
+{
+  SoupSession *session          = NULL;
+  g_autoptr (GPtrArray) futures = NULL;
+
+  session = ensure_session ();
+  futures = g_ptr_array_new_with_free_func (dex_unref);
+
+  /* Gets DNS, TCP and TLS out of the way while the rest of startup is
+     still busy, so the first real requests can go out immediately */
+  for (guint i = 0; i < G_N_ELEMENTS (prewarm_hosts); i++)
+    {
+      g_autofree char *uri            = NULL;
+      g_autoptr (SoupMessage) message = NULL;
+      DexPromise *promise             = NULL;
+
+      uri     = g_strdup_printf ("https://%s/", prewarm_hosts[i]);
+      message = soup_message_new (SOUP_METHOD_HEAD, uri);
+
+      promise = dex_promise_new_cancellable ();
+      soup_session_preconnect_async (
+          session,
+          message,
+          G_PRIORITY_DEFAULT_IDLE,
+          dex_promise_get_cancellable (promise),
+          preconnect_finish,
+          dex_ref (promise));
+      g_ptr_array_add (futures, promise);
+    }
+
+  dex_await (
+      dex_future_allv ((DexFuture *const *) futures->pdata, futures->len),
+      NULL);
+  return dex_future_new_true ();
+}
+
+static void
+preconnect_finish (GObject      *object,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+  DexPromise *promise            = user_data;
+  g_autoptr (GError) local_error = NULL;
+  SoupMessage *message           = NULL;
+  const char  *host              = NULL;
+
+  g_assert (SOUP_IS_SESSION (object));
+  g_assert (G_IS_ASYNC_RESULT (result));
+  g_assert (DEX_IS_PROMISE (promise));
+
+  message = soup_session_get_async_result_message (SOUP_SESSION (object), result);
+  host    = g_uri_get_host (soup_message_get_uri (message));
+
+  if (soup_session_preconnect_finish (SOUP_SESSION (object), result, &local_error))
+    {
+      g_debug ("Prewarmed a connection to %s", host);
+      record_connection (host, soup_message_get_connection_id (message), FALSE);
+      dex_promise_resolve_boolean (promise, TRUE);
+    }
+  else
+    {
+      g_debug ("Could not prewarm a connection to %s: %s", host, local_error->message);
+      dex_promise_reject (promise, g_steal_pointer (&local_error));
+    }
+
+  dex_unref (promise);
+}
+
+static DexFuture *
+http_send_fiber (HttpRequestData *data)
+{
+  SoupSession             *session      = NULL;
+  SoupMessage             *message      = data->message;
+  GOutputStream           *splice_into  = data->splice_into;
+  gboolean                 close_output = data->close_output;
+  GOutputStreamSpliceFlags splice_flags = G_OUTPUT_STREAM_SPLICE_NONE;
+  g_autoptr (DexPromise) promise        = NULL;
+
+  session = ensure_session ();
+  /* Only emitted once per send, unlike got-headers which also fires for
+     redirects and other intermediate responses */
+  g_signal_handlers_disconnect_by_func (message, message_finished, NULL);
+  g_signal_connect (message, "finished", G_CALLBACK (message_finished), NULL);
+
   splice_flags = G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE;
   if (close_output)
     splice_flags |= G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET;
@@ -277,19 +533,29 @@ http_send_and_splice_finish (GObject      *object,
 }
 
 static DexFuture *
-query_json_source_then (DexFuture     *future,
-                        GOutputStream *output_stream)
+query_bytes_source_then (DexFuture     *future,
+                         GOutputStream *output_stream)
+{
+  g_autoptr (GBytes) bytes = NULL;
+
+  bytes = g_memory_output_stream_steal_as_bytes (
+      G_MEMORY_OUTPUT_STREAM (output_stream));
+  return dex_future_new_take_boxed (G_TYPE_BYTES, g_steal_pointer (&bytes));
+}
+
+static DexFuture *
+query_json_source_then (DexFuture *future,
+                        gpointer   user_data)
 {
   g_autoptr (GError) local_error = NULL;
-  g_autoptr (GBytes) bytes       = NULL;
+  GBytes       *bytes            = NULL;
   gsize         bytes_size       = 0;
   gconstpointer bytes_data       = NULL;
   g_autoptr (JsonParser) parser  = NULL;
   gboolean  result               = FALSE;
   JsonNode *node                 = NULL;
 
-  bytes = g_memory_output_stream_steal_as_bytes (
-      G_MEMORY_OUTPUT_STREAM (output_stream));
+  bytes      = g_value_get_boxed (dex_future_get_value (future, NULL));
   bytes_data = g_bytes_get_data (bytes, &bytes_size);
 
   if (bytes_size == 0)
@@ -35,6 +35,23 @@ DexFuture *
 bz_send_with_global_http_session_then_splice_into (SoupMessage   *message,
                                                    GOutputStream *output);
 
+/* Opens connections to the Flathub hosts ahead of the first requests */
+DexFuture *
+bz_prewarm_global_http_session (void);
+
+/* Counts requests sent to `host` through the global session, the distinct
+   connections they used, and how many went out over a connection which
+   was already open. Returns FALSE if `host` wasn't connected to yet. Safe
+   to call from any thread */
+gboolean
+bz_get_global_http_host_stats (const char *host,
+                               guint64    *requests,
+                               guint64    *connections,
+                               guint64    *reused);
+
+DexFuture *
+bz_https_query_bytes (const char *uri);
+
 DexFuture *
 bz_https_query_json (const char *uri);
 
@@ -55,4 +72,7 @@ bz_query_flathub_v2_json_authenticated_delete (const char *request,
 DexFuture *
 bz_query_flathub_v2_json_take (char *request);
 
+DexFuture *
+bz_query_flathub_v2_bytes_take (char *request);
+
 G_END_DECLS
@@ -19,6 +19,7 @@
  */
 
 #include "bz-gnome-shell-search-provider.h"
+#include "bz-cache-registry.h"
 #include "bz-entry-group.h"
 #include "bz-finished-search-query.h"
 #include "bz-search-result.h"
@@ -36,6 +37,7 @@ struct _BzGnomeShellSearchProvider
   DexFuture              *task;
 
   GHashTable *last_results;
+  guint       shed_id;
 };
 
 G_DEFINE_FINAL_TYPE (BzGnomeShellSearchProvider, bz_gnome_shell_search_provider, G_TYPE_OBJECT);
@@ -70,11 +72,15 @@ start_request (BzGnomeShellSearchProvider *self,
                GDBusMethodInvocation      *invocation,
                const char *const          *terms);
 
+static void
+shed_cb (GWeakRef *wr);
+
 static void
 bz_gnome_shell_search_provider_dispose (GObject *object)
 {
   BzGnomeShellSearchProvider *self = BZ_GNOME_SHELL_SEARCH_PROVIDER (object);
 
+  g_clear_handle_id (&self->shed_id, bz_cache_registry_remove);
   dex_clear (&self->task);
 
   g_clear_object (&self->engine);
@@ -273,6 +279,11 @@ bz_gnome_shell_search_provider_init (BzGnomeShellSearchProvider *self)
 {
   self->skeleton     = bz_shell_search_provider2_skeleton_new ();
   self->last_results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  self->shed_id      = bz_cache_registry_add (
+      BZ_CACHE_PRIORITY_COLLECTIONS,
+      (BzCacheShedFunc) shed_cb,
+      bz_track_weak (self),
+      bz_weak_release);
 
   g_signal_connect (
       self->skeleton, "handle-get-initial-result-set",
@@ -417,6 +428,21 @@ request_finally (DexFuture   *future,
   return NULL;
 }
 
+static void
+shed_cb (GWeakRef *wr)
+{
+  g_autoptr (BzGnomeShellSearchProvider) self = NULL;
+
+  self = g_weak_ref_get (wr);
+  if (self == NULL)
+    return;
+
+  /* The shell asks for metas right after a search, so by the time a shed
+     comes around nobody is going to look these up again. They are the
+     last thing keeping groups from a replaced catalog alive */
+  g_hash_table_remove_all (self->last_results);
+}
+
 static void
 start_request (BzGnomeShellSearchProvider *self,
                GDBusMethodInvocation      *invocation,
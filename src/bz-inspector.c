@@ -18,8 +18,12 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+/* How often the connection statistics are refreshed */
+#define HTTP_STATS_INTERVAL_SECONDS 1
+
 #include "bz-inspector.h"
 #include "bz-entry-inspector.h"
+#include "bz-global-net.h"
 #include "bz-template-callbacks.h"
 #include "bz-window.h"
 
@@ -32,7 +36,9 @@ struct _BzInspector
   GBinding  *debug_mode_binding;
   GBinding  *disable_blocklists_binding;
   GtkWindow *preview_window;
+  guint      http_stats_source;
 
+  GtkLabel           *http_stats_label;
   GtkCheckButton     *debug_mode_check;
   GtkCheckButton     *disable_blocklists_check;
   GtkEditable        *search_entry;
@@ -56,12 +62,16 @@ static gboolean
 filter_func (BzEntryGroup *group,
              BzInspector  *self);
 
+static gboolean
+update_http_stats (BzInspector *self);
+
 static void
 bz_inspector_dispose (GObject *object)
 {
   BzInspector *self = BZ_INSPECTOR (object);
 
   g_clear_pointer (&self->state, g_object_unref);
+  g_clear_handle_id (&self->http_stats_source, g_source_remove);
 
   g_clear_object (&self->debug_mode_binding);
   g_clear_object (&self->disable_blocklists_binding);
@@ -228,6 +238,7 @@ bz_inspector_class_init (BzInspectorClass *klass)
   gtk_widget_class_set_template_from_resource (widget_class, "/io/github/kolunmi/Bazaar/bz-inspector.ui");
   bz_widget_class_bind_all_util_callbacks (widget_class);
 
+  gtk_widget_class_bind_template_child (widget_class, BzInspector, http_stats_label);
   gtk_widget_class_bind_template_child (widget_class, BzInspector, debug_mode_check);
   gtk_widget_class_bind_template_child (widget_class, BzInspector, disable_blocklists_check);
   gtk_widget_class_bind_template_child (widget_class, BzInspector, search_entry);
@@ -249,6 +260,12 @@ bz_inspector_init (BzInspector *self)
 
   filter = gtk_custom_filter_new ((GtkCustomFilterFunc) filter_func, self, NULL);
   gtk_filter_list_model_set_filter (self->filter_model, GTK_FILTER (filter));
+
+  update_http_stats (self);
+  self->http_stats_source = g_timeout_add_seconds (
+      HTTP_STATS_INTERVAL_SECONDS,
+      (GSourceFunc) update_http_stats,
+      self);
 }
 
 BzInspector *
@@ -313,4 +330,38 @@ filter_func (BzEntryGroup *group,
   return FALSE;
 }
 
+static gboolean
+update_http_stats (BzInspector *self)
+{
+  /* Image downloads go through the download worker process, which keeps
+     its own statistics */
+  static const char *const hosts[] = {
+    "flathub.org",
+    "dl.flathub.org",
+  };
+  g_autoptr (GString) string = NULL;
+
+  string = g_string_new (NULL);
+  for (guint i = 0; i < G_N_ELEMENTS (hosts); i++)
+    {
+      guint64 requests    = 0;
+      guint64 connections = 0;
+      guint64 reused      = 0;
+
+      if (!bz_get_global_http_host_stats (hosts[i], &requests, &connections, &reused))
+        continue;
+
+      if (string->len > 0)
+        g_string_append_c (string, '\n');
+      g_string_append_printf (
+          string,
+          "%s: %" G_GUINT64_FORMAT " requests over %" G_GUINT64_FORMAT
+          " connections, %" G_GUINT64_FORMAT " reused",
+          hosts[i], requests, connections, reused);
+    }
+
+  gtk_label_set_label (self->http_stats_label, string->len > 0 ? string->str : "None yet");
+  return G_SOURCE_CONTINUE;
+}
+
 /* End of bz-inspector.c */
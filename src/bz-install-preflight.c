@@ -0,0 +1,271 @@
+/* bz-install-preflight.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::INSTALL-PREFLIGHT"
+
+/* Plans are tiny, this only bounds growth over a long session */
+#define PLAN_CACHE_MAX 256
+
+#include <string.h>
+
+#include "bz-application.h"
+#include "bz-backend.h"
+#include "bz-flatpak-entry.h"
+#include "bz-install-preflight.h"
+#include "bz-util.h"
+
+BZ_DEFINE_DATA (
+    query,
+    Query,
+    {
+      char         *key;
+      BzEntry      *entry;
+      GCancellable *cancellable;
+      DexPromise   *promise;
+    },
+    BZ_RELEASE_DATA (key, g_free);
+    BZ_RELEASE_DATA (entry, g_object_unref);
+    BZ_RELEASE_DATA (cancellable, g_object_unref);
+    BZ_RELEASE_DATA (promise, dex_unref));
+static void
+run_next_query (void);
+
+static DexFuture *
+query_finally (DexFuture *future,
+               QueryData *data);
+
+static GHashTable *installed = NULL;
+/* key -> BzInstallPlan */
+static GHashTable *plans = NULL;
+/* Dry runs are expensive, so only one runs at a time and the rest wait
+   here in order. Queries for the same plan are answered from the cache
+   once the first finishes */
+static GQueue   queue   = G_QUEUE_INIT;
+static gboolean running = FALSE;
+
+char *
+bz_install_preflight_dup_runtimes_stamp (void)
+{
+  g_autoptr (GPtrArray) runtimes = NULL;
+  g_autoptr (GChecksum) checksum = NULL;
+  GHashTableIter iter            = { 0 };
+
+  if (installed == NULL)
+    return g_strdup ("");
+
+  /* Installed apps don't change what another app pulls in, addons are
+     runtime refs too */
+  runtimes = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, installed);
+  for (;;)
+    {
+      const char *unique_id = NULL;
+
+      if (!g_hash_table_iter_next (&iter, (gpointer *) &unique_id, NULL))
+        break;
+
+      if (strstr (unique_id, "::runtime/") != NULL)
+        g_ptr_array_add (runtimes, (gpointer) unique_id);
+    }
+  g_ptr_array_sort_values (runtimes, (GCompareFunc) strcmp);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  for (guint i = 0; i < runtimes->len; i++)
+    {
+      g_checksum_update (checksum, g_ptr_array_index (runtimes, i), -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+    }
+
+  return g_strdup (g_checksum_get_string (checksum));
+}
+
+static char *
+dup_key (BzEntry *entry)
+{
+  const char      *commit = NULL;
+  g_autofree char *stamp  = NULL;
+
+  if (!BZ_IS_FLATPAK_ENTRY (entry) ||
+      bz_flatpak_entry_is_bundle (BZ_FLATPAK_ENTRY (entry)))
+    return NULL;
+
+  commit = bz_flatpak_entry_get_commit (BZ_FLATPAK_ENTRY (entry));
+  stamp  = bz_install_preflight_dup_runtimes_stamp ();
+
+  /* Without a commit the download size is the next best way to tell
+     builds apart */
+  if (commit != NULL)
+    return g_strdup_printf ("%s\n%s\n%s", bz_entry_get_unique_id (entry), commit, stamp);
+  else
+    return g_strdup_printf ("%s\n%" G_GUINT64_FORMAT "\n%s",
+                            bz_entry_get_unique_id (entry),
+                            bz_entry_get_size (entry),
+                            stamp);
+}
+
+void
+bz_install_preflight_set_installed (GHashTable *installed_set)
+{
+  g_return_if_fail (installed_set != NULL);
+
+  g_clear_pointer (&installed, g_hash_table_unref);
+  installed = g_hash_table_ref (installed_set);
+}
+
+BzInstallPlan *
+bz_install_preflight_peek (BzEntry *entry)
+{
+  g_autofree char *key = NULL;
+
+  g_return_val_if_fail (BZ_IS_ENTRY (entry), NULL);
+
+  if (plans == NULL)
+    return NULL;
+
+  key = dup_key (entry);
+  if (key == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (plans, key);
+}
+
+DexFuture *
+bz_install_preflight_query (BzEntry      *entry,
+                            GCancellable *cancellable)
+{
+  g_autofree char *key       = NULL;
+  BzInstallPlan   *plan      = NULL;
+  g_autoptr (QueryData) data = NULL;
+
+  dex_return_error_if_fail (BZ_IS_ENTRY (entry));
+  dex_return_error_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  key = dup_key (entry);
+  if (key == NULL)
+    return dex_future_new_reject (
+        G_IO_ERROR,
+        G_IO_ERROR_NOT_SUPPORTED,
+        "Cannot plan an install for this kind of entry");
+
+  if (plans != NULL)
+    {
+      plan = g_hash_table_lookup (plans, key);
+      if (plan != NULL)
+        return dex_future_new_for_object (plan);
+    }
+
+  data              = query_data_new ();
+  data->key         = g_steal_pointer (&key);
+  data->entry       = g_object_ref (entry);
+  data->cancellable = bz_object_maybe_ref (cancellable);
+  data->promise     = dex_promise_new ();
+
+  g_queue_push_tail (&queue, query_data_ref (data));
+  run_next_query ();
+
+  return DEX_FUTURE (dex_ref (data->promise));
+}
+
+static void
+run_next_query (void)
+{
+  while (!running && !g_queue_is_empty (&queue))
+    {
+      g_autoptr (QueryData) data   = NULL;
+      BzInstallPlan   *plan        = NULL;
+      BzBackend       *backend     = NULL;
+      g_autoptr (DexFuture) future = NULL;
+
+      data = g_queue_pop_head (&queue);
+
+      /* The view that asked has moved on */
+      if (data->cancellable != NULL &&
+          g_cancellable_is_cancelled (data->cancellable))
+        {
+          dex_promise_reject (
+              data->promise,
+              g_error_new (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                           "The install plan is no longer needed"));
+          continue;
+        }
+
+      if (plans != NULL)
+        {
+          plan = g_hash_table_lookup (plans, data->key);
+          if (plan != NULL)
+            {
+              dex_promise_resolve_object (data->promise, g_object_ref (plan));
+              continue;
+            }
+        }
+
+      backend = bz_state_info_get_backend (bz_state_info_get_default ());
+      if (backend == NULL)
+        {
+          dex_promise_reject (
+              data->promise,
+              g_error_new (G_IO_ERROR, G_IO_ERROR_NOT_INITIALIZED,
+                           "No backend is available yet"));
+          continue;
+        }
+
+      running = TRUE;
+      future  = bz_backend_plan_installs (backend, &data->entry, 1, data->cancellable);
+      future  = dex_future_finally (
+          future,
+          (DexFutureCallback) query_finally,
+          query_data_ref (data),
+          query_data_unref);
+      dex_future_disown (g_steal_pointer (&future));
+    }
+}
+
+static DexFuture *
+query_finally (DexFuture *future,
+               QueryData *data)
+{
+  g_autoptr (GError) local_error = NULL;
+  const GValue *value            = NULL;
+
+  running = FALSE;
+
+  value = dex_future_get_value (future, &local_error);
+  if (value != NULL)
+    {
+      if (plans == NULL)
+        plans = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+      else if (g_hash_table_size (plans) >= PLAN_CACHE_MAX)
+        g_hash_table_remove_all (plans);
+      g_hash_table_replace (plans, g_strdup (data->key), g_value_dup_object (value));
+
+      dex_promise_resolve_object (data->promise, g_value_dup_object (value));
+    }
+  else
+    {
+      if (!g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_debug ("Failed to plan install: %s", local_error->message);
+      dex_promise_reject (data->promise, g_steal_pointer (&local_error));
+    }
+
+  run_next_query ();
+  return NULL;
+}
+
+/* End of bz-install-preflight.c */
@@ -0,0 +1,59 @@
+/* bz-install-preflight.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <libdex.h>
+
+#include "bz-entry.h"
+#include "bz-install-plan.h"
+
+G_BEGIN_DECLS
+
+/* Works out what installing a single entry would actually cost, including
+   any runtimes and addons that aren't installed yet, by a dry run in the
+   background. Plans are cached by the entry's commit and the set of
+   installed runtimes, so they stay valid until either changes. Main thread
+   only */
+
+/* The table must map the unique ids of everything installed and is
+   consulted on every lookup, so it may be modified in place afterwards */
+void
+bz_install_preflight_set_installed (GHashTable *installed_set);
+
+/* Returns a checksum of the installed runtimes and addons, which changes
+   whenever what a plan pulls in might */
+char *
+bz_install_preflight_dup_runtimes_stamp (void);
+
+/* Returns a cached plan without starting anything */
+BzInstallPlan *
+bz_install_preflight_peek (BzEntry *entry);
+
+/* DexFuture* -> BzInstallPlan*. Dry runs happen one at a time, so this
+   may wait behind earlier queries. Cancelling `cancellable` stops the dry
+   run, or skips it if it hasn't started */
+DexFuture *
+bz_install_preflight_query (BzEntry      *entry,
+                            GCancellable *cancellable);
+
+G_END_DECLS
+
+/* End of bz-install-preflight.h */
@@ -18,8 +18,43 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "bz-io.h"
 #include "bz-env.h"
+#include "bz-reap-progress.h"
+#include "bz-util.h"
+
+/* How many paths a batch reap works on at once */
+#define REAP_BATCH_WORKERS 4
+
+BZ_DEFINE_DATA (
+    reap_batch,
+    ReapBatch,
+    {
+      GStrv       paths;
+      guint       n_paths;
+      DexChannel *progress;
+      int         next;
+      GMutex      mutex;
+      guint       done;
+      guint64     files;
+      guint64     bytes;
+    },
+    BZ_RELEASE_DATA (paths, g_strfreev);
+    BZ_RELEASE_DATA (progress, dex_unref);
+    g_mutex_clear (&self->mutex));
+static DexFuture *
+reap_batch_fiber (ReapBatchData *data);
+static DexFuture *
+reap_batch_worker_fiber (ReapBatchData *data);
+static DexFuture *
+reap_batch_finally (DexFuture     *future,
+                    ReapBatchData *data);
 
 static DexFuture *
 reap_file_fiber (GFile *file);
@@ -32,6 +67,19 @@ static DexFuture *
 get_user_data_size_fiber (char *app_id);
 static DexFuture *
 get_all_user_data_ids_fiber (void);
+static DexFuture *
+scan_user_data_fiber (DexChannel *batches);
+
+/* How many user data directories are walked at once during a scan */
+#define SCAN_USER_DATA_BATCH 16
+
+void
+bz_user_data_usage_free (BzUserDataUsage *self)
+{
+  g_return_if_fail (self != NULL);
+  g_free (self->app_id);
+  g_free (self);
+}
 
 char *
 bz_dup_user_data_path (const char *app_id)
@@ -224,6 +272,34 @@ bz_reap_path_dex (const char *path)
       g_strdup (path), g_free);
 }
 
+DexFuture *
+bz_reap_paths_dex (const char *const *paths,
+                   DexChannel        *progress)
+{
+  g_autoptr (ReapBatchData) data = NULL;
+  g_autoptr (DexFuture) future   = NULL;
+
+  dex_return_error_if_fail (paths != NULL);
+  dex_return_error_if_fail (progress == NULL || DEX_IS_CHANNEL (progress));
+
+  data = reap_batch_data_new ();
+  g_mutex_init (&data->mutex);
+  data->paths    = g_strdupv ((char **) paths);
+  data->n_paths  = g_strv_length (data->paths);
+  data->progress = bz_maybe_ref (progress, dex_ref);
+
+  future = dex_scheduler_spawn (
+      bz_get_io_scheduler (),
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) reap_batch_fiber,
+      reap_batch_data_ref (data), reap_batch_data_unref);
+  future = dex_future_finally (
+      future,
+      (DexFutureCallback) reap_batch_finally,
+      reap_batch_data_ref (data), reap_batch_data_unref);
+  return g_steal_pointer (&future);
+}
+
 DexFuture *
 bz_get_user_data_size_dex (const char *app_id)
 {
@@ -245,6 +321,19 @@ bz_get_user_data_ids_dex (void)
       NULL, NULL);
 }
 
+DexFuture *
+bz_scan_user_data_dex (DexChannel *batches)
+{
+  dex_return_error_if_fail (batches == NULL || DEX_IS_CHANNEL (batches));
+
+  return dex_scheduler_spawn (
+      bz_get_io_scheduler (),
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) scan_user_data_fiber,
+      batches != NULL ? dex_ref (batches) : NULL,
+      batches != NULL ? dex_unref : NULL);
+}
+
 static DexFuture *
 get_user_data_size_fiber (char *app_id)
 {
@@ -376,6 +465,10 @@ get_all_user_data_ids_fiber (void)
           if (file_type == G_FILE_TYPE_DIRECTORY)
             {
               const char *app_id = g_file_info_get_name (info);
+
+              /* Skip tombstones of an unfinished batch reap */
+              if (*app_id == '.')
+                continue;
               g_hash_table_insert (ids, g_strdup (app_id), NULL);
             }
         }
@@ -384,6 +477,93 @@ get_all_user_data_ids_fiber (void)
   return dex_future_new_take_boxed (G_TYPE_HASH_TABLE, ids);
 }
 
+static gint
+cmp_user_data_usage (BzUserDataUsage **a,
+                     BzUserDataUsage **b)
+{
+  if ((*a)->size != (*b)->size)
+    return (*a)->size > (*b)->size ? -1 : 1;
+  return g_strcmp0 ((*a)->app_id, (*b)->app_id);
+}
+
+static DexFuture *
+scan_user_data_fiber (DexChannel *batches)
+{
+  g_autoptr (DexFuture) ids_future = NULL;
+  g_autoptr (GHashTable) ids       = NULL;
+  g_autoptr (GError) error         = NULL;
+  g_autofree char **app_ids        = NULL;
+  guint n_app_ids                  = 0;
+  g_autoptr (GPtrArray) usages     = NULL;
+
+  ids_future = get_all_user_data_ids_fiber ();
+  ids        = dex_await_boxed (dex_ref (ids_future), &error);
+  if (ids == NULL)
+    {
+      if (batches != NULL)
+        dex_channel_close_send (batches);
+      return dex_future_new_for_error (g_steal_pointer (&error));
+    }
+
+  app_ids = (char **) g_hash_table_get_keys_as_array (ids, &n_app_ids);
+  usages  = g_ptr_array_new_full (n_app_ids, (GDestroyNotify) bz_user_data_usage_free);
+
+  /* Every directory in a batch is walked by its own fiber on the io pool,
+     so a handful of large directories don't hold up the rest */
+  for (guint i = 0; i < n_app_ids; i += SCAN_USER_DATA_BATCH)
+    {
+      guint      n_batch                       = MIN (SCAN_USER_DATA_BATCH, n_app_ids - i);
+      DexFuture *futures[SCAN_USER_DATA_BATCH] = { 0 };
+      g_autoptr (GPtrArray) batch              = NULL;
+
+      for (guint j = 0; j < n_batch; j++)
+        futures[j] = dex_scheduler_spawn (
+            bz_get_io_scheduler (),
+            bz_get_dex_stack_size (),
+            (DexFiberFunc) get_user_data_size_fiber,
+            g_strdup (app_ids[i + j]), g_free);
+
+      for (guint j = 0; j < n_batch; j++)
+        {
+          g_autoptr (GError) local_error = NULL;
+          BzUserDataUsage *usage         = NULL;
+
+          usage         = g_new0 (BzUserDataUsage, 1);
+          usage->app_id = g_strdup (app_ids[i + j]);
+          usage->size   = dex_await_uint64 (futures[j], &local_error);
+          if (local_error != NULL)
+            g_warning ("failed to measure user data for '%s': %s", usage->app_id, local_error->message);
+
+          g_ptr_array_add (usages, usage);
+        }
+
+      if (batches != NULL)
+        {
+          batch = g_ptr_array_new_full (n_batch, (GDestroyNotify) bz_user_data_usage_free);
+          for (guint j = 0; j < n_batch; j++)
+            {
+              BzUserDataUsage *usage = g_ptr_array_index (usages, usages->len - n_batch + j);
+              BzUserDataUsage *copy  = NULL;
+
+              copy         = g_new0 (BzUserDataUsage, 1);
+              copy->app_id = g_strdup (usage->app_id);
+              copy->size   = usage->size;
+              g_ptr_array_add (batch, copy);
+            }
+
+          dex_future_disown (dex_channel_send (
+              batches,
+              dex_future_new_take_boxed (G_TYPE_PTR_ARRAY, g_steal_pointer (&batch))));
+        }
+    }
+
+  if (batches != NULL)
+    dex_channel_close_send (batches);
+
+  g_ptr_array_sort (usages, (GCompareFunc) cmp_user_data_usage);
+  return dex_future_new_take_boxed (G_TYPE_PTR_ARRAY, g_steal_pointer (&usages));
+}
+
 char *
 bz_dup_root_cache_dir (void)
 {
@@ -423,3 +603,227 @@ reap_path_fiber (char *path)
   bz_reap_path (path);
   return dex_future_new_true ();
 }
+
+/* Unlinks everything below the directory open at `dfd`, counting what
+   was actually removed. Takes ownership of `dfd` */
+static void
+unlink_tree_at (int      dfd,
+                guint64 *files,
+                guint64 *bytes)
+{
+  DIR           *dir    = NULL;
+  struct dirent *dirent = NULL;
+
+  dir = fdopendir (dfd);
+  if (dir == NULL)
+    {
+      close (dfd);
+      return;
+    }
+
+  while ((dirent = readdir (dir)) != NULL)
+    {
+      struct stat st = { 0 };
+
+      if (g_strcmp0 (dirent->d_name, ".") == 0 ||
+          g_strcmp0 (dirent->d_name, "..") == 0)
+        continue;
+      if (fstatat (dirfd (dir), dirent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        continue;
+
+      if (S_ISDIR (st.st_mode))
+        {
+          int child_fd = -1;
+
+          child_fd = openat (dirfd (dir), dirent->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+          if (child_fd >= 0)
+            unlink_tree_at (child_fd, files, bytes);
+          unlinkat (dirfd (dir), dirent->d_name, AT_REMOVEDIR);
+        }
+      else if (unlinkat (dirfd (dir), dirent->d_name, 0) == 0)
+        {
+          (*files)++;
+          *bytes += st.st_size;
+        }
+    }
+
+  closedir (dir);
+}
+
+static void
+unlink_dir (const char *path,
+            guint64    *files,
+            guint64    *bytes)
+{
+  int dfd = -1;
+
+  dfd = open (path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (dfd < 0)
+    return;
+  unlink_tree_at (dfd, files, bytes);
+
+  if (rmdir (path) != 0)
+    g_warning ("failed to reap '%s': %s", path, g_strerror (errno));
+}
+
+static gboolean
+is_tombstone (const char *name)
+{
+  return *name == '.' && g_str_has_suffix (name, ".reaping");
+}
+
+/* Finishes off tombstones which an earlier reap left behind in `dirname` */
+static void
+sweep_tombstones (const char *dirname,
+                  guint64    *files,
+                  guint64    *bytes)
+{
+  g_autoptr (GDir) dir = NULL;
+  const char *name     = NULL;
+
+  dir = g_dir_open (dirname, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      g_autofree char *path = NULL;
+
+      if (!is_tombstone (name))
+        continue;
+
+      path = g_build_filename (dirname, name, NULL);
+      unlink_dir (path, files, bytes);
+    }
+}
+
+static void
+reap_one_path (const char *path,
+               guint64    *files,
+               guint64    *bytes)
+{
+  struct stat st            = { 0 };
+  g_autofree char *dirname  = NULL;
+  g_autofree char *basename = NULL;
+  g_autofree char *victim   = NULL;
+
+  if (lstat (path, &st) != 0)
+    return;
+
+  if (!S_ISDIR (st.st_mode))
+    {
+      if (unlink (path) == 0)
+        {
+          (*files)++;
+          *bytes += st.st_size;
+        }
+      return;
+    }
+
+  /* Move the directory out of the way first so nothing ever sees it half
+     deleted. If we are interrupted, the next batch in the same directory
+     sweeps up what is left */
+  dirname  = g_path_get_dirname (path);
+  basename = g_path_get_basename (path);
+  victim   = g_strdup_printf ("%s/.%s.%08x.reaping", dirname, basename, g_random_int ());
+  if (renameat (AT_FDCWD, path, AT_FDCWD, victim) != 0)
+    g_clear_pointer (&victim, g_free);
+
+  unlink_dir (victim != NULL ? victim : path, files, bytes);
+}
+
+static BzReapProgress *
+reap_batch_snapshot (ReapBatchData *data)
+{
+  BzReapProgress *progress = NULL;
+
+  progress = bz_reap_progress_new ();
+  bz_reap_progress_set_paths_done (progress, data->done);
+  bz_reap_progress_set_paths_total (progress, data->n_paths);
+  bz_reap_progress_set_files_freed (progress, data->files);
+  bz_reap_progress_set_bytes_freed (progress, data->bytes);
+
+  return progress;
+}
+
+static DexFuture *
+reap_batch_fiber (ReapBatchData *data)
+{
+  g_autoptr (GHashTable) dirnames = NULL;
+  GHashTableIter iter             = { 0 };
+  guint n_workers                 = 0;
+  g_autoptr (GPtrArray) workers   = NULL;
+
+  dirnames = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (guint i = 0; i < data->n_paths; i++)
+    g_hash_table_add (dirnames, g_path_get_dirname (data->paths[i]));
+
+  g_hash_table_iter_init (&iter, dirnames);
+  for (;;)
+    {
+      const char *dirname = NULL;
+
+      if (!g_hash_table_iter_next (&iter, (gpointer *) &dirname, NULL))
+        break;
+      sweep_tombstones (dirname, &data->files, &data->bytes);
+    }
+
+  n_workers = CLAMP (data->n_paths, 1, REAP_BATCH_WORKERS);
+  workers   = g_ptr_array_new_full (n_workers, dex_unref);
+  for (guint i = 0; i < n_workers; i++)
+    g_ptr_array_add (
+        workers,
+        dex_scheduler_spawn (
+            bz_get_io_scheduler (),
+            bz_get_dex_stack_size (),
+            (DexFiberFunc) reap_batch_worker_fiber,
+            reap_batch_data_ref (data), reap_batch_data_unref));
+
+  return dex_future_allv ((DexFuture *const *) workers->pdata, workers->len);
+}
+
+static DexFuture *
+reap_batch_worker_fiber (ReapBatchData *data)
+{
+  for (;;)
+    {
+      guint   idx   = 0;
+      guint64 files = 0;
+      guint64 bytes = 0;
+
+      idx = g_atomic_int_add (&data->next, 1);
+      if (idx >= data->n_paths)
+        break;
+
+      reap_one_path (data->paths[idx], &files, &bytes);
+
+      g_mutex_lock (&data->mutex);
+      data->done++;
+      data->files += files;
+      data->bytes += bytes;
+      /* Sent under the lock so receivers never see the totals go backwards */
+      if (data->progress != NULL)
+        dex_future_disown (dex_channel_send (
+            data->progress,
+            dex_future_new_take_object (reap_batch_snapshot (data))));
+      g_mutex_unlock (&data->mutex);
+    }
+
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+reap_batch_finally (DexFuture     *future,
+                    ReapBatchData *data)
+{
+  BzReapProgress *progress = NULL;
+
+  if (data->progress != NULL)
+    dex_channel_close_send (data->progress);
+
+  g_mutex_lock (&data->mutex);
+  progress = reap_batch_snapshot (data);
+  g_mutex_unlock (&data->mutex);
+
+  return dex_future_new_take_object (progress);
+}
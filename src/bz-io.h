@@ -25,6 +25,17 @@
 
 G_BEGIN_DECLS
 
+typedef struct
+{
+  char   *app_id;
+  guint64 size;
+} BzUserDataUsage;
+
+void
+bz_user_data_usage_free (BzUserDataUsage *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (BzUserDataUsage, bz_user_data_usage_free)
+
 char *
 bz_dup_user_data_path (const char *app_id);
 
@@ -46,12 +57,31 @@ bz_reap_path_dex (const char *path);
 DexFuture *
 bz_reap_user_data_dex (const char *app_id);
 
+/* Permanently deletes every path in `paths` using a small, fixed set of
+   workers on the io scheduler. Directories are renamed to a hidden
+   tombstone before being unlinked, and tombstones left behind by an
+   interrupted batch are swept up by the next one in the same directory.
+   A BzReapProgress with running totals is sent over `progress` (if not
+   NULL) after each path, and its sending side is closed at the end.
+   Resolves to the final BzReapProgress */
+DexFuture *
+bz_reap_paths_dex (const char *const *paths,
+                   DexChannel        *progress);
+
 DexFuture *
 bz_get_user_data_size_dex (const char *app_id);
 
 DexFuture *
 bz_get_user_data_ids_dex (void);
 
+/* Resolves to a GPtrArray of BzUserDataUsage, one for every directory in
+   ~/.var/app, sorted from largest to smallest. If `batches` is not NULL,
+   every batch is also sent over it as an unsorted GPtrArray of
+   BzUserDataUsage as soon as it is measured, and its sending side is
+   closed at the end */
+DexFuture *
+bz_scan_user_data_dex (DexChannel *batches);
+
 char *
 bz_dup_root_cache_dir (void);
 
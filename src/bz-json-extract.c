@@ -0,0 +1,556 @@
+/* bz-json-extract.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::JSON-EXTRACT"
+
+/* Fields are tracked with a bitmask per nesting level */
+#define MAX_FIELDS 32
+#define MAX_DEPTH  64
+
+#include <gio/gio.h>
+
+#include "bz-json-extract.h"
+
+typedef struct
+{
+  BzJsonField *field;
+  char       **segments;
+  guint        n_segments;
+} Matcher;
+
+typedef struct
+{
+  const char *start;
+  const char *p;
+  const char *end;
+  GString    *buf;
+  Matcher    *matchers;
+  guint       n_matchers;
+  GError    **error;
+} Scanner;
+
+static gboolean
+scan_value (Scanner *s,
+            guint    depth,
+            guint32  mask);
+
+static char **
+split_path (const char *path,
+            guint      *n_segments_out);
+
+void
+bz_json_field_clear (BzJsonField *field)
+{
+  g_clear_pointer (&field->strings, g_ptr_array_unref);
+  field->number = 0;
+  field->found  = FALSE;
+}
+
+gboolean
+bz_json_extract (GBytes      *bytes,
+                 GError     **error,
+                 BzJsonField *first_field,
+                 ...)
+{
+  va_list      args;
+  Matcher      matchers[MAX_FIELDS] = { 0 };
+  guint        n_matchers           = 0;
+  guint32      mask                 = 0;
+  gsize        size                 = 0;
+  const char  *data                 = NULL;
+  Scanner      s                    = { 0 };
+  gboolean     result               = FALSE;
+  BzJsonField *field                = NULL;
+
+  g_return_val_if_fail (bytes != NULL, FALSE);
+  g_return_val_if_fail (first_field != NULL, FALSE);
+
+  va_start (args, first_field);
+  for (field = first_field;
+       field != NULL;
+       field = va_arg (args, BzJsonField *))
+    {
+      g_return_val_if_fail (field->path != NULL, FALSE);
+      g_return_val_if_fail (n_matchers < MAX_FIELDS, FALSE);
+
+      matchers[n_matchers].field    = field;
+      matchers[n_matchers].segments = split_path (field->path, &matchers[n_matchers].n_segments);
+      mask |= 1u << n_matchers;
+      n_matchers++;
+    }
+  va_end (args);
+
+  data = g_bytes_get_data (bytes, &size);
+
+  s.start      = data;
+  s.p          = data;
+  s.end        = data + size;
+  s.buf        = g_string_new (NULL);
+  s.matchers   = matchers;
+  s.n_matchers = n_matchers;
+  s.error      = error;
+
+  /* An empty body has nothing to extract */
+  while (s.p < s.end && g_ascii_isspace (*s.p))
+    s.p++;
+  if (s.p == s.end)
+    result = TRUE;
+  else
+    {
+      result = scan_value (&s, 0, mask);
+      if (result)
+        {
+          while (s.p < s.end && g_ascii_isspace (*s.p))
+            s.p++;
+          if (s.p != s.end)
+            {
+              g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                           "Malformed JSON: trailing data at offset %zu",
+                           (gsize) (s.p - s.start));
+              result = FALSE;
+            }
+        }
+    }
+
+  g_string_free (s.buf, TRUE);
+  for (guint i = 0; i < n_matchers; i++)
+    g_strfreev (matchers[i].segments);
+
+  return result;
+}
+
+static gboolean
+fail (Scanner    *s,
+      const char *what)
+{
+  if (s->error != NULL && *s->error == NULL)
+    g_set_error (s->error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                 "Malformed JSON: %s at offset %zu",
+                 what, (gsize) (s->p - s->start));
+  return FALSE;
+}
+
+static inline void
+skip_whitespace (Scanner *s)
+{
+  while (s->p < s->end && g_ascii_isspace (*s->p))
+    s->p++;
+}
+
+static int
+hex_value (char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static gboolean
+read_hex4 (Scanner  *s,
+           gunichar *out)
+{
+  gunichar value = 0;
+
+  if (s->end - s->p < 4)
+    return fail (s, "truncated unicode escape");
+
+  for (guint i = 0; i < 4; i++)
+    {
+      int digit = 0;
+
+      digit = hex_value (s->p[i]);
+      if (digit < 0)
+        return fail (s, "invalid unicode escape");
+      value = (value << 4) | digit;
+    }
+
+  s->p += 4;
+  *out = value;
+  return TRUE;
+}
+
+/* Leaves s->p after the closing quote. When decode is set, the contents are
+   returned in out/len_out, pointing either into the input (the common case
+   without escapes) or into s->buf. */
+static gboolean
+scan_string (Scanner     *s,
+             gboolean     decode,
+             const char **out,
+             gsize       *len_out)
+{
+  const char *begin   = NULL;
+  gboolean    escaped = FALSE;
+
+  g_assert (*s->p == '"');
+  begin = ++s->p;
+
+  /* Find the end first, most strings do not contain escapes */
+  while (s->p < s->end && *s->p != '"')
+    {
+      if (*s->p == '\\')
+        {
+          escaped = TRUE;
+          s->p++;
+        }
+      s->p++;
+    }
+  if (s->p >= s->end)
+    return fail (s, "unterminated string");
+
+  if (!decode)
+    {
+      s->p++;
+      return TRUE;
+    }
+
+  if (!escaped)
+    {
+      *out     = begin;
+      *len_out = s->p - begin;
+      s->p++;
+      return TRUE;
+    }
+
+  g_string_truncate (s->buf, 0);
+  for (s->p = begin; *s->p != '"'; s->p++)
+    {
+      gunichar ch = 0;
+
+      if (*s->p != '\\')
+        {
+          g_string_append_c (s->buf, *s->p);
+          continue;
+        }
+
+      switch (*++s->p)
+        {
+        case '"':
+        case '\\':
+        case '/':
+          g_string_append_c (s->buf, *s->p);
+          break;
+        case 'b':
+          g_string_append_c (s->buf, '\b');
+          break;
+        case 'f':
+          g_string_append_c (s->buf, '\f');
+          break;
+        case 'n':
+          g_string_append_c (s->buf, '\n');
+          break;
+        case 'r':
+          g_string_append_c (s->buf, '\r');
+          break;
+        case 't':
+          g_string_append_c (s->buf, '\t');
+          break;
+        case 'u':
+          s->p++;
+          if (!read_hex4 (s, &ch))
+            return FALSE;
+          if (ch >= 0xd800 && ch <= 0xdbff)
+            {
+              gunichar low = 0;
+
+              if (s->end - s->p < 2 || s->p[0] != '\\' || s->p[1] != 'u')
+                return fail (s, "unpaired surrogate");
+              s->p += 2;
+              if (!read_hex4 (s, &low))
+                return FALSE;
+              if (low < 0xdc00 || low > 0xdfff)
+                return fail (s, "invalid surrogate pair");
+              ch = 0x10000 + ((ch - 0xd800) << 10) + (low - 0xdc00);
+            }
+          g_string_append_unichar (s->buf, ch);
+          /* The loop increment steps over the last hex digit */
+          s->p--;
+          break;
+        default:
+          return fail (s, "invalid escape");
+        }
+    }
+
+  *out     = s->buf->str;
+  *len_out = s->buf->len;
+  s->p++;
+  return TRUE;
+}
+
+static inline gboolean
+segment_equal (const char *segment,
+               const char *key,
+               gsize       key_len)
+{
+  return strncmp (segment, key, key_len) == 0 &&
+         segment[key_len] == '\0';
+}
+
+static void
+collect_string (Matcher    *matcher,
+                const char *str,
+                gsize       len)
+{
+  if (matcher->field->strings == NULL)
+    matcher->field->strings = g_ptr_array_new_with_free_func (g_free);
+  g_ptr_array_add (matcher->field->strings, g_strndup (str, len));
+  matcher->field->found = TRUE;
+}
+
+static gboolean
+scan_object (Scanner *s,
+             guint    depth,
+             guint32  mask)
+{
+  guint32 key_mask = 0;
+
+  /* Paths ending in "*" at this level want member names */
+  for (guint i = 0; i < s->n_matchers; i++)
+    {
+      Matcher *matcher = &s->matchers[i];
+
+      if ((mask & (1u << i)) &&
+          matcher->n_segments == depth + 1 &&
+          g_str_equal (matcher->segments[depth], "*"))
+        {
+          key_mask |= 1u << i;
+          matcher->field->found = TRUE;
+        }
+    }
+
+  s->p++;
+  skip_whitespace (s);
+  if (s->p < s->end && *s->p == '}')
+    {
+      s->p++;
+      return TRUE;
+    }
+
+  for (;;)
+    {
+      const char *key        = NULL;
+      gsize       key_len    = 0;
+      guint32     child_mask = 0;
+
+      skip_whitespace (s);
+      if (s->p >= s->end || *s->p != '"')
+        return fail (s, "expected member name");
+      if (!scan_string (s, mask != 0, &key, &key_len))
+        return FALSE;
+
+      if (mask != 0)
+        {
+          for (guint i = 0; i < s->n_matchers; i++)
+            {
+              Matcher *matcher = &s->matchers[i];
+
+              if (!(mask & (1u << i)))
+                continue;
+
+              if (key_mask & (1u << i))
+                collect_string (matcher, key, key_len);
+              else if (depth < matcher->n_segments &&
+                       segment_equal (matcher->segments[depth], key, key_len))
+                child_mask |= 1u << i;
+            }
+        }
+
+      skip_whitespace (s);
+      if (s->p >= s->end || *s->p != ':')
+        return fail (s, "expected ':'");
+      s->p++;
+
+      if (!scan_value (s, depth + 1, child_mask))
+        return FALSE;
+
+      skip_whitespace (s);
+      if (s->p < s->end && *s->p == ',')
+        s->p++;
+      else if (s->p < s->end && *s->p == '}')
+        {
+          s->p++;
+          return TRUE;
+        }
+      else
+        return fail (s, "expected ',' or '}'");
+    }
+}
+
+static gboolean
+scan_array (Scanner *s,
+            guint    depth,
+            guint32  mask)
+{
+  guint32 child_mask = 0;
+
+  for (guint i = 0; i < s->n_matchers; i++)
+    {
+      Matcher *matcher = &s->matchers[i];
+
+      if ((mask & (1u << i)) &&
+          depth < matcher->n_segments &&
+          g_str_equal (matcher->segments[depth], "[]"))
+        {
+          child_mask |= 1u << i;
+          if (matcher->n_segments == depth + 1)
+            matcher->field->found = TRUE;
+        }
+    }
+
+  s->p++;
+  skip_whitespace (s);
+  if (s->p < s->end && *s->p == ']')
+    {
+      s->p++;
+      return TRUE;
+    }
+
+  for (;;)
+    {
+      if (!scan_value (s, depth + 1, child_mask))
+        return FALSE;
+
+      skip_whitespace (s);
+      if (s->p < s->end && *s->p == ',')
+        s->p++;
+      else if (s->p < s->end && *s->p == ']')
+        {
+          s->p++;
+          return TRUE;
+        }
+      else
+        return fail (s, "expected ',' or ']'");
+    }
+}
+
+static gboolean
+scan_value (Scanner *s,
+            guint    depth,
+            guint32  mask)
+{
+  guint32 leaf_mask = 0;
+
+  if (depth > MAX_DEPTH)
+    return fail (s, "nesting too deep");
+
+  skip_whitespace (s);
+  if (s->p >= s->end)
+    return fail (s, "unexpected end of data");
+
+  if (*s->p == '{')
+    return scan_object (s, depth, mask);
+  if (*s->p == '[')
+    return scan_array (s, depth, mask);
+
+  for (guint i = 0; i < s->n_matchers; i++)
+    {
+      if ((mask & (1u << i)) &&
+          s->matchers[i].n_segments == depth)
+        leaf_mask |= 1u << i;
+    }
+
+  if (*s->p == '"')
+    {
+      const char *str = NULL;
+      gsize       len = 0;
+
+      if (!scan_string (s, leaf_mask != 0, &str, &len))
+        return FALSE;
+
+      if (leaf_mask != 0)
+        {
+          if (!g_utf8_validate_len (str, len, NULL))
+            return fail (s, "invalid UTF-8 in string");
+
+          for (guint i = 0; i < s->n_matchers; i++)
+            {
+              if (leaf_mask & (1u << i))
+                collect_string (&s->matchers[i], str, len);
+            }
+        }
+      return TRUE;
+    }
+  else
+    {
+      const char *begin = s->p;
+
+      while (s->p < s->end &&
+             (g_ascii_isalnum (*s->p) ||
+              *s->p == '-' ||
+              *s->p == '+' ||
+              *s->p == '.'))
+        s->p++;
+      if (s->p == begin)
+        return fail (s, "unexpected character");
+
+      if (leaf_mask != 0 &&
+          (g_ascii_isdigit (*begin) || *begin == '-'))
+        {
+          char buf[64] = { 0 };
+
+          memcpy (buf, begin, MIN ((gsize) (s->p - begin), sizeof (buf) - 1));
+          for (guint i = 0; i < s->n_matchers; i++)
+            {
+              if (leaf_mask & (1u << i))
+                {
+                  s->matchers[i].field->number = g_ascii_strtoll (buf, NULL, 10);
+                  s->matchers[i].field->found  = TRUE;
+                }
+            }
+        }
+      return TRUE;
+    }
+}
+
+static char **
+split_path (const char *path,
+            guint      *n_segments_out)
+{
+  g_autoptr (GStrvBuilder) builder = NULL;
+  g_auto (GStrv) parts             = NULL;
+  char **segments                  = NULL;
+
+  builder = g_strv_builder_new ();
+  parts   = g_strsplit (path, ".", -1);
+
+  for (char **part = parts; *part != NULL; part++)
+    {
+      if (g_str_has_suffix (*part, "[]"))
+        {
+          g_autofree char *name = NULL;
+
+          name = g_strndup (*part, strlen (*part) - 2);
+          if (*name != '\0')
+            g_strv_builder_add (builder, name);
+          g_strv_builder_add (builder, "[]");
+        }
+      else if (**part != '\0')
+        g_strv_builder_add (builder, *part);
+    }
+
+  segments        = g_strv_builder_end (builder);
+  *n_segments_out = g_strv_length (segments);
+  return segments;
+}
+
+/* End of bz-json-extract.c */
@@ -0,0 +1,60 @@
+/* bz-json-extract.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* A path is a dot separated list of object member names, where a member
+ * name suffixed with "[]" (or a lone "[]") descends into every element of an
+ * array, and a trailing "*" collects the member names of an object instead
+ * of a value. For example:
+ *
+ *   "hits[].app_id"  every "app_id" string of the objects in "hits"
+ *   "totalHits"      the number at the root "totalHits" member
+ *   "[]"             every string in a root array
+ *   "*"              every member name of the root object
+ */
+typedef struct
+{
+  const char *path;
+
+  /* Output */
+  GPtrArray *strings;
+  gint64     number;
+  gboolean   found;
+} BzJsonField;
+
+#define BZ_JSON_FIELD_INIT(_path) { (_path), NULL, 0, FALSE }
+
+void
+bz_json_field_clear (BzJsonField *field);
+
+G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC (BzJsonField, bz_json_field_clear)
+
+gboolean
+bz_json_extract (GBytes      *bytes,
+                 GError     **error,
+                 BzJsonField *first_field,
+                 ...) G_GNUC_NULL_TERMINATED;
+
+G_END_DECLS
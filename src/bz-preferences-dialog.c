@@ -65,6 +65,8 @@ struct _BzPreferencesDialog
   AdwSwitchRow *only_flathub_switch;
   AdwSwitchRow *only_verified_switch;
   AdwSwitchRow *search_debounce_switch;
+  AdwSwitchRow *stage_updates_switch;
+  AdwSpinRow   *stage_updates_budget_spin;
   GtkFlowBox   *flag_buttons_box;
   AdwSwitchRow *hide_eol_switch;
   AdwSwitchRow *rotate_switch;
@@ -213,6 +215,14 @@ bind_settings (BzPreferencesDialog *self)
                    self->hide_eol_switch, "active",
                    G_SETTINGS_BIND_DEFAULT);
 
+  g_settings_bind (self->settings, "stage-updates",
+                   self->stage_updates_switch, "active",
+                   G_SETTINGS_BIND_DEFAULT);
+
+  g_settings_bind (self->settings, "stage-updates-budget",
+                   self->stage_updates_budget_spin, "value",
+                   G_SETTINGS_BIND_DEFAULT);
+
   g_settings_bind (self->settings, "rotate-flag",
                  self->rotate_switch, "active",
                  G_SETTINGS_BIND_DEFAULT);
@@ -297,6 +307,8 @@ bz_preferences_dialog_class_init (BzPreferencesDialogClass *klass)
   gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, only_flathub_switch);
   gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, only_verified_switch);
   gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, search_debounce_switch);
+  gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, stage_updates_switch);
+  gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, stage_updates_budget_spin);
   gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, flag_buttons_box);
   gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, hide_eol_switch);
   gtk_widget_class_bind_template_child (widget_class, BzPreferencesDialog, rotate_switch);
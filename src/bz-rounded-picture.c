@@ -18,6 +18,7 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include "bz-async-texture.h"
 #include "bz-rounded-picture.h"
 
 struct _BzRoundedPicture
@@ -138,6 +139,21 @@ bz_rounded_picture_measure (GtkWidget     *widget,
     }
 }
 
+static void
+bz_rounded_picture_size_allocate (GtkWidget *widget,
+                                  int        width,
+                                  int        height,
+                                  int        baseline)
+{
+  BzRoundedPicture *self = BZ_ROUNDED_PICTURE (widget);
+
+  if (self->paintable != NULL && BZ_IS_ASYNC_TEXTURE (self->paintable))
+    bz_async_texture_request_size (
+        BZ_ASYNC_TEXTURE (self->paintable),
+        width, height,
+        gtk_widget_get_scale_factor (widget));
+}
+
 static void
 bz_rounded_picture_snapshot (GtkWidget   *widget,
                              GtkSnapshot *snapshot)
@@ -226,8 +242,9 @@ bz_rounded_picture_class_init (BzRoundedPictureClass *klass)
   object_class->get_property = bz_rounded_picture_get_property;
   object_class->set_property = bz_rounded_picture_set_property;
 
-  widget_class->measure  = bz_rounded_picture_measure;
-  widget_class->snapshot = bz_rounded_picture_snapshot;
+  widget_class->measure       = bz_rounded_picture_measure;
+  widget_class->size_allocate = bz_rounded_picture_size_allocate;
+  widget_class->snapshot      = bz_rounded_picture_snapshot;
 
   props[PROP_PAINTABLE] =
       g_param_spec_object ("paintable",
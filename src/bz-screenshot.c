@@ -66,6 +66,11 @@ async_loaded (BzScreenshot   *self,
               GParamSpec     *pspec,
               BzAsyncTexture *texture);
 
+static void
+request_texture_size (BzScreenshot *self,
+                      int           width,
+                      int           height);
+
 static void
 bz_screenshot_dispose (GObject *object)
 {
@@ -219,6 +224,15 @@ bz_screenshot_measure (GtkWidget     *widget,
     }
 }
 
+static void
+bz_screenshot_size_allocate (GtkWidget *widget,
+                             int        width,
+                             int        height,
+                             int        baseline)
+{
+  request_texture_size (BZ_SCREENSHOT (widget), width, height);
+}
+
 static void
 bz_screenshot_snapshot (GtkWidget   *widget,
                         GtkSnapshot *snapshot)
@@ -396,6 +410,7 @@ bz_screenshot_class_init (BzScreenshotClass *klass)
 
   widget_class->get_request_mode = bz_screenshot_get_request_mode;
   widget_class->measure          = bz_screenshot_measure;
+  widget_class->size_allocate    = bz_screenshot_size_allocate;
   widget_class->snapshot         = bz_screenshot_snapshot;
 }
 
@@ -440,6 +455,11 @@ bz_screenshot_set_paintable (BzScreenshot *self,
       if (BZ_IS_ASYNC_TEXTURE (paintable))
         g_signal_connect_swapped (paintable, "notify::loaded",
                                   G_CALLBACK (async_loaded), self);
+
+      request_texture_size (
+          self,
+          gtk_widget_get_width (GTK_WIDGET (self)),
+          gtk_widget_get_height (GTK_WIDGET (self)));
     }
 
   gtk_widget_queue_resize (GTK_WIDGET (self));
@@ -582,3 +602,25 @@ async_loaded (BzScreenshot   *self,
   gtk_widget_queue_draw (GTK_WIDGET (self));
   gtk_widget_queue_resize (GTK_WIDGET (self));
 }
+
+static void
+request_texture_size (BzScreenshot *self,
+                      int           width,
+                      int           height)
+{
+  if (self->paintable == NULL ||
+      !BZ_IS_ASYNC_TEXTURE (self->paintable))
+    return;
+
+  /* In top half mode the width is fixed and the height is cropped */
+  if (self->top_half)
+    bz_async_texture_request_size (
+        BZ_ASYNC_TEXTURE (self->paintable),
+        TOP_HALF_FIXED_WIDTH, 0,
+        gtk_widget_get_scale_factor (GTK_WIDGET (self)));
+  else
+    bz_async_texture_request_size (
+        BZ_ASYNC_TEXTURE (self->paintable),
+        width, height,
+        gtk_widget_get_scale_factor (GTK_WIDGET (self)));
+}
@@ -24,6 +24,7 @@
 #include "bz-entry-group.h"
 #include "bz-env.h"
 #include "bz-finished-search-query.h"
+#include "bz-fuzzy-index.h"
 #include "bz-search-result.h"
 #include "bz-util.h"
 
@@ -35,6 +36,13 @@ struct _BzSearchEngine
   GListModel *biases;
 
   GPtrArray *biases_mirror;
+
+  /* Groups are indexed from an idle callback; `model_mirror` tracks what
+     `model` held so removed groups can be dropped from the index */
+  GPtrArray    *model_mirror;
+  BzFuzzyIndex *fuzzy_index;
+  GHashTable   *reindex_pending;
+  guint         reindex_source;
 };
 
 G_DEFINE_FINAL_TYPE (BzSearchEngine, bz_search_engine, G_TYPE_OBJECT);
@@ -57,6 +65,18 @@ biases_changed (BzSearchEngine *self,
                 guint           added,
                 GListModel     *model);
 
+static void
+model_changed (BzSearchEngine *self,
+               guint           position,
+               guint           removed,
+               guint           added,
+               GListModel     *model);
+
+static void
+group_notify (BzSearchEngine *self,
+              GParamSpec     *pspec,
+              BzEntryGroup   *group);
+
 static double
 test_strings (const char *query,
               const char *against,
@@ -109,13 +129,15 @@ BZ_DEFINE_DATA (
     query_task,
     QueryTask,
     {
-      char     **terms;
-      GPtrArray *snapshot;
-      GPtrArray *biases;
+      char        **terms;
+      GPtrArray    *snapshot;
+      GPtrArray    *biases;
+      BzFuzzyIndex *fuzzy_index;
     },
     BZ_RELEASE_DATA (terms, g_strfreev);
     BZ_RELEASE_DATA (snapshot, g_ptr_array_unref);
-    BZ_RELEASE_DATA (biases, g_ptr_array_unref))
+    BZ_RELEASE_DATA (biases, g_ptr_array_unref);
+    BZ_RELEASE_DATA (fuzzy_index, bz_fuzzy_index_unref))
 static DexFuture *
 query_task_fiber (QueryTaskData *data);
 
@@ -123,16 +145,18 @@ BZ_DEFINE_DATA (
     query_sub_task,
     QuerySubTask,
     {
-      char      *query_utf8;
-      GPtrArray *shallow_mirror;
-      double     threshold;
-      guint      work_offset;
-      guint      work_length;
-      GPtrArray *active_biases;
+      char       *query_utf8;
+      GPtrArray  *shallow_mirror;
+      double      threshold;
+      guint       work_offset;
+      guint       work_length;
+      GPtrArray  *active_biases;
+      GHashTable *fuzzy_scores;
     },
     BZ_RELEASE_DATA (query_utf8, g_free);
     BZ_RELEASE_DATA (shallow_mirror, g_ptr_array_unref);
-    BZ_RELEASE_DATA (active_biases, g_ptr_array_unref));
+    BZ_RELEASE_DATA (active_biases, g_ptr_array_unref);
+    BZ_RELEASE_DATA (fuzzy_scores, g_hash_table_unref));
 static DexFuture *
 query_sub_task_fiber (QuerySubTaskData *data);
 
@@ -152,11 +176,20 @@ bz_search_engine_dispose (GObject *object)
 
   if (self->biases != NULL)
     g_signal_handlers_disconnect_by_func (self->biases, biases_changed, self);
+  if (self->model != NULL)
+    g_signal_handlers_disconnect_by_func (self->model, model_changed, self);
+  for (guint i = 0; self->model_mirror != NULL && i < self->model_mirror->len; i++)
+    g_signal_handlers_disconnect_by_func (
+        g_ptr_array_index (self->model_mirror, i), group_notify, self);
 
   g_clear_object (&self->model);
   g_clear_object (&self->biases);
 
   g_clear_pointer (&self->biases_mirror, g_ptr_array_unref);
+  g_clear_pointer (&self->model_mirror, g_ptr_array_unref);
+  g_clear_pointer (&self->fuzzy_index, bz_fuzzy_index_unref);
+  g_clear_pointer (&self->reindex_pending, g_hash_table_unref);
+  g_clear_handle_id (&self->reindex_source, g_source_remove);
 
   G_OBJECT_CLASS (bz_search_engine_parent_class)->dispose (object);
 }
@@ -232,7 +265,10 @@ bz_search_engine_class_init (BzSearchEngineClass *klass)
 static void
 bz_search_engine_init (BzSearchEngine *self)
 {
-  self->biases_mirror = g_ptr_array_new_with_free_func (bias_data_unref);
+  self->biases_mirror   = g_ptr_array_new_with_free_func (bias_data_unref);
+  self->model_mirror    = g_ptr_array_new_with_free_func (g_object_unref);
+  self->fuzzy_index     = bz_fuzzy_index_new ();
+  self->reindex_pending = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
 }
 
 BzSearchEngine *
@@ -291,9 +327,25 @@ bz_search_engine_set_model (BzSearchEngine *self,
   g_return_if_fail (BZ_IS_SEARCH_ENGINE (self));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
 
+  if (self->model != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (self->model, model_changed, self);
+      model_changed (self, 0, self->model_mirror->len, 0, self->model);
+    }
   g_clear_object (&self->model);
+
+  /* Queries in flight keep their reference to the old index */
+  g_clear_pointer (&self->fuzzy_index, bz_fuzzy_index_unref);
+  self->fuzzy_index = bz_fuzzy_index_new ();
+
   if (model != NULL)
-    self->model = g_object_ref (model);
+    {
+      self->model = g_object_ref (model);
+      model_changed (self, 0, 0, g_list_model_get_n_items (model), model);
+      g_signal_connect_swapped (
+          model, "items-changed",
+          G_CALLBACK (model_changed), self);
+    }
 
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_MODEL]);
 }
@@ -351,10 +403,11 @@ bz_search_engine_query (BzSearchEngine    *self,
       for (guint i = 0; i < snapshot->len; i++)
         g_ptr_array_index (snapshot, i) = g_list_model_get_item (self->model, i);
 
-      data           = query_task_data_new ();
-      data->terms    = g_strdupv ((gchar **) terms);
-      data->snapshot = g_steal_pointer (&snapshot);
-      data->biases   = g_ptr_array_ref (self->biases_mirror);
+      data              = query_task_data_new ();
+      data->terms       = g_strdupv ((gchar **) terms);
+      data->snapshot    = g_steal_pointer (&snapshot);
+      data->biases      = g_ptr_array_ref (self->biases_mirror);
+      data->fuzzy_index = bz_fuzzy_index_ref (self->fuzzy_index);
 
       return dex_scheduler_spawn (
           dex_thread_pool_scheduler_get_default (),
@@ -510,12 +563,121 @@ biases_changed (BzSearchEngine *self,
   self->biases_mirror = g_steal_pointer (&new_mirror);
 }
 
+static gboolean
+reindex_idle (BzSearchEngine *self)
+{
+  GHashTableIter iter = { 0 };
+  gpointer       key  = NULL;
+  guint          n    = 0;
+
+  /* Bounded per iteration so a freshly loaded catalog does not stall
+     the main loop */
+  g_hash_table_iter_init (&iter, self->reindex_pending);
+  while (n < 256 && g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      BzEntryGroup *group             = key;
+      g_autoptr (GMutexLocker) locker = NULL;
+      const char *fields[5]           = { 0 };
+      guint       n_fields            = 0;
+
+      locker = bz_entry_group_lock (group);
+
+#define ADD_FIELD(_s)              \
+  G_STMT_START                     \
+  {                                \
+    const char *_field = (_s);     \
+    if (_field != NULL)            \
+      fields[n_fields++] = _field; \
+  }                                \
+  G_STMT_END
+
+      ADD_FIELD (bz_entry_group_get_id (group));
+      ADD_FIELD (bz_entry_group_get_title (group));
+      ADD_FIELD (bz_entry_group_get_developer (group));
+      ADD_FIELD (bz_entry_group_get_search_tokens (group));
+
+#undef ADD_FIELD
+
+      bz_fuzzy_index_add (self->fuzzy_index, G_OBJECT (group), fields);
+
+      g_clear_pointer (&locker, g_mutex_locker_free);
+      g_hash_table_iter_remove (&iter);
+      n++;
+    }
+
+  if (g_hash_table_size (self->reindex_pending) > 0)
+    return G_SOURCE_CONTINUE;
+
+  self->reindex_source = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_reindex (BzSearchEngine *self,
+               BzEntryGroup   *group)
+{
+  g_hash_table_add (self->reindex_pending, g_object_ref (group));
+
+  if (self->reindex_source == 0)
+    self->reindex_source = g_idle_add_full (
+        G_PRIORITY_LOW,
+        (GSourceFunc) reindex_idle,
+        self, NULL);
+}
+
+static void
+group_notify (BzSearchEngine *self,
+              GParamSpec     *pspec,
+              BzEntryGroup   *group)
+{
+  const char *name = g_param_spec_get_name (pspec);
+
+  /* This can be emitted with the group locked, so only queue the work */
+  if (g_strcmp0 (name, "title") == 0 ||
+      g_strcmp0 (name, "developer") == 0 ||
+      g_strcmp0 (name, "search-tokens") == 0)
+    queue_reindex (self, group);
+}
+
+static void
+model_changed (BzSearchEngine *self,
+               guint           position,
+               guint           removed,
+               guint           added,
+               GListModel     *model)
+{
+  for (guint i = 0; i < removed; i++)
+    {
+      BzEntryGroup *group = NULL;
+
+      group = g_ptr_array_index (self->model_mirror, position + i);
+      g_signal_handlers_disconnect_by_func (group, group_notify, self);
+      g_hash_table_remove (self->reindex_pending, group);
+      bz_fuzzy_index_remove (self->fuzzy_index, G_OBJECT (group));
+    }
+  if (removed > 0)
+    g_ptr_array_remove_range (self->model_mirror, position, removed);
+
+  for (guint i = 0; i < added; i++)
+    {
+      g_autoptr (BzEntryGroup) group = NULL;
+
+      group = g_list_model_get_item (model, position + i);
+      g_ptr_array_insert (self->model_mirror, position + i, g_object_ref (group));
+      g_signal_connect_swapped (
+          group, "notify",
+          G_CALLBACK (group_notify), self);
+      queue_reindex (self, group);
+    }
+}
+
 static DexFuture *
 query_task_fiber (QueryTaskData *data)
 {
   char     **terms                           = data->terms;
   GPtrArray *shallow_mirror                  = data->snapshot;
   GPtrArray *biases                          = data->biases;
+  g_autoptr (GHashTable) fuzzy_scores        = NULL;
   g_autoptr (GError) local_error             = NULL;
   gboolean         result                    = FALSE;
   g_autofree char *query_utf8                = NULL;
@@ -561,6 +723,12 @@ query_task_fiber (QueryTaskData *data)
       g_ptr_array_add (active_biases, bias_data_ref (bias));
     }
 
+  /* Candidates for misspelled words come from the trigram index, which
+     only visits words sharing trigrams with the query */
+  fuzzy_scores = bz_fuzzy_index_query (
+      data->fuzzy_index,
+      (const char *const[]) { query_utf8, NULL });
+
   sub_futures = g_ptr_array_new_with_free_func (dex_unref);
   for (guint i = 0; i < n_sub_tasks; i++)
     {
@@ -574,6 +742,7 @@ query_task_fiber (QueryTaskData *data)
       sub_data->work_offset    = i * scores_per_task;
       sub_data->work_length    = scores_per_task;
       sub_data->active_biases  = g_ptr_array_ref (active_biases);
+      sub_data->fuzzy_scores   = bz_maybe_ref (fuzzy_scores, g_hash_table_ref);
 
       if (i >= n_sub_tasks - 1)
         sub_data->work_length += shallow_mirror->len % n_sub_tasks;
@@ -639,12 +808,13 @@ query_task_fiber (QueryTaskData *data)
 static DexFuture *
 query_sub_task_fiber (QuerySubTaskData *data)
 {
-  GPtrArray *shallow_mirror     = data->shallow_mirror;
-  char      *query_utf8         = data->query_utf8;
-  double     threshold          = data->threshold;
-  guint      work_offset        = data->work_offset;
-  guint      work_length        = data->work_length;
-  GPtrArray *active_biases      = data->active_biases;
+  GPtrArray  *shallow_mirror    = data->shallow_mirror;
+  char       *query_utf8        = data->query_utf8;
+  double      threshold         = data->threshold;
+  guint       work_offset       = data->work_offset;
+  guint       work_length       = data->work_length;
+  GPtrArray  *active_biases     = data->active_biases;
+  GHashTable *fuzzy_scores      = data->fuzzy_scores;
   g_autoptr (GArray) scores_out = NULL;
 
   scores_out = g_array_new (FALSE, FALSE, sizeof (Score));
@@ -689,6 +859,15 @@ query_sub_task_fiber (QuerySubTaskData *data)
           score += EVALUATE_STRING (search_tokens, -1) * 1.5;
 
 #undef EVALUATE_STRING
+
+          if (score <= 0.0 && fuzzy_scores != NULL)
+            {
+              double *fuzzy_score = NULL;
+
+              fuzzy_score = g_hash_table_lookup (fuzzy_scores, group);
+              if (fuzzy_score != NULL)
+                score = *fuzzy_score;
+            }
         }
 
       for (guint j = 0; j < active_biases->len; j++)
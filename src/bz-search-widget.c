@@ -680,15 +680,155 @@ blocklists_items_changed (BzSearchWidget *self,
   update_filter (self);
 }
 
+/* Brings the results model in line with a new ranked list using as few
+   splices as possible. Results are keyed on group id; the longest run of
+   surviving groups that kept their relative order stays in place (found
+   as the longest increasing subsequence of their new positions), so the
+   tiles bound to them are not torn down. Surviving results are reused
+   and updated instead of swapped for the fresh objects. */
+static void
+apply_results (BzSearchWidget *self,
+               GPtrArray      *results)
+{
+  GListModel *model                = G_LIST_MODEL (self->search_model);
+  guint       n_old                = 0;
+  g_autoptr (GHashTable) new_index = NULL;
+  g_autoptr (GPtrArray) items      = NULL;
+  g_autofree guint *old_pos        = NULL;
+  g_autofree guint *new_pos        = NULL;
+  g_autofree guint *tails          = NULL;
+  g_autofree guint *prev           = NULL;
+  g_autofree gboolean *anchor      = NULL;
+  guint n_pairs                    = 0;
+  guint lis_length                 = 0;
+  guint old_cursor                 = 0;
+  guint new_cursor                 = 0;
+
+  n_old = g_list_model_get_n_items (model);
+  if (n_old == 0 || results->len == 0)
+    {
+      g_list_store_splice (
+          self->search_model,
+          0, n_old,
+          (gpointer *) results->pdata, results->len);
+      return;
+    }
+
+  new_index = g_hash_table_new (g_str_hash, g_str_equal);
+  items     = g_ptr_array_new_full (results->len, g_object_unref);
+  for (guint i = 0; i < results->len; i++)
+    {
+      BzSearchResult *result = NULL;
+      const char     *id     = NULL;
+
+      result = g_ptr_array_index (results, i);
+      id     = bz_entry_group_get_id (bz_search_result_get_group (result));
+
+      if (!g_hash_table_contains (new_index, id))
+        g_hash_table_insert (new_index, (gpointer) id, GUINT_TO_POINTER (i));
+      g_ptr_array_add (items, g_object_ref (result));
+    }
+
+  old_pos = g_new (guint, MIN (n_old, results->len));
+  new_pos = g_new (guint, MIN (n_old, results->len));
+  for (guint i = 0; i < n_old; i++)
+    {
+      g_autoptr (BzSearchResult) old = NULL;
+      BzSearchResult *result         = NULL;
+      const char     *id             = NULL;
+      gpointer        value          = NULL;
+      guint           j              = 0;
+
+      old = g_list_model_get_item (model, i);
+      id  = bz_entry_group_get_id (bz_search_result_get_group (old));
+
+      if (!g_hash_table_steal_extended (new_index, id, NULL, &value))
+        continue;
+      j      = GPOINTER_TO_UINT (value);
+      result = g_ptr_array_index (items, j);
+
+      bz_search_result_set_original_index (old, bz_search_result_get_original_index (result));
+      bz_search_result_set_score (old, bz_search_result_get_score (result));
+      bz_search_result_set_title_markup (old, bz_search_result_get_title_markup (result));
+      bz_search_result_set_state (old, bz_search_result_get_state (result));
+
+      g_object_unref (g_ptr_array_index (items, j));
+      g_ptr_array_index (items, j) = g_object_ref (old);
+
+      old_pos[n_pairs] = i;
+      new_pos[n_pairs] = j;
+      n_pairs++;
+    }
+
+  tails  = g_new (guint, MAX (n_pairs, 1));
+  prev   = g_new (guint, MAX (n_pairs, 1));
+  anchor = g_new0 (gboolean, MAX (n_pairs, 1));
+  for (guint p = 0; p < n_pairs; p++)
+    {
+      guint lo = 0;
+      guint hi = lis_length;
+
+      while (lo < hi)
+        {
+          guint mid = (lo + hi) / 2;
+
+          if (new_pos[tails[mid]] < new_pos[p])
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+
+      prev[p]   = lo > 0 ? tails[lo - 1] : G_MAXUINT;
+      tails[lo] = p;
+      if (lo == lis_length)
+        lis_length++;
+    }
+  if (lis_length > 0)
+    {
+      for (guint p = tails[lis_length - 1]; p != G_MAXUINT; p = prev[p])
+        anchor[p] = TRUE;
+    }
+
+  /* Everything between two anchors is replaced in one splice. At each
+     step the model holds the finished prefix followed by the remaining
+     old results, so the splice position is the new cursor */
+  for (guint p = 0; p <= n_pairs; p++)
+    {
+      guint old_end = 0;
+      guint new_end = 0;
+
+      if (p < n_pairs)
+        {
+          if (!anchor[p])
+            continue;
+          old_end = old_pos[p];
+          new_end = new_pos[p];
+        }
+      else
+        {
+          old_end = n_old;
+          new_end = results->len;
+        }
+
+      if (old_end > old_cursor || new_end > new_cursor)
+        g_list_store_splice (
+            self->search_model,
+            new_cursor, old_end - old_cursor,
+            items->pdata + new_cursor, new_end - new_cursor);
+
+      old_cursor = old_end + 1;
+      new_cursor = new_end + 1;
+    }
+}
+
 static DexFuture *
 search_query_then (DexFuture *future,
                    GWeakRef  *wr)
 {
-  g_autoptr (BzSearchWidget) self   = NULL;
-  BzFinishedSearchQuery *finished   = NULL;
-  GPtrArray             *results    = NULL;
-  guint                  old_length = 0;
-  const char            *page_name  = NULL;
+  g_autoptr (BzSearchWidget) self  = NULL;
+  BzFinishedSearchQuery *finished  = NULL;
+  GPtrArray             *results   = NULL;
+  const char            *page_name = NULL;
 
   bz_weak_get_or_return_reject (self, wr);
 
@@ -706,11 +846,7 @@ search_query_then (DexFuture *future,
         }
     }
 
-  old_length = g_list_model_get_n_items (G_LIST_MODEL (self->search_model));
-  g_list_store_splice (
-      self->search_model,
-      0, old_length,
-      (gpointer *) results->pdata, results->len);
+  apply_results (self, results);
   gtk_widget_set_visible (GTK_WIDGET (self->search_busy), FALSE);
 
   if (results->len > 0)
@@ -22,39 +22,129 @@
 
 #include "bz-spdx.h"
 
+/* License expressions are memoized in a fixed open addressed table whose
+   slots are only ever filled once, so lookups and inserts from any thread
+   need nothing more than an atomic compare and swap. Once the table is
+   full, expressions are just analysed every time */
+#define MEMO_SLOTS 4096
+
+typedef struct
+{
+  char    *expression;
+  guint    hash;
+  gboolean floss;
+  gboolean proprietary;
+  char    *url;
+  char    *name;
+} SpdxInfo;
+
+static SpdxInfo *memo[MEMO_SLOTS] = { 0 };
+
+static SpdxInfo *
+spdx_info_new (const char *expression,
+               guint       hash)
+{
+  SpdxInfo *info = NULL;
+
+  info              = g_new0 (SpdxInfo, 1);
+  info->expression  = g_strdup (expression);
+  info->hash        = hash;
+  info->floss       = as_license_is_free_license (expression);
+  info->proprietary = g_str_has_prefix (expression, "LicenseRef-proprietary");
+  info->url         = as_get_license_url (expression);
+
+  if (info->proprietary)
+    info->name = g_strdup ("Proprietary");
+  else
+    {
+      info->name = as_license_to_spdx_id (expression);
+      if (info->name == NULL)
+        info->name = g_strdup (expression);
+    }
+
+  return info;
+}
+
+static void
+spdx_info_free (SpdxInfo *info)
+{
+  g_free (info->expression);
+  g_free (info->url);
+  g_free (info->name);
+  g_free (info);
+}
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SpdxInfo, spdx_info_free)
+
+/* If the table is full, the returned info is also handed back through
+   `uncached` for the caller to free */
+static const SpdxInfo *
+lookup (const char *expression,
+        SpdxInfo  **uncached)
+{
+  guint     hash  = 0;
+  SpdxInfo *fresh = NULL;
+
+  hash = g_str_hash (expression);
+  for (guint i = 0; i < MEMO_SLOTS; i++)
+    {
+      SpdxInfo **slot    = &memo[(hash + i) % MEMO_SLOTS];
+      SpdxInfo  *current = g_atomic_pointer_get (slot);
+
+      if (current == NULL)
+        {
+          if (fresh == NULL)
+            fresh = spdx_info_new (expression, hash);
+
+          if (g_atomic_pointer_compare_and_exchange (slot, NULL, fresh))
+            return fresh;
+
+          /* Another thread took this slot first */
+          current = g_atomic_pointer_get (slot);
+        }
+
+      if (current->hash == hash &&
+          g_strcmp0 (current->expression, expression) == 0)
+        {
+          if (fresh != NULL)
+            spdx_info_free (fresh);
+          return current;
+        }
+    }
+
+  if (fresh == NULL)
+    fresh = spdx_info_new (expression, hash);
+  *uncached = fresh;
+  return fresh;
+}
+
 gboolean
 bz_spdx_is_valid (const char *license_id)
 {
-  g_autofree char *url = NULL;
+  g_autoptr (SpdxInfo) uncached = NULL;
 
   g_return_val_if_fail (license_id != NULL, FALSE);
 
-  url = as_get_license_url (license_id);
-  return url != NULL;
+  return lookup (license_id, &uncached)->url != NULL;
 }
 
 char *
 bz_spdx_get_url (const char *license_id)
 {
+  g_autoptr (SpdxInfo) uncached = NULL;
+
   g_return_val_if_fail (license_id != NULL, NULL);
 
-  return as_get_license_url (license_id);
+  return g_strdup (lookup (license_id, &uncached)->url);
 }
 
 char *
 bz_spdx_get_name (const char *license_id)
 {
-  char *result = NULL;
-  g_return_val_if_fail (license_id != NULL, NULL);
-
-  if (bz_spdx_is_proprietary (license_id))
-    return g_strdup ("Proprietary");
+  g_autoptr (SpdxInfo) uncached = NULL;
 
-  result = as_license_to_spdx_id (license_id);
-  if (result == NULL)
-    return g_strdup (license_id);
+  g_return_val_if_fail (license_id != NULL, NULL);
 
-  return result;
+  return g_strdup (lookup (license_id, &uncached)->name);
 }
 
 gboolean
@@ -64,3 +154,13 @@ bz_spdx_is_proprietary (const char *license_id)
 
   return g_str_has_prefix (license_id, "LicenseRef-proprietary");
 }
+
+gboolean
+bz_spdx_is_floss (const char *license_id)
+{
+  g_autoptr (SpdxInfo) uncached = NULL;
+
+  g_return_val_if_fail (license_id != NULL, FALSE);
+
+  return lookup (license_id, &uncached)->floss;
+}
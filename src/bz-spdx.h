@@ -36,4 +36,7 @@ bz_spdx_get_name (const char *license_id);
 gboolean
 bz_spdx_is_proprietary (const char *license_id);
 
+gboolean
+bz_spdx_is_floss (const char *license_id);
+
 G_END_DECLS
@@ -21,7 +21,9 @@
 #include <glib/gi18n.h>
 #include <libdex.h>
 
+#include "bz-application.h"
 #include "bz-apps-page.h"
+#include "bz-catalog-index.h"
 #include "bz-flathub-state.h"
 #include "bz-tag-list.h"
 #include "bz-util.h"
@@ -138,6 +140,8 @@ tag_button_clicked_cb (BzTagList *self,
   g_autoptr (DexFuture) future = NULL;
   const char *tag              = NULL;
   g_autofree char *route       = NULL;
+  BzStateInfo    *state        = NULL;
+  BzCatalogIndex *index        = NULL;
 
   g_return_if_fail (BZ_IS_TAG_LIST (self));
   g_return_if_fail (GTK_IS_BUTTON (button));
@@ -153,8 +157,25 @@ tag_button_clicked_cb (BzTagList *self,
 
   g_object_set_data_full (G_OBJECT (self), "current-tag", g_strdup (tag), g_free);
 
-  route  = g_strdup_printf ("/collection/keyword?keyword=%s", tag);
-  future = bz_flathub_state_search_collection (self->flathub_state, route);
+  /* The local catalog answers straight away and offline, Flathub is only
+     asked about keywords none of our entries carry */
+  state = bz_state_info_get_default ();
+  if (state != NULL)
+    index = bz_state_info_get_catalog_index (state);
+  if (index != NULL)
+    {
+      g_autoptr (GListModel) local = NULL;
+
+      local = bz_catalog_index_dup_keyword (index, tag);
+      if (g_list_model_get_n_items (local) > 1)
+        future = dex_future_new_take_object (g_steal_pointer (&local));
+    }
+
+  if (future == NULL)
+    {
+      route  = g_strdup_printf ("/collection/keyword?keyword=%s", tag);
+      future = bz_flathub_state_search_collection (self->flathub_state, route);
+    }
   future = dex_future_finally (
       future,
       (DexFutureCallback) search_finally,
@@ -0,0 +1,285 @@
+/* bz-text-dictionary.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN  "BAZAAR::TEXT-DICTIONARY"
+#define BAZAAR_MODULE "text-dictionary"
+
+#define DICTIONARY_CAPACITY (112 * 1024)
+#define TRAIN_SAMPLE_COUNT  1000
+#define SAMPLE_MAX_BYTES    (16 * 1024)
+#define COMPRESSION_LEVEL   3
+
+/* Below this, frame overhead eats most of the savings */
+#define MIN_COMPRESS_BYTES 64
+
+/* Guards against corrupt frames claiming absurd sizes */
+#define MAX_DECOMPRESSED_BYTES (16 * 1024 * 1024)
+
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <libdex.h>
+#include <zdict.h>
+#include <zstd.h>
+
+#include "bz-env.h"
+#include "bz-io.h"
+#include "bz-text-dictionary.h"
+#include "bz-util.h"
+
+BZ_DEFINE_DATA (
+    train,
+    Train,
+    {
+      GByteArray *samples;
+      GArray     *sample_sizes;
+    },
+    BZ_RELEASE_DATA (samples, g_byte_array_unref);
+    BZ_RELEASE_DATA (sample_sizes, g_array_unref));
+
+/* The dictionaries are never freed once created, so they may be used
+   outside the lock */
+static GMutex      mutex        = { 0 };
+static gboolean    loaded       = FALSE;
+static gboolean    training     = FALSE;
+static ZSTD_CDict *cdict        = NULL;
+static ZSTD_DDict *ddict        = NULL;
+static GByteArray *samples      = NULL;
+static GArray     *sample_sizes = NULL;
+
+static DexFuture *
+train_fiber (TrainData *data);
+
+static char *
+dup_dictionary_path (void)
+{
+  g_autofree char *module_dir = NULL;
+
+  module_dir = bz_dup_module_dir ();
+  return g_build_filename (module_dir, "dictionary", NULL);
+}
+
+static void
+install_dictionary (gconstpointer dictionary,
+                    gsize         size)
+{
+  cdict = ZSTD_createCDict (dictionary, size, COMPRESSION_LEVEL);
+  ddict = ZSTD_createDDict (dictionary, size);
+  g_debug ("Using text dictionary %u", ZDICT_getDictID (dictionary, size));
+}
+
+static void
+ensure_loaded (void)
+{
+  g_autofree char *path          = NULL;
+  g_autofree char *contents      = NULL;
+  gsize            length        = 0;
+  g_autoptr (GError) local_error = NULL;
+
+  if (loaded)
+    return;
+  loaded = TRUE;
+
+  path = dup_dictionary_path ();
+  if (!g_file_get_contents (path, &contents, &length, &local_error))
+    {
+      if (!g_error_matches (local_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_warning ("Failed to read text dictionary at %s: %s", path, local_error->message);
+      return;
+    }
+
+  install_dictionary (contents, length);
+}
+
+static void
+add_sample (gconstpointer data,
+            gsize         size)
+{
+  g_autoptr (TrainData) train_data = NULL;
+  gsize sample_size                = 0;
+
+  if (training)
+    return;
+
+  if (samples == NULL)
+    {
+      samples      = g_byte_array_new ();
+      sample_sizes = g_array_new (FALSE, FALSE, sizeof (gsize));
+    }
+
+  sample_size = MIN (size, SAMPLE_MAX_BYTES);
+  g_byte_array_append (samples, data, sample_size);
+  g_array_append_val (sample_sizes, sample_size);
+
+  if (sample_sizes->len < TRAIN_SAMPLE_COUNT)
+    return;
+
+  training = TRUE;
+
+  train_data               = train_data_new ();
+  train_data->samples      = g_steal_pointer (&samples);
+  train_data->sample_sizes = g_steal_pointer (&sample_sizes);
+
+  dex_future_disown (dex_scheduler_spawn (
+      bz_get_io_scheduler (),
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) train_fiber,
+      train_data_ref (train_data),
+      train_data_unref));
+}
+
+static DexFuture *
+train_fiber (TrainData *data)
+{
+  g_autofree guint8 *dictionary   = NULL;
+  gsize              size         = 0;
+  g_autofree char   *path         = NULL;
+  g_autofree char   *dir          = NULL;
+  g_autoptr (GError) local_error  = NULL;
+  g_autoptr (GMutexLocker) locker = NULL;
+
+  dictionary = g_malloc (DICTIONARY_CAPACITY);
+  size       = ZDICT_trainFromBuffer (
+      dictionary, DICTIONARY_CAPACITY,
+      data->samples->data,
+      (const size_t *) data->sample_sizes->data,
+      data->sample_sizes->len);
+  if (ZDICT_isError (size))
+    {
+      /* Leave `training` set so this isn't attempted again */
+      g_warning ("Failed to train text dictionary from %u samples: %s",
+                 data->sample_sizes->len, ZDICT_getErrorName (size));
+      return dex_future_new_false ();
+    }
+
+  /* Only start compressing once the dictionary is safely on disk,
+     otherwise the cache could end up with text nothing can read */
+  path = dup_dictionary_path ();
+  dir  = g_path_get_dirname (path);
+  if (g_mkdir_with_parents (dir, 0755) != 0 ||
+      !g_file_set_contents (path, (const char *) dictionary, size, &local_error))
+    {
+      g_warning ("Failed to save text dictionary to %s: %s", path,
+                 local_error != NULL ? local_error->message : g_strerror (errno));
+      return dex_future_new_false ();
+    }
+
+  locker = g_mutex_locker_new (&mutex);
+  install_dictionary (dictionary, size);
+  g_debug ("Trained a %zu byte text dictionary from %u samples",
+           size, data->sample_sizes->len);
+
+  return dex_future_new_true ();
+}
+
+GBytes *
+bz_text_dictionary_compress (gconstpointer data,
+                             gsize         size)
+{
+  ZSTD_CDict        *dictionary = NULL;
+  g_autofree guint8 *buffer     = NULL;
+  gsize              bound      = 0;
+  gsize              compressed = 0;
+  ZSTD_CCtx         *cctx       = NULL;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (size < MIN_COMPRESS_BYTES)
+    return NULL;
+
+  g_mutex_lock (&mutex);
+  ensure_loaded ();
+  dictionary = cdict;
+  if (dictionary == NULL)
+    add_sample (data, size);
+  g_mutex_unlock (&mutex);
+
+  if (dictionary == NULL)
+    return NULL;
+
+  bound  = ZSTD_compressBound (size);
+  buffer = g_malloc (bound);
+
+  cctx       = ZSTD_createCCtx ();
+  compressed = ZSTD_compress_usingCDict (cctx, buffer, bound, data, size, dictionary);
+  ZSTD_freeCCtx (cctx);
+
+  if (ZSTD_isError (compressed) || compressed >= size)
+    return NULL;
+
+  return g_bytes_new_take (
+      g_realloc (g_steal_pointer (&buffer), compressed),
+      compressed);
+}
+
+GBytes *
+bz_text_dictionary_decompress (GBytes  *bytes,
+                               GError **error)
+{
+  ZSTD_DDict        *dictionary = NULL;
+  gconstpointer      data       = NULL;
+  gsize              size       = 0;
+  unsigned long long content    = 0;
+  g_autofree guint8 *buffer     = NULL;
+  gsize              result     = 0;
+  ZSTD_DCtx         *dctx       = NULL;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+
+  g_mutex_lock (&mutex);
+  ensure_loaded ();
+  dictionary = ddict;
+  g_mutex_unlock (&mutex);
+
+  if (dictionary == NULL)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                   "No text dictionary is available");
+      return NULL;
+    }
+
+  data    = g_bytes_get_data (bytes, &size);
+  content = ZSTD_getFrameContentSize (data, size);
+  if (content == ZSTD_CONTENTSIZE_UNKNOWN ||
+      content == ZSTD_CONTENTSIZE_ERROR ||
+      content > MAX_DECOMPRESSED_BYTES)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Compressed text has an invalid frame header");
+      return NULL;
+    }
+
+  buffer = g_malloc (MAX (content, 1));
+
+  dctx   = ZSTD_createDCtx ();
+  result = ZSTD_decompress_usingDDict (dctx, buffer, content, data, size, dictionary);
+  ZSTD_freeDCtx (dctx);
+
+  if (ZSTD_isError (result) || result != content)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Failed to decompress text: %s",
+                   ZSTD_isError (result) ? ZSTD_getErrorName (result) : "truncated frame");
+      return NULL;
+    }
+
+  return g_bytes_new_take (g_steal_pointer (&buffer), result);
+}
+
+/* End of bz-text-dictionary.c */
@@ -0,0 +1,45 @@
+/* bz-text-dictionary.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* Compresses cached text with a zstd dictionary trained on the catalog.
+   Until a dictionary exists, whatever is passed to
+   bz_text_dictionary_compress () is collected to train one, which is then
+   kept in the cache for as long as the cache itself. Safe to call from any
+   thread */
+
+/* Returns NULL if there is no dictionary yet or compressing wouldn't save
+   anything, in which case `data` should be stored as is */
+GBytes *
+bz_text_dictionary_compress (gconstpointer data,
+                             gsize         size);
+
+GBytes *
+bz_text_dictionary_decompress (GBytes  *bytes,
+                               GError **error);
+
+G_END_DECLS
+
+/* End of bz-text-dictionary.h */
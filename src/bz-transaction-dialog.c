@@ -27,6 +27,8 @@
 #include "bz-env.h"
 #include "bz-error.h"
 #include "bz-flatpak-entry.h"
+#include "bz-install-plan.h"
+#include "bz-install-preflight.h"
 #include "bz-safety-calculator.h"
 #include "bz-state-info.h"
 #include "bz-transaction-dialog.h"
@@ -492,13 +494,105 @@ BZ_DEFINE_DATA (
     },
     BZ_RELEASE_DATA (groups, g_object_unref));
 
+BZ_DEFINE_DATA (
+    install_plan_ready,
+    InstallPlanReady,
+    {
+      GWeakRef *dialog;
+      char     *key;
+    },
+    BZ_RELEASE_DATA (dialog, bz_weak_release);
+    BZ_RELEASE_DATA (key, g_free));
+
+/* Plans keyed by the sorted unique ids of the selection and the installed
+   runtimes, since installing or updating one changes what a plan pulls
+   in. Only touched from the main thread */
+#define INSTALL_PLAN_CACHE_MAX 32
+static GHashTable *install_plan_cache = NULL;
+
+static char *
+dup_install_plan_key (GPtrArray *entries)
+{
+  g_autoptr (GPtrArray) ids = NULL;
+  g_autofree char *stamp    = NULL;
+  g_autofree char *joined   = NULL;
+
+  ids = g_ptr_array_new_full (entries->len + 1, NULL);
+  for (guint i = 0; i < entries->len; i++)
+    g_ptr_array_add (ids, (gpointer) bz_entry_get_unique_id (g_ptr_array_index (entries, i)));
+  g_ptr_array_sort_values (ids, (GCompareFunc) g_strcmp0);
+  g_ptr_array_add (ids, NULL);
+
+  stamp  = bz_install_preflight_dup_runtimes_stamp ();
+  joined = g_strjoinv ("\n", (char **) ids->pdata);
+
+  return g_strdup_printf ("%s\n%s", stamp, joined);
+}
+
+static void
+apply_install_plan (AdwAlertDialog *dialog,
+                    BzInstallPlan  *plan)
+{
+  guint            n_shared       = 0;
+  g_autofree char *download_size  = NULL;
+  g_autofree char *installed_size = NULL;
+  g_autofree char *sizes          = NULL;
+  g_autofree char *body           = NULL;
+
+  n_shared       = bz_install_plan_get_n_runtimes (plan) + bz_install_plan_get_n_addons (plan);
+  download_size  = g_format_size (bz_install_plan_get_download_size (plan));
+  installed_size = g_format_size (bz_install_plan_get_installed_size (plan));
+
+  /* Translators: the first %s is a download size, the second an installed size */
+  sizes = g_strdup_printf (_ ("%s will be downloaded, using %s of disk space."),
+                           download_size, installed_size);
+
+  if (n_shared > 0)
+    body = g_strdup_printf (ngettext ("The following will be installed, along with %u shared component. %s",
+                                      "The following will be installed, along with %u shared components. %s",
+                                      n_shared),
+                            n_shared, sizes);
+  else
+    body = g_strdup_printf (_ ("The following will be installed. %s"), sizes);
+
+  adw_alert_dialog_set_body (dialog, body);
+}
+
+static DexFuture *
+install_plan_ready (DexFuture            *future,
+                    InstallPlanReadyData *data)
+{
+  g_autoptr (AdwAlertDialog) dialog = NULL;
+  BzInstallPlan *plan               = NULL;
+
+  plan = g_value_get_object (dex_future_get_value (future, NULL));
+
+  if (install_plan_cache == NULL)
+    install_plan_cache = g_hash_table_new_full (
+        g_str_hash, g_str_equal, g_free, g_object_unref);
+  else if (g_hash_table_size (install_plan_cache) >= INSTALL_PLAN_CACHE_MAX)
+    g_hash_table_remove_all (install_plan_cache);
+  g_hash_table_replace (install_plan_cache, g_strdup (data->key), g_object_ref (plan));
+
+  dialog = g_weak_ref_get (data->dialog);
+  if (dialog != NULL)
+    apply_install_plan (dialog, plan);
+
+  return dex_future_new_true ();
+}
+
 static DexFuture *
 bulk_install_dialog_fiber (BulkInstallDialogData *data)
 {
   g_autoptr (GError) local_error               = NULL;
   g_autoptr (BzBulkInstallDialogResult) result = NULL;
+  g_autoptr (GPtrArray) futures                = NULL;
   g_autoptr (GPtrArray) resolved_entries       = NULL;
   g_autoptr (GListStore) entries_store         = NULL;
+  g_autoptr (GCancellable) plan_cancellable    = NULL;
+  BzBackend       *backend                     = NULL;
+  g_autofree char *plan_key                    = NULL;
+  BzInstallPlan   *plan                        = NULL;
   AdwDialog       *dialog                      = NULL;
   g_autofree char *dialog_response             = NULL;
   g_autofree char *heading                     = NULL;
@@ -506,6 +600,7 @@ bulk_install_dialog_fiber (BulkInstallDialogData *data)
   gboolean         confirmed                   = FALSE;
 
   result           = bz_bulk_install_dialog_result_new ();
+  futures          = g_ptr_array_new_with_free_func (dex_unref);
   resolved_entries = g_ptr_array_new_with_free_func (g_object_unref);
 
   if (data->groups == NULL)
@@ -516,18 +611,36 @@ bulk_install_dialog_fiber (BulkInstallDialogData *data)
 
   n_groups = g_list_model_get_n_items (data->groups);
 
+  /* Resolve every group at once rather than one cache round-trip at a time */
   for (guint i = 0; i < n_groups; i++)
     {
       g_autoptr (BzEntryGroup) group = NULL;
-      g_autoptr (GListStore) store   = NULL;
-      g_autoptr (BzEntry) entry      = NULL;
 
       group = g_list_model_get_item (data->groups, i);
 
       if (bz_entry_group_get_removable (group) > 0)
         continue;
 
-      store = dex_await_object (bz_entry_group_dup_all_into_store (group), &local_error);
+      g_ptr_array_add (futures, bz_entry_group_dup_all_into_store (group));
+    }
+
+  if (futures->len > 0)
+    dex_await (dex_future_allv (
+                   (DexFuture *const *) futures->pdata,
+                   futures->len),
+               NULL);
+
+  for (guint i = 0; i < futures->len; i++)
+    {
+      const GValue *value       = NULL;
+      GListStore   *store       = NULL;
+      g_autoptr (BzEntry) entry = NULL;
+
+      value = dex_future_get_value (g_ptr_array_index (futures, i), NULL);
+      if (value == NULL)
+        continue;
+
+      store = g_value_get_object (value);
       if (store == NULL || g_list_model_get_n_items (G_LIST_MODEL (store)) == 0)
         continue;
 
@@ -581,11 +694,44 @@ bulk_install_dialog_fiber (BulkInstallDialogData *data)
   adw_alert_dialog_set_default_response (ADW_ALERT_DIALOG (dialog), "confirm");
   adw_alert_dialog_set_close_response (ADW_ALERT_DIALOG (dialog), "cancel");
 
+  plan_key = dup_install_plan_key (resolved_entries);
+  if (install_plan_cache != NULL)
+    plan = g_hash_table_lookup (install_plan_cache, plan_key);
+  backend = bz_state_info_get_backend (bz_state_info_get_default ());
+
+  if (plan != NULL)
+    apply_install_plan (ADW_ALERT_DIALOG (dialog), plan);
+  else if (backend != NULL)
+    {
+      g_autoptr (InstallPlanReadyData) ready_data = NULL;
+      g_autoptr (DexFuture) future                = NULL;
+
+      ready_data         = install_plan_ready_data_new ();
+      ready_data->dialog = bz_track_weak (dialog);
+      ready_data->key    = g_steal_pointer (&plan_key);
+
+      /* The dry run is only worth finishing while the dialog is up */
+      plan_cancellable = g_cancellable_new ();
+      future           = bz_backend_plan_installs (
+          backend,
+          (BzEntry **) resolved_entries->pdata,
+          resolved_entries->len,
+          plan_cancellable);
+      future = dex_future_then (
+          future,
+          (DexFutureCallback) install_plan_ready,
+          install_plan_ready_data_ref (ready_data),
+          install_plan_ready_data_unref);
+      dex_future_disown (g_steal_pointer (&future));
+    }
+
   adw_dialog_present (dialog, data->parent);
 
   dialog_response = dex_await_string (
       bz_make_alert_dialog_future (ADW_ALERT_DIALOG (dialog)),
       &local_error);
+  if (plan_cancellable != NULL)
+    g_cancellable_cancel (plan_cancellable);
 
   if (dialog_response == NULL)
     return dex_future_new_for_error (g_steal_pointer (&local_error));
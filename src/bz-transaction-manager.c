@@ -26,6 +26,7 @@
 
 #include "bz-backend-transaction-op-payload.h"
 #include "bz-backend-transaction-op-progress-payload.h"
+#include "bz-backend-transaction-progress-ring.h"
 #include "bz-env.h"
 #include "bz-marshalers.h"
 #include "bz-transaction-manager.h"
@@ -112,6 +113,13 @@ static guint signals[LAST_SIGNAL];
 static DexFuture *
 transaction_fiber (QueuedScheduleData *data);
 
+static void
+apply_tick (BzTransaction                      *transaction,
+            GObject                            *op,
+            GHashTable                         *op_set,
+            GHashTable                         *pending_set,
+            const BzBackendTransactionProgress *tick);
+
 static DexFuture *
 transaction_finally (DexFuture          *future,
                      QueuedScheduleData *data);
@@ -614,9 +622,14 @@ transaction_fiber (QueuedScheduleData *data)
   g_autoptr (DexChannel) channel        = NULL;
   g_autoptr (DexFuture) future          = NULL;
   g_autoptr (GHashTable) op_set         = NULL;
+  g_autoptr (GHashTable) id_to_op       = NULL;
   g_autoptr (GHashTable) pending_set    = NULL;
+  g_autoptr (GHashTable) early_ticks    = NULL;
+  guint          last_op_id             = 0;
   GHashTableIter iter                   = { 0 };
 
+  g_autofree BzBackendTransactionProgress *ticks = NULL;
+
   bz_weak_get_or_return_reject (self, data->self);
 
   g_object_set (
@@ -641,8 +654,13 @@ transaction_fiber (QueuedScheduleData *data)
       channel,
       dex_promise_get_cancellable (promise));
 
-  op_set      = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+  /* Maps each operation to the progress payload reused for all of its
+     ticks */
+  op_set      = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, g_object_unref);
+  id_to_op    = g_hash_table_new (g_direct_hash, g_direct_equal);
   pending_set = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+  early_ticks = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+  ticks       = g_new0 (BzBackendTransactionProgress, BZ_BACKEND_TRANSACTION_PROGRESS_RING_CAPACITY);
   for (;;)
     {
       g_autoptr (GObject) object = NULL;
@@ -653,6 +671,9 @@ transaction_fiber (QueuedScheduleData *data)
 
       if (BZ_IS_BACKEND_TRANSACTION_OP_PAYLOAD (object))
         {
+          guint op_id = 0;
+
+          op_id = bz_backend_transaction_op_payload_get_op_id (BZ_BACKEND_TRANSACTION_OP_PAYLOAD (object));
           if (g_hash_table_contains (op_set, object))
             {
               g_autofree char *error = NULL;
@@ -664,6 +685,7 @@ transaction_fiber (QueuedScheduleData *data)
               else
                 bz_transaction_finish_task (
                     transaction, BZ_BACKEND_TRANSACTION_OP_PAYLOAD (object));
+              g_hash_table_remove (id_to_op, GUINT_TO_POINTER (op_id));
               g_hash_table_remove (op_set, object);
 
               if (g_hash_table_contains (pending_set, object))
@@ -676,49 +698,79 @@ transaction_fiber (QueuedScheduleData *data)
             }
           else
             {
+              g_autoptr (BzBackendTransactionOpProgressPayload) progress = NULL;
+              g_autofree BzBackendTransactionProgress *early             = NULL;
+
               bz_transaction_add_task (
                   transaction, BZ_BACKEND_TRANSACTION_OP_PAYLOAD (object));
-              g_hash_table_replace (op_set, g_object_ref (object), NULL);
+
+              progress = bz_backend_transaction_op_progress_payload_new ();
+              bz_backend_transaction_op_progress_payload_set_op (
+                  progress, BZ_BACKEND_TRANSACTION_OP_PAYLOAD (object));
+
+              g_hash_table_replace (op_set, g_object_ref (object), g_steal_pointer (&progress));
+              g_hash_table_replace (id_to_op, GUINT_TO_POINTER (op_id), object);
+              last_op_id = MAX (op_id, last_op_id);
+
+              g_hash_table_steal_extended (
+                  early_ticks, GUINT_TO_POINTER (op_id),
+                  NULL, (gpointer *) &early);
+              if (early != NULL)
+                apply_tick (transaction, object, op_set, pending_set, early);
             }
         }
-      else if (BZ_IS_BACKEND_TRANSACTION_OP_PROGRESS_PAYLOAD (object))
+      else if (BZ_IS_BACKEND_TRANSACTION_PROGRESS_RING (object))
         {
-          const char *status         = NULL;
-          gboolean    is_estimating  = FALSE;
-          double      total_progress = 0.0;
+          guint                         n_ticks = 0;
+          BzBackendTransactionProgress *last    = NULL;
+          gboolean                      pending = FALSE;
+
+          /* Everything written since the ring was last drained arrives
+             with this one wakeup */
+          n_ticks = bz_backend_transaction_progress_ring_drain (
+              BZ_BACKEND_TRANSACTION_PROGRESS_RING (object),
+              ticks, BZ_BACKEND_TRANSACTION_PROGRESS_RING_CAPACITY);
+          for (guint i = 0; i < n_ticks; i++)
+            {
+              BzBackendTransactionProgress *tick = &ticks[i];
+              GObject                      *op   = NULL;
+
+              op = g_hash_table_lookup (id_to_op, GUINT_TO_POINTER (tick->op_id));
+              if (op != NULL)
+                apply_tick (transaction, op, op_set, pending_set, tick);
+              else if (tick->op_id > last_op_id)
+                /* The ring can wake us before the channel delivers the
+                   payload of a newly started operation. Operation IDs are
+                   handed out in order, so hold on to the latest tick until
+                   it arrives */
+                g_hash_table_replace (
+                    early_ticks, GUINT_TO_POINTER (tick->op_id),
+                    g_memdup2 (tick, sizeof (*tick)));
+              else
+                /* The operation has already finished */
+                continue;
 
-          bz_transaction_update_task (
-              transaction, BZ_BACKEND_TRANSACTION_OP_PROGRESS_PAYLOAD (object));
+              last = tick;
+            }
 
-          status = bz_backend_transaction_op_progress_payload_get_status (
-              BZ_BACKEND_TRANSACTION_OP_PROGRESS_PAYLOAD (object));
-          is_estimating = bz_backend_transaction_op_progress_payload_get_is_estimating (
-              BZ_BACKEND_TRANSACTION_OP_PROGRESS_PAYLOAD (object));
-          total_progress = bz_backend_transaction_op_progress_payload_get_total_progress (
-              BZ_BACKEND_TRANSACTION_OP_PROGRESS_PAYLOAD (object));
+          if (last == NULL)
+            continue;
 
           g_object_set (
               transaction,
-              "pending", is_estimating,
-              "status", status,
-              "progress", total_progress,
+              "pending", last->is_estimating,
+              "status", last->status,
+              "progress", last->total_progress,
               NULL);
 
-          self->current_progress = total_progress;
+          self->current_progress = last->total_progress;
           g_object_notify_by_pspec (G_OBJECT (self), props[PROP_CURRENT_PROGRESS]);
 
-          if (is_estimating && !g_hash_table_contains (pending_set, object))
+          pending = g_hash_table_size (pending_set) ==
+                    g_hash_table_size (op_set);
+          if (pending != self->pending)
             {
-              g_hash_table_replace (pending_set, g_object_ref (object), NULL);
-              self->pending = g_hash_table_size (pending_set) ==
-                              g_hash_table_size (op_set);
-              g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PENDING]);
-            }
-          else if (!is_estimating && g_hash_table_contains (pending_set, object))
-            {
-              g_hash_table_remove (pending_set, object);
-              self->pending = g_hash_table_size (pending_set) ==
-                              g_hash_table_size (op_set);
+              self->pending = pending;
               g_object_notify_by_pspec (G_OBJECT (self), props[PROP_PENDING]);
             }
         }
@@ -747,6 +799,41 @@ transaction_fiber (QueuedScheduleData *data)
   return dex_future_new_true ();
 }
 
+static void
+apply_tick (BzTransaction                      *transaction,
+            GObject                            *op,
+            GHashTable                         *op_set,
+            GHashTable                         *pending_set,
+            const BzBackendTransactionProgress *tick)
+{
+  BzBackendTransactionOpProgressPayload *progress = NULL;
+
+  progress = g_hash_table_lookup (op_set, op);
+
+  bz_backend_transaction_op_progress_payload_set_status (
+      progress, tick->status);
+  bz_backend_transaction_op_progress_payload_set_is_estimating (
+      progress, tick->is_estimating);
+  bz_backend_transaction_op_progress_payload_set_progress (
+      progress, tick->progress);
+  bz_backend_transaction_op_progress_payload_set_total_progress (
+      progress, tick->total_progress);
+  bz_backend_transaction_op_progress_payload_set_bytes_transferred (
+      progress, tick->bytes_transferred);
+  bz_backend_transaction_op_progress_payload_set_start_time (
+      progress, tick->start_time);
+
+  bz_transaction_update_task (transaction, progress);
+
+  if (tick->is_estimating)
+    {
+      if (!g_hash_table_contains (pending_set, op))
+        g_hash_table_replace (pending_set, g_object_ref (op), NULL);
+    }
+  else
+    g_hash_table_remove (pending_set, op);
+}
+
 static DexFuture *
 transaction_finally (DexFuture          *future,
                      QueuedScheduleData *data)
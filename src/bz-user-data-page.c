@@ -22,10 +22,13 @@
 
 #include "bz-application-map-factory.h"
 #include "bz-env.h"
+#include "bz-error.h"
 #include "bz-io.h"
+#include "bz-reap-progress.h"
 #include "bz-user-data-page.h"
 #include "bz-user-data-tile.h"
 #include "bz-util.h"
+#include "bz-window.h"
 
 struct _BzUserDataPage
 {
@@ -33,9 +36,12 @@ struct _BzUserDataPage
 
   BzStateInfo *state;
   GListModel  *model;
+  DexFuture   *delete_all;
 
   /* Template widgets */
-  AdwViewStack *stack;
+  AdwViewStack   *stack;
+  GtkButton      *delete_all_button;
+  GtkProgressBar *progress_bar;
 };
 
 G_DEFINE_FINAL_TYPE (BzUserDataPage, bz_user_data_page, ADW_TYPE_NAVIGATION_PAGE)
@@ -54,6 +60,21 @@ static GParamSpec *props[LAST_PROP] = { 0 };
 static DexFuture *
 fetch_user_data_fiber (GWeakRef *wr);
 
+BZ_DEFINE_DATA (
+    delete_all,
+    DeleteAll,
+    {
+      GWeakRef  *self;
+      GPtrArray *groups;
+    },
+    BZ_RELEASE_DATA (self, bz_weak_release);
+    BZ_RELEASE_DATA (groups, g_ptr_array_unref));
+static DexFuture *
+delete_all_fiber (DeleteAllData *data);
+static DexFuture *
+delete_all_finally (DexFuture *future,
+                    GWeakRef  *wr);
+
 static void
 items_changed (BzUserDataPage *self,
                guint           position,
@@ -73,6 +94,7 @@ bz_user_data_page_dispose (GObject *object)
     g_signal_handlers_disconnect_by_func (self->model, items_changed, self);
   g_clear_object (&self->model);
   g_clear_object (&self->state);
+  dex_clear (&self->delete_all);
 
   G_OBJECT_CLASS (bz_user_data_page_parent_class)->dispose (object);
 }
@@ -140,6 +162,40 @@ is_zero (gpointer object,
   return value == 0;
 }
 
+static void
+delete_all_cb (BzUserDataPage *self,
+              GtkButton      *button)
+{
+  g_autoptr (DeleteAllData) data = NULL;
+  guint n_items                 = 0;
+
+  if (self->model == NULL ||
+      self->delete_all != NULL)
+    return;
+
+  n_items = g_list_model_get_n_items (self->model);
+  if (n_items == 0)
+    return;
+
+  data         = delete_all_data_new ();
+  data->self   = bz_track_weak (self);
+  data->groups = g_ptr_array_new_full (n_items, g_object_unref);
+  for (guint i = 0; i < n_items; i++)
+    g_ptr_array_add (data->groups, g_list_model_get_item (self->model, i));
+
+  gtk_widget_set_sensitive (GTK_WIDGET (self->delete_all_button), FALSE);
+
+  self->delete_all = dex_scheduler_spawn (
+      dex_scheduler_get_default (),
+      bz_get_dex_stack_size (),
+      (DexFiberFunc) delete_all_fiber,
+      delete_all_data_ref (data), delete_all_data_unref);
+  self->delete_all = dex_future_finally (
+      self->delete_all,
+      (DexFutureCallback) delete_all_finally,
+      bz_track_weak (self), bz_weak_release);
+}
+
 static void
 bz_user_data_page_class_init (BzUserDataPageClass *klass)
 {
@@ -171,7 +227,10 @@ bz_user_data_page_class_init (BzUserDataPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (widget_class, "/io/github/kolunmi/Bazaar/bz-user-data-page.ui");
   gtk_widget_class_bind_template_child (widget_class, BzUserDataPage, stack);
+  gtk_widget_class_bind_template_child (widget_class, BzUserDataPage, delete_all_button);
+  gtk_widget_class_bind_template_child (widget_class, BzUserDataPage, progress_bar);
   gtk_widget_class_bind_template_callback (widget_class, is_zero);
+  gtk_widget_class_bind_template_callback (widget_class, delete_all_cb);
 }
 
 static void
@@ -201,36 +260,121 @@ items_changed (BzUserDataPage *self,
 static void
 set_page (BzUserDataPage *self)
 {
-  if (self->model != NULL &&
-      g_list_model_get_n_items (G_LIST_MODEL (self->model)) > 0)
-    adw_view_stack_set_visible_child_name (self->stack, "content");
-  else
-    adw_view_stack_set_visible_child_name (self->stack, "empty");
+  gboolean has_items = FALSE;
+
+  has_items = self->model != NULL &&
+              g_list_model_get_n_items (G_LIST_MODEL (self->model)) > 0;
+
+  adw_view_stack_set_visible_child_name (self->stack, has_items ? "content" : "empty");
+  gtk_widget_set_visible (GTK_WIDGET (self->delete_all_button), has_items);
+}
+
+static gint
+cmp_user_data_size (BzEntryGroup **a,
+                    BzEntryGroup **b)
+{
+  guint64 a_size = bz_entry_group_get_user_data_size (*a);
+  guint64 b_size = bz_entry_group_get_user_data_size (*b);
+
+  if (a_size != b_size)
+    return a_size > b_size ? -1 : 1;
+  return 0;
 }
 
-static int
-compare_entry_groups_by_title (BzEntryGroup *group_a,
-                               BzEntryGroup *group_b)
+static void
+add_usages (BzUserDataPage *self,
+            GPtrArray      *usages,
+            GHashTable     *installed_ids)
 {
-  const char *title_a = bz_entry_group_get_title (group_a);
-  const char *title_b = bz_entry_group_get_title (group_b);
-  return g_utf8_collate (title_a, title_b);
+  g_autoptr (GHashTable) sizes      = NULL;
+  g_autoptr (GtkStringList) id_list = NULL;
+  BzApplicationMapFactory *factory  = NULL;
+  g_autoptr (GListModel) model      = NULL;
+  g_autoptr (GPtrArray) batch       = NULL;
+  g_autoptr (GPtrArray) merged      = NULL;
+  guint n_items                     = 0;
+  guint n_existing                  = 0;
+  guint position                    = 0;
+
+  sizes   = g_hash_table_new (g_str_hash, g_str_equal);
+  id_list = gtk_string_list_new (NULL);
+  for (guint i = 0; i < usages->len; i++)
+    {
+      BzUserDataUsage *usage = g_ptr_array_index (usages, i);
+
+      if (g_hash_table_contains (installed_ids, usage->app_id))
+        continue;
+
+      g_hash_table_replace (sizes, usage->app_id, usage);
+      gtk_string_list_append (id_list, usage->app_id);
+    }
+
+  factory = bz_state_info_get_application_factory (self->state);
+  model   = bz_application_map_factory_generate (factory, G_LIST_MODEL (id_list));
+
+  n_items = g_list_model_get_n_items (model);
+  batch   = g_ptr_array_new_full (n_items, g_object_unref);
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr (BzEntryGroup) group = NULL;
+      const char *id                 = NULL;
+      BzUserDataUsage *usage         = NULL;
+
+      group = g_list_model_get_item (model, i);
+      id    = bz_entry_group_get_id (group);
+      if (id != NULL)
+        usage = g_hash_table_lookup (sizes, id);
+      if (usage != NULL)
+        bz_entry_group_set_user_data_size (group, usage->size);
+
+      g_ptr_array_add (batch, g_steal_pointer (&group));
+    }
+  if (batch->len == 0)
+    return;
+  g_ptr_array_sort (batch, (GCompareFunc) cmp_user_data_size);
+
+  /* Batches arrive in no particular order, so merge this one into the rows
+     we already have to keep the largest first. Everything before the first
+     row of the batch stays put, and the rest is replaced in one splice */
+  n_existing = g_list_model_get_n_items (self->model);
+  merged     = g_ptr_array_new_full (n_existing + batch->len, g_object_unref);
+  for (guint i = 0, j = 0; i < n_existing || j < batch->len;)
+    {
+      g_autoptr (BzEntryGroup) existing = NULL;
+
+      if (i < n_existing)
+        existing = g_list_model_get_item (self->model, i);
+
+      if (existing != NULL &&
+          (j >= batch->len ||
+           cmp_user_data_size (&existing, (BzEntryGroup **) &batch->pdata[j]) <= 0))
+        {
+          if (merged->len == 0 && j == 0)
+            position++;
+          else
+            g_ptr_array_add (merged, g_steal_pointer (&existing));
+          i++;
+        }
+      else
+        g_ptr_array_add (merged, g_object_ref (g_ptr_array_index (batch, j++)));
+    }
+
+  g_list_store_splice (
+      G_LIST_STORE (self->model),
+      position, n_existing - position,
+      merged->pdata, merged->len);
 }
 
 static DexFuture *
 fetch_user_data_fiber (GWeakRef *wr)
 {
   g_autoptr (BzUserDataPage) self      = NULL;
-  g_autoptr (GHashTable) ids_hash      = NULL;
+  g_autoptr (DexChannel) batches       = NULL;
+  g_autoptr (DexFuture) scan           = NULL;
+  g_autoptr (GPtrArray) usages         = NULL;
   g_autoptr (GError) local_error       = NULL;
-  GHashTableIter iter                  = { 0 };
-  g_autoptr (GtkStringList) id_list    = NULL;
-  BzApplicationMapFactory *factory     = NULL;
-  g_autoptr (GListModel) model         = NULL;
-  g_autoptr (GListStore) sorted_store  = NULL;
   GListModel *installed_groups         = NULL;
   g_autoptr (GHashTable) installed_ids = NULL;
-  guint n_items;
 
   self = g_weak_ref_get (wr);
   if (self == NULL)
@@ -254,52 +398,202 @@ fetch_user_data_fiber (GWeakRef *wr)
         }
     }
 
-  ids_hash = dex_await_boxed (
-      bz_get_user_data_ids_dex (),
-      &local_error);
+  if (self->model != NULL)
+    g_signal_handlers_disconnect_by_func (self->model, items_changed, self);
+
+  /* The loading page stays up until the first rows arrive */
+  g_clear_object (&self->model);
+  self->model = G_LIST_MODEL (g_list_store_new (BZ_TYPE_ENTRY_GROUP));
+  g_signal_connect_swapped (self->model, "items-changed", G_CALLBACK (items_changed), self);
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_MODEL]);
+  g_clear_object (&self);
+
+  /* Sizes are measured by the same background scan that finds the
+     directories, so the rows never have to walk them again */
+  batches = dex_channel_new (0);
+  scan    = bz_scan_user_data_dex (batches);
+  for (;;)
+    {
+      g_autoptr (GPtrArray) batch = NULL;
+
+      batch = dex_await_boxed (dex_channel_receive (batches), NULL);
+      if (batch == NULL)
+        break;
+
+      self = g_weak_ref_get (wr);
+      if (self == NULL)
+        return dex_future_new_reject (G_IO_ERROR, G_IO_ERROR_CANCELLED, "Page destroyed");
+      add_usages (self, batch, installed_ids);
+      g_clear_object (&self);
+    }
+
+  usages = dex_await_boxed (dex_ref (scan), &local_error);
 
-  if (ids_hash == NULL)
+  self = g_weak_ref_get (wr);
+  if (self == NULL)
+    return dex_future_new_reject (G_IO_ERROR, G_IO_ERROR_CANCELLED, "Page destroyed");
+
+  set_page (self);
+  if (usages == NULL)
     {
       g_warning ("Failed to enumerate user data directories: %s",
                  local_error->message);
       return dex_future_new_for_error (g_steal_pointer (&local_error));
     }
 
-  id_list = gtk_string_list_new (NULL);
-  g_hash_table_iter_init (&iter, ids_hash);
+  return dex_future_new_true ();
+}
+
+static DexFuture *
+delete_all_fiber (DeleteAllData *data)
+{
+  g_autoptr (GStrvBuilder) builder = NULL;
+  g_auto (GStrv) paths             = NULL;
+  g_autoptr (DexChannel) channel   = NULL;
+  g_autoptr (DexFuture) reap       = NULL;
+  g_autoptr (BzReapProgress) total = NULL;
+  g_autoptr (GError) local_error   = NULL;
+  g_autoptr (GPtrArray) remaining  = NULL;
+  g_autoptr (BzUserDataPage) self  = NULL;
+  GtkRoot         *root            = NULL;
+  AdwDialog       *alert           = NULL;
+  g_autofree char *response        = NULL;
+  g_autofree char *size_string     = NULL;
+  g_autofree char *message         = NULL;
+
+  /* Unlike trashing a single app's data, this can't be undone */
+  self = g_weak_ref_get (data->self);
+  if (self == NULL)
+    return dex_future_new_true ();
+
+  alert = adw_alert_dialog_new (NULL, NULL);
+  adw_alert_dialog_format_heading (
+      ADW_ALERT_DIALOG (alert),
+      _ ("Delete All Leftover User Data?"));
+  adw_alert_dialog_format_body (
+      ADW_ALERT_DIALOG (alert),
+      _ ("The data of %u uninstalled apps will be permanently deleted. This "
+         "cannot be undone."),
+      data->groups->len);
+  adw_alert_dialog_add_responses (
+      ADW_ALERT_DIALOG (alert),
+      "cancel", _ ("Cancel"),
+      "delete", _ ("Delete"),
+      NULL);
+  adw_alert_dialog_set_close_response (ADW_ALERT_DIALOG (alert), "cancel");
+  adw_alert_dialog_set_default_response (ADW_ALERT_DIALOG (alert), "cancel");
+  adw_alert_dialog_set_response_appearance (
+      ADW_ALERT_DIALOG (alert), "delete", ADW_RESPONSE_DESTRUCTIVE);
+
+  adw_dialog_present (alert, GTK_WIDGET (self));
+  g_clear_object (&self);
+
+  response = dex_await_string (
+      bz_make_alert_dialog_future (ADW_ALERT_DIALOG (alert)),
+      NULL);
+  if (g_strcmp0 (response, "delete") != 0)
+    return dex_future_new_true ();
+
+  self = g_weak_ref_get (data->self);
+  if (self == NULL)
+    return dex_future_new_true ();
+  gtk_progress_bar_set_fraction (self->progress_bar, 0.0);
+  gtk_widget_set_visible (GTK_WIDGET (self->progress_bar), TRUE);
+  g_clear_object (&self);
+
+  builder = g_strv_builder_new ();
+  for (guint i = 0; i < data->groups->len; i++)
+    {
+      BzEntryGroup *group = g_ptr_array_index (data->groups, i);
+      const char   *id    = bz_entry_group_get_id (group);
+
+      if (id != NULL)
+        {
+          g_autofree char *path = NULL;
+
+          path = bz_dup_user_data_path (id);
+          g_strv_builder_add (builder, path);
+        }
+    }
+  paths = g_strv_builder_end (builder);
+
+  /* Every directory is reaped by one batch on a fixed set of workers, and
+     its running totals drive the progress bar until the channel closes */
+  channel = dex_channel_new (0);
+  reap    = bz_reap_paths_dex ((const char *const *) paths, channel);
   for (;;)
     {
-      char *app_id = NULL;
+      g_autoptr (BzReapProgress) progress = NULL;
+      g_autoptr (BzUserDataPage) page     = NULL;
 
-      if (!g_hash_table_iter_next (&iter, (gpointer *) &app_id, NULL))
+      progress = dex_await_object (dex_channel_receive (channel), NULL);
+      if (progress == NULL)
         break;
 
-      if (!g_hash_table_contains (installed_ids, app_id))
-        gtk_string_list_append (id_list, app_id);
+      page = g_weak_ref_get (data->self);
+      if (page != NULL)
+        gtk_progress_bar_set_fraction (
+            page->progress_bar,
+            (double) bz_reap_progress_get_paths_done (progress) /
+                (double) MAX (bz_reap_progress_get_paths_total (progress), 1));
     }
 
-  factory = bz_state_info_get_application_factory (self->state);
-  model   = bz_application_map_factory_generate (factory, G_LIST_MODEL (id_list));
+  total = dex_await_object (dex_ref (reap), &local_error);
 
-  sorted_store = g_list_store_new (BZ_TYPE_ENTRY_GROUP);
-  n_items      = g_list_model_get_n_items (model);
-  for (guint i = 0; i < n_items; i++)
+  self = g_weak_ref_get (data->self);
+  if (self == NULL)
+    return dex_future_new_true ();
+
+  if (total == NULL)
     {
-      g_autoptr (BzEntryGroup) group = g_list_model_get_item (model, i);
-      g_list_store_append (sorted_store, group);
+      g_warning ("Failed to delete user data: %s", local_error->message);
+      return dex_future_new_for_error (g_steal_pointer (&local_error));
     }
-  g_list_store_sort (sorted_store, (GCompareDataFunc) compare_entry_groups_by_title, NULL);
 
-  if (self->model != NULL)
-    g_signal_handlers_disconnect_by_func (self->model, items_changed, self);
+  /* Keep only what could not be deleted */
+  remaining = g_ptr_array_new_with_free_func (g_object_unref);
+  for (guint i = 0; i < data->groups->len; i++)
+    {
+      BzEntryGroup    *group = g_ptr_array_index (data->groups, i);
+      const char      *id    = bz_entry_group_get_id (group);
+      g_autofree char *path  = NULL;
 
-  g_clear_object (&self->model);
-  self->model = G_LIST_MODEL (g_steal_pointer (&sorted_store));
+      if (id != NULL)
+        path = bz_dup_user_data_path (id);
 
-  g_signal_connect_swapped (self->model, "items-changed", G_CALLBACK (items_changed), self);
-  set_page (self);
+      if (path != NULL && !g_file_test (path, G_FILE_TEST_EXISTS))
+        bz_entry_group_set_user_data_size (group, 0);
+      else
+        g_ptr_array_add (remaining, g_object_ref (group));
+    }
 
-  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_MODEL]);
+  if (self->model != NULL && G_IS_LIST_STORE (self->model))
+    g_list_store_splice (
+        G_LIST_STORE (self->model),
+        0, g_list_model_get_n_items (self->model),
+        remaining->pdata, remaining->len);
+
+  size_string = g_format_size (bz_reap_progress_get_bytes_freed (total));
+  message     = g_strdup_printf (_ ("Deleted %s of User Data"), size_string);
+
+  root = gtk_widget_get_root (GTK_WIDGET (self));
+  if (root != NULL && BZ_IS_WINDOW (root))
+    bz_window_add_toast (BZ_WINDOW (root), adw_toast_new (message));
 
   return dex_future_new_true ();
 }
+
+static DexFuture *
+delete_all_finally (DexFuture *future,
+                    GWeakRef  *wr)
+{
+  g_autoptr (BzUserDataPage) self = NULL;
+
+  bz_weak_get_or_return_reject (self, wr);
+
+  dex_clear (&self->delete_all);
+  gtk_widget_set_visible (GTK_WIDGET (self->progress_bar), FALSE);
+  gtk_widget_set_sensitive (GTK_WIDGET (self->delete_all_button), TRUE);
+
+  return dex_ref (future);
+}
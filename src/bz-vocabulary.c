@@ -0,0 +1,287 @@
+/* bz-vocabulary.c
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "BAZAAR::VOCABULARY"
+
+#include <gtk/gtk.h>
+
+#include "bz-flathub-category.h"
+#include "bz-vocabulary.h"
+
+struct _BzVocabulary
+{
+  GRWLock lock;
+
+  /* string -> ID */
+  GHashTable *ids;
+  /* ID - 1 -> string */
+  GPtrArray *strings;
+  /* ID - 1 -> object */
+  GPtrArray *objects;
+
+  GType item_type;
+  char *(*item_to_string) (gpointer item);
+  gpointer (*item_new) (const char *string);
+};
+
+static char *
+category_to_string (BzFlathubCategory *category)
+{
+  return g_strdup (bz_flathub_category_get_name (category));
+}
+
+static gpointer
+category_new (const char *name)
+{
+  BzFlathubCategory *category = NULL;
+
+  category = bz_flathub_category_new ();
+  bz_flathub_category_set_name (category, name);
+
+  return category;
+}
+
+static char *
+keyword_to_string (GtkStringObject *string)
+{
+  return g_strdup (gtk_string_object_get_string (string));
+}
+
+static gpointer
+keyword_new (const char *keyword)
+{
+  return gtk_string_object_new (keyword);
+}
+
+static BzVocabulary *
+vocabulary_new (GType item_type,
+                char *(*item_to_string) (gpointer item),
+                gpointer (*item_new) (const char *string))
+{
+  BzVocabulary *self = NULL;
+
+  self = g_new0 (BzVocabulary, 1);
+  g_rw_lock_init (&self->lock);
+
+  self->ids            = g_hash_table_new (g_str_hash, g_str_equal);
+  self->strings        = g_ptr_array_new_with_free_func (g_free);
+  self->objects        = g_ptr_array_new_with_free_func (g_object_unref);
+  self->item_type      = item_type;
+  self->item_to_string = item_to_string;
+  self->item_new       = item_new;
+
+  return self;
+}
+
+BzVocabulary *
+bz_vocabulary_get_categories (void)
+{
+  static BzVocabulary *vocabulary = NULL;
+
+  if (g_once_init_enter_pointer (&vocabulary))
+    g_once_init_leave_pointer (
+        &vocabulary,
+        vocabulary_new (
+            BZ_TYPE_FLATHUB_CATEGORY,
+            (gpointer) category_to_string,
+            category_new));
+
+  return vocabulary;
+}
+
+BzVocabulary *
+bz_vocabulary_get_keywords (void)
+{
+  static BzVocabulary *vocabulary = NULL;
+
+  if (g_once_init_enter_pointer (&vocabulary))
+    g_once_init_leave_pointer (
+        &vocabulary,
+        vocabulary_new (
+            GTK_TYPE_STRING_OBJECT,
+            (gpointer) keyword_to_string,
+            keyword_new));
+
+  return vocabulary;
+}
+
+guint
+bz_vocabulary_intern (BzVocabulary *self,
+                      const char   *string)
+{
+  guint id = 0;
+
+  g_return_val_if_fail (self != NULL, 0);
+  g_return_val_if_fail (string != NULL, 0);
+
+  id = bz_vocabulary_lookup (self, string);
+  if (id != 0)
+    return id;
+
+  g_rw_lock_writer_lock (&self->lock);
+
+  /* Somebody else may have added it in the meantime */
+  id = GPOINTER_TO_UINT (g_hash_table_lookup (self->ids, string));
+  if (id == 0)
+    {
+      char *copy = g_strdup (string);
+
+      g_ptr_array_add (self->strings, copy);
+      g_ptr_array_add (self->objects, self->item_new (copy));
+      id = self->strings->len;
+      g_hash_table_replace (self->ids, copy, GUINT_TO_POINTER (id));
+    }
+
+  g_rw_lock_writer_unlock (&self->lock);
+  return id;
+}
+
+guint
+bz_vocabulary_lookup (BzVocabulary *self,
+                      const char   *string)
+{
+  guint id = 0;
+
+  g_return_val_if_fail (self != NULL, 0);
+  g_return_val_if_fail (string != NULL, 0);
+
+  g_rw_lock_reader_lock (&self->lock);
+  id = GPOINTER_TO_UINT (g_hash_table_lookup (self->ids, string));
+  g_rw_lock_reader_unlock (&self->lock);
+
+  return id;
+}
+
+const char *
+bz_vocabulary_get_string (BzVocabulary *self,
+                          guint         id)
+{
+  const char *string = NULL;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  /* Strings are never freed or moved once interned, only the array holding
+     the pointers to them may be reallocated */
+  g_rw_lock_reader_lock (&self->lock);
+  if (id > 0 && id <= self->strings->len)
+    string = g_ptr_array_index (self->strings, id - 1);
+  g_rw_lock_reader_unlock (&self->lock);
+
+  return string;
+}
+
+guint *
+bz_vocabulary_intern_model (BzVocabulary *self,
+                            GListModel   *model)
+{
+  guint  n_items = 0;
+  guint *ids     = NULL;
+  guint  n_ids   = 0;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  if (model == NULL)
+    return NULL;
+
+  n_items = g_list_model_get_n_items (model);
+  if (n_items == 0)
+    return NULL;
+
+  ids = g_new0 (guint, n_items + 1);
+  for (guint i = 0; i < n_items; i++)
+    {
+      g_autoptr (GObject) item = NULL;
+      g_autofree char *string  = NULL;
+      guint id                 = 0;
+
+      item = g_list_model_get_item (model, i);
+      if (!G_TYPE_CHECK_INSTANCE_TYPE (item, self->item_type))
+        continue;
+
+      string = self->item_to_string (item);
+      if (string == NULL)
+        continue;
+
+      id = bz_vocabulary_intern (self, string);
+      if (!bz_vocabulary_ids_contain (ids, id))
+        ids[n_ids++] = id;
+    }
+
+  if (n_ids == 0)
+    g_clear_pointer (&ids, g_free);
+  return ids;
+}
+
+GListModel *
+bz_vocabulary_dup_model (BzVocabulary *self,
+                         const guint  *ids)
+{
+  g_autoptr (GListStore) store  = NULL;
+  g_autoptr (GPtrArray) objects = NULL;
+
+  g_return_val_if_fail (self != NULL, NULL);
+
+  store = g_list_store_new (self->item_type);
+  if (ids == NULL)
+    return G_LIST_MODEL (g_steal_pointer (&store));
+
+  objects = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_rw_lock_reader_lock (&self->lock);
+  for (const guint *id = ids; *id != 0; id++)
+    {
+      if (*id <= self->objects->len)
+        g_ptr_array_add (objects, g_object_ref (g_ptr_array_index (self->objects, *id - 1)));
+    }
+  g_rw_lock_reader_unlock (&self->lock);
+
+  g_list_store_splice (store, 0, 0, objects->pdata, objects->len);
+  return G_LIST_MODEL (g_steal_pointer (&store));
+}
+
+guint *
+bz_vocabulary_ids_dup (const guint *ids)
+{
+  gsize n_ids = 0;
+
+  if (ids == NULL)
+    return NULL;
+
+  while (ids[n_ids] != 0)
+    n_ids++;
+
+  return g_memdup2 (ids, (n_ids + 1) * sizeof (*ids));
+}
+
+gboolean
+bz_vocabulary_ids_contain (const guint *ids,
+                           guint        id)
+{
+  if (ids == NULL || id == 0)
+    return FALSE;
+
+  for (const guint *p = ids; *p != 0; p++)
+    {
+      if (*p == id)
+        return TRUE;
+    }
+
+  return FALSE;
+}
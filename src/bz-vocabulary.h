@@ -0,0 +1,70 @@
+/* bz-vocabulary.h
+ *
+ * Copyright 2025 Adam Masciola
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* A process-wide table of distinct strings, each given a small integer ID
+   starting from 1 and one shared object to stand in for it in list
+   models. 0 is never a valid ID, so ID lists are zero terminated */
+typedef struct _BzVocabulary BzVocabulary;
+
+/* Strings are category names, objects are BzFlathubCategory */
+BzVocabulary *
+bz_vocabulary_get_categories (void);
+
+/* Strings are keywords, objects are GtkStringObject */
+BzVocabulary *
+bz_vocabulary_get_keywords (void);
+
+guint
+bz_vocabulary_intern (BzVocabulary *self,
+                      const char   *string);
+
+/* Returns 0 if `string` was never interned */
+guint
+bz_vocabulary_lookup (BzVocabulary *self,
+                      const char   *string);
+
+const char *
+bz_vocabulary_get_string (BzVocabulary *self,
+                          guint         id);
+
+/* Returns a zero terminated array of the IDs of every item in `model`, or
+   NULL if it is empty */
+guint *
+bz_vocabulary_intern_model (BzVocabulary *self,
+                            GListModel   *model);
+
+GListModel *
+bz_vocabulary_dup_model (BzVocabulary *self,
+                         const guint  *ids);
+
+guint *
+bz_vocabulary_ids_dup (const guint *ids);
+
+gboolean
+bz_vocabulary_ids_contain (const guint *ids,
+                           guint        id);
+
+G_END_DECLS
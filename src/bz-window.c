@@ -55,14 +55,21 @@ struct _BzWindow
   GtkEventController *key_controller;
 
   gboolean breakpoint_applied;
+  guint    warm_up_source;
+
+  /* Top-level pages, built lazily by ensure_page () */
+  BzSearchWidget *search_widget;
+  BzLibraryPage  *library_page;
 
   /* Template widgets */
   BzCometOverlay    *comet_overlay;
   BzPopupOverlay    *popup_overlay;
   AdwNavigationView *navigation_view;
   BzFullView        *full_view;
-  BzSearchWidget    *search_widget;
-  BzLibraryPage     *library_page;
+  AdwBin            *browse_bin;
+  AdwBin            *flathub_bin;
+  AdwBin            *installed_bin;
+  AdwBin            *search_bin;
   AdwToastOverlay   *toasts;
   AdwViewStack      *main_view_stack;
   GtkStack          *main_stack;
@@ -139,6 +146,13 @@ bulk_install (BzWindow *self,
 static void
 set_page (BzWindow *self);
 
+static GtkWidget *
+ensure_page (BzWindow   *self,
+             const char *name);
+
+static gboolean
+warm_up_pages_cb (BzWindow *self);
+
 static void
 emit_hook_disown (BzWindow     *self,
                   BzHookSignal  signal,
@@ -150,6 +164,7 @@ bz_window_dispose (GObject *object)
   BzWindow *self = BZ_WINDOW (object);
 
   g_clear_object (&self->state);
+  g_clear_handle_id (&self->warm_up_source, g_source_remove);
 
   G_OBJECT_CLASS (bz_window_parent_class)->dispose (object);
 }
@@ -477,6 +492,7 @@ action_open_library (GtkWidget  *widget,
 
   adw_navigation_view_pop_to_tag (self->navigation_view, "main");
   adw_view_stack_set_visible_child_name (self->main_view_stack, "installed");
+  ensure_page (self, "installed");
   bz_library_page_reset_search (self->library_page);
 }
 
@@ -529,13 +545,9 @@ bz_window_class_init (BzWindowClass *klass)
 
   g_type_ensure (BZ_TYPE_COMET_OVERLAY);
   g_type_ensure (BZ_TYPE_POPUP_OVERLAY);
-  g_type_ensure (BZ_TYPE_SEARCH_WIDGET);
   g_type_ensure (BZ_TYPE_GLOBAL_PROGRESS);
   g_type_ensure (BZ_TYPE_PROGRESS_BAR);
-  g_type_ensure (BZ_TYPE_CURATED_VIEW);
   g_type_ensure (BZ_TYPE_FULL_VIEW);
-  g_type_ensure (BZ_TYPE_LIBRARY_PAGE);
-  g_type_ensure (BZ_TYPE_FLATHUB_PAGE);
   // g_type_ensure (BZ_TYPE_VIEW_SWITCHER);
 
   gtk_widget_class_set_template_from_resource (widget_class, "/io/github/kolunmi/Bazaar/bz-window.ui");
@@ -546,8 +558,10 @@ bz_window_class_init (BzWindowClass *klass)
   gtk_widget_class_bind_template_child (widget_class, BzWindow, navigation_view);
   gtk_widget_class_bind_template_child (widget_class, BzWindow, full_view);
   gtk_widget_class_bind_template_child (widget_class, BzWindow, toasts);
-  gtk_widget_class_bind_template_child (widget_class, BzWindow, search_widget);
-  gtk_widget_class_bind_template_child (widget_class, BzWindow, library_page);
+  gtk_widget_class_bind_template_child (widget_class, BzWindow, browse_bin);
+  gtk_widget_class_bind_template_child (widget_class, BzWindow, flathub_bin);
+  gtk_widget_class_bind_template_child (widget_class, BzWindow, installed_bin);
+  gtk_widget_class_bind_template_child (widget_class, BzWindow, search_bin);
   gtk_widget_class_bind_template_child (widget_class, BzWindow, main_view_stack);
   gtk_widget_class_bind_template_child (widget_class, BzWindow, main_stack);
   gtk_widget_class_bind_template_child (widget_class, BzWindow, debug_id_label);
@@ -600,14 +614,30 @@ key_pressed (BzWindow              *self,
 
   visible_child_name = adw_view_stack_get_visible_child_name (self->main_view_stack);
   if (g_strcmp0 (visible_child_name, "installed") == 0)
-    return bz_library_page_ensure_active (self->library_page, buf);
+    {
+      ensure_page (self, "installed");
+      return bz_library_page_ensure_active (self->library_page, buf);
+    }
   else
     {
       adw_view_stack_set_visible_child_name (self->main_view_stack, "search");
+      ensure_page (self, "search");
       return bz_search_widget_ensure_active (self->search_widget, buf);
     }
 }
 
+static void
+visible_page_changed (BzWindow     *self,
+                      GParamSpec   *pspec,
+                      AdwViewStack *stack)
+{
+  const char *name = NULL;
+
+  name = adw_view_stack_get_visible_child_name (stack);
+  if (name != NULL)
+    ensure_page (self, name);
+}
+
 static void
 bz_window_init (BzWindow *self)
 {
@@ -618,6 +648,10 @@ bz_window_init (BzWindow *self)
 #endif
 
   adw_view_stack_set_visible_child_name (self->main_view_stack, "flathub");
+  g_signal_connect_swapped (self->main_view_stack,
+                            "notify::visible-child-name",
+                            G_CALLBACK (visible_page_changed),
+                            self);
 
   self->key_controller = gtk_event_controller_key_new ();
   g_signal_connect_swapped (self->key_controller,
@@ -632,7 +666,8 @@ app_busy_changed (BzWindow    *self,
                   GParamSpec  *pspec,
                   BzStateInfo *info)
 {
-  bz_search_widget_refresh (self->search_widget);
+  if (self->search_widget != NULL)
+    bz_search_widget_refresh (self->search_widget);
   set_page (self);
 }
 
@@ -821,6 +856,14 @@ bz_window_new (BzStateInfo *state)
 
   g_object_notify_by_pspec (G_OBJECT (window), props[PROP_STATE]);
 
+  /* Only the page the user lands on is built right away, the rest follow
+     once the window has had a chance to present itself */
+  ensure_page (window, adw_view_stack_get_visible_child_name (window->main_view_stack));
+  window->warm_up_source = g_idle_add_full (
+      G_PRIORITY_LOW,
+      (GSourceFunc) warm_up_pages_cb,
+      window, NULL);
+
   set_page (window);
   return window;
 }
@@ -1053,6 +1096,7 @@ static void
 search (BzWindow   *self,
         const char *initial)
 {
+  ensure_page (self, "search");
   if (initial != NULL && *initial != '\0')
     bz_search_widget_set_text (self->search_widget, initial);
 
@@ -1105,3 +1149,96 @@ emit_hook_disown (BzWindow     *self,
   dex_future_disown (bz_run_hook_emission (
       hooks, signal, 0, NULL, group));
 }
+
+static GtkWidget *
+ensure_page (BzWindow   *self,
+             const char *name)
+{
+  AdwBin    *bin   = NULL;
+  GtkWidget *child = NULL;
+
+  if (g_strcmp0 (name, "browse") == 0)
+    bin = self->browse_bin;
+  else if (g_strcmp0 (name, "flathub") == 0)
+    bin = self->flathub_bin;
+  else if (g_strcmp0 (name, "installed") == 0)
+    bin = self->installed_bin;
+  else if (g_strcmp0 (name, "search") == 0)
+    bin = self->search_bin;
+  else
+    return NULL;
+
+  child = adw_bin_get_child (bin);
+  if (child != NULL)
+    return child;
+
+  /* Pages need the state to bind against, which isn't there until
+     bz_window_new () has run */
+  if (self->state == NULL)
+    return NULL;
+
+  if (bin == self->browse_bin)
+    {
+      child = bz_curated_view_new ();
+      bz_curated_view_set_state (BZ_CURATED_VIEW (child), self->state);
+      g_signal_connect_swapped (child, "group-selected", G_CALLBACK (select_cb), self);
+      g_signal_connect_swapped (child, "browse-flathub", G_CALLBACK (browse_flathub_cb), self);
+    }
+  else if (bin == self->flathub_bin)
+    {
+      child = bz_flathub_page_new ();
+      bz_flathub_page_set_state (BZ_FLATHUB_PAGE (child), self->state);
+      g_signal_connect_swapped (child, "group-selected", G_CALLBACK (select_cb), self);
+      g_signal_connect_swapped (child, "open-search", G_CALLBACK (open_search_cb), self);
+    }
+  else if (bin == self->installed_bin)
+    {
+      child = bz_library_page_new ();
+      bz_library_page_set_state (BZ_LIBRARY_PAGE (child), self->state);
+      g_object_bind_property (
+          self->state, "all-installed-entry-groups",
+          child, "model",
+          G_BINDING_SYNC_CREATE);
+      g_signal_connect_swapped (child, "remove", G_CALLBACK (remove_installed_cb), self);
+      g_signal_connect_swapped (child, "remove-addon", G_CALLBACK (remove_addon_cb), self);
+      g_signal_connect_swapped (child, "install-addon", G_CALLBACK (install_addon_cb), self);
+      g_signal_connect_swapped (child, "show-entry", G_CALLBACK (select_cb), self);
+      g_signal_connect_swapped (child, "update", G_CALLBACK (update_cb), self);
+      self->library_page = BZ_LIBRARY_PAGE (child);
+    }
+  else
+    {
+      child = bz_search_widget_new (NULL, NULL);
+      bz_search_widget_set_state (BZ_SEARCH_WIDGET (child), self->state);
+      g_signal_connect_swapped (child, "select", G_CALLBACK (search_widget_select_cb), self);
+      self->search_widget = BZ_SEARCH_WIDGET (child);
+    }
+
+  adw_bin_set_child (bin, child);
+  return child;
+}
+
+static gboolean
+warm_up_pages_cb (BzWindow *self)
+{
+  const char *names[] = { "browse", "flathub", "installed", "search" };
+  AdwBin     *bins[]  = { self->browse_bin, self->flathub_bin, self->installed_bin, self->search_bin };
+
+  /* Build at most one page per iteration so input is never blocked for
+     long */
+  for (guint i = 0; i < G_N_ELEMENTS (bins); i++)
+    {
+      AdwViewStackPage *page = NULL;
+
+      page = adw_view_stack_get_page (self->main_view_stack, GTK_WIDGET (bins[i]));
+      if (adw_bin_get_child (bins[i]) != NULL ||
+          !adw_view_stack_page_get_visible (page))
+        continue;
+
+      ensure_page (self, names[i]);
+      return G_SOURCE_CONTINUE;
+    }
+
+  self->warm_up_source = 0;
+  return G_SOURCE_REMOVE;
+}
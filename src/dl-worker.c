@@ -30,6 +30,7 @@ BZ_DEFINE_DATA (
     {
       GMainLoop  *loop;
       GIOChannel *stdout_channel;
+      gboolean    prewarmed;
     },
     BZ_RELEASE_DATA (loop, g_main_loop_unref);
     BZ_RELEASE_DATA (stdout_channel, g_io_channel_unref));
@@ -49,6 +50,9 @@ BZ_DEFINE_DATA (
 static DexFuture *
 read_stdin (MainData *data);
 
+static gboolean
+is_flathub_uri (const char *uri);
+
 static DexFuture *
 download_fiber (DownloadData *data);
 
@@ -128,6 +132,14 @@ read_stdin (MainData *data)
 
       g_variant_get (variant, "(ss)", &src_uri, &dest_path);
 
+      /* Only bother with Flathub once something is fetched from it, which
+         is never the case if it isn't set up */
+      if (!data->prewarmed && is_flathub_uri (src_uri))
+        {
+          dex_future_disown (bz_prewarm_global_http_session ());
+          data->prewarmed = TRUE;
+        }
+
       dl_data                 = download_data_new ();
       dl_data->src            = g_steal_pointer (&src_uri);
       dl_data->dest           = g_steal_pointer (&dest_path);
@@ -185,3 +197,19 @@ done:
 
   return dex_future_new_true ();
 }
+
+static gboolean
+is_flathub_uri (const char *uri)
+{
+  g_autoptr (GUri) parsed = NULL;
+  const char *host        = NULL;
+
+  parsed = g_uri_parse (uri, G_URI_FLAGS_NONE, NULL);
+  if (parsed == NULL)
+    return FALSE;
+
+  host = g_uri_get_host (parsed);
+  return host != NULL &&
+         (g_strcmp0 (host, "flathub.org") == 0 ||
+          g_str_has_suffix (host, ".flathub.org"));
+}
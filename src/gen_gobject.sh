@@ -22,6 +22,7 @@ die() {
     echo "                       EX: my fruit_type apple orange pear" 1>&2
     echo "    [ensure]        ensure another type (can have multiple),  EX: GTK_TYPE_WIDGET" 1>&2
     echo "    [property]      property spec (can have multiple),     EX: (see below)" 1>&2
+    echo "    [serialize]     emit GVariant serializers (optional),  EX: true" 1>&2
     echo "" 1>&2
     echo "      The properties are parsed with the form:" 1>&2
     echo "        [name] [ctype] [gtype] [spec-type] [free (optional)] [ref (optional)]" 1>&2
@@ -30,6 +31,10 @@ die() {
     echo "        EX: my_int int G_TYPE_INT int" 1>&2
     echo "        EX: my_ptr_array GPtrArray G_TYPE_PTR_ARRAY boxed g_ptr_array_unref g_ptr_array_ref" 1>&2
     echo "" 1>&2
+    echo "      With [serialize], every property must be a string, uint64 or" 1>&2
+    echo "      double, and they are laid out positionally in a tuple in the order" 1>&2
+    echo "      they are declared. Reordering or inserting properties changes the format." 1>&2
+    echo "" 1>&2
     echo "$@, aborting!" 1>&2
     exit 1
 }
@@ -70,6 +75,7 @@ unset INCLUDES
 unset ENSURES
 unset ENUMS
 unset PROPS
+unset SERIALIZE
 
 while IFS= read -r line; do
 
@@ -116,6 +122,7 @@ ${VAL}"
                 PROPS="$VAL"
             fi
             ;;
+        serialize)       SERIALIZE="$VAL" ;;
         *)  die "unknown key '${KEY}' in ${SPEC_FILE}" ;;
     esac
 
@@ -173,6 +180,26 @@ PAR_HYPHEN="$(to_hyphened "${PAR_PREF}")-${PAR_HYPHEN_NAME}"
 
 YEAR="$(date +'%Y')"
 
+variant_type_of () {
+    case "$1" in
+        string) printf 'ms' ;;
+        uint64) printf 't' ;;
+        double) printf 'd' ;;
+        *) die "property type '$1' cannot be serialized" ;;
+    esac
+}
+
+if [ "$SERIALIZE" = true ]; then
+    VARIANT_FORMAT="("
+    while IFS= read -r line; do
+        set -- $line
+        VARIANT_FORMAT="${VARIANT_FORMAT}$(variant_type_of "$4")" || exit 1
+    done <<EOF
+$PROPS
+EOF
+    VARIANT_FORMAT="${VARIANT_FORMAT})"
+fi
+
 print_enums () {
     HEADER="$1"
 
@@ -389,6 +416,47 @@ print_functions () {
     else
         printf '{\n  return g_object_new (%s, NULL);\n}\n\n' "$TYPE"
     fi
+
+    print_serialize_functions "$HEADER"
+}
+
+
+print_serialize_functions () {
+    HEADER="$1"
+
+    [ "$SERIALIZE" = true ] || return
+
+    if [ "$HEADER" = header ]; then
+        printf '#define %s_VARIANT_FORMAT "%s"\n\n' "$MACRO" "$VARIANT_FORMAT"
+        printf 'GVariant *\n%s_to_variant (%s *self);\n\n' "$SNAKE" "$PASCAL"
+        printf '%s *\n%s_new_from_variant (GVariant *variant);\n\n' "$PASCAL" "$SNAKE"
+        return
+    fi
+
+    printf 'GVariant *\n%s_to_variant (%s *self)\n{\n' "$SNAKE" "$PASCAL"
+    printf '  g_return_val_if_fail (%s_IS_%s (self), NULL);\n\n' "$MACRO_PREF" "$MACRO_NAME"
+    printf '  return g_variant_new (\n      %s_VARIANT_FORMAT' "$MACRO"
+    while IFS= read -r line; do
+        set -- $line
+        printf ',\n      self->%s' "$1"
+    done <<EOF
+$PROPS
+EOF
+    printf ');\n}\n\n'
+
+    printf '%s *\n%s_new_from_variant (GVariant *variant)\n{\n' "$PASCAL" "$SNAKE"
+    printf '  %s *self = NULL;\n\n' "$PASCAL"
+    printf '  g_return_val_if_fail (variant != NULL, NULL);\n'
+    printf '  g_return_val_if_fail (g_variant_is_of_type (variant, G_VARIANT_TYPE (%s_VARIANT_FORMAT)), NULL);\n\n' "$MACRO"
+    printf '  self = g_object_new (%s, NULL);\n' "$TYPE"
+    printf '  g_variant_get (\n      variant,\n      %s_VARIANT_FORMAT' "$MACRO"
+    while IFS= read -r line; do
+        set -- $line
+        printf ',\n      &self->%s' "$1"
+    done <<EOF
+$PROPS
+EOF
+    printf ');\n\n  return self;\n}\n\n'
 }
 
 